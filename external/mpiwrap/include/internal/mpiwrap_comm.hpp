@@ -62,11 +62,245 @@ class Comm
             return displacements(&counts.front());
         }
 
-        MPI_Int sum(const std::vector<MPI_Int>& counts) const
+        MPIWrap_Int sum(const std::vector<MPI_Int>& counts) const
         {
-            return std::accumulate(counts.begin(), counts.end(), 0);
+            return std::accumulate(counts.begin(), counts.end(), MPIWrap_Int(0));
         }
 
+        MPIWrap_Int sum(const std::vector<MPIWrap_Int>& counts) const
+        {
+            return std::accumulate(counts.begin(), counts.end(), MPIWrap_Int(0));
+        }
+
+        /*
+         * A single type spanning count contiguous elements of type, where
+         * count may exceed MPIWRAP_MAX_COUNT; only valid for operations which
+         * do not combine elements (i.e. not reductions), and must be freed
+         */
+        static MPI_Datatype contiguousType(MPIWrap_Int count, const Datatype& type)
+        {
+            MPI_Int nchunk = count/MPIWRAP_MAX_COUNT;
+            MPI_Int rem = count%MPIWRAP_MAX_COUNT;
+
+            MPI_Datatype chunk, chunks, big;
+            MPIWRAP_CALL(MPI_Type_contiguous(MPIWRAP_MAX_COUNT, type, &chunk));
+            MPIWRAP_CALL(MPI_Type_contiguous(nchunk, chunk, &chunks));
+
+            MPI_Int lens[2] = {1, rem};
+            MPI_Aint bdispls[2] = {0, (MPI_Aint)nchunk*MPIWRAP_MAX_COUNT*(MPI_Aint)type.extent()};
+            MPI_Datatype types[2] = {chunks, type};
+            MPIWRAP_CALL(MPI_Type_create_struct(2, lens, bdispls, types, &big));
+            MPIWRAP_CALL(MPI_Type_commit(&big));
+
+            MPIWRAP_CALL(MPI_Type_free(&chunk));
+            MPIWRAP_CALL(MPI_Type_free(&chunks));
+
+            return big;
+        }
+
+        /*
+         * buf advanced by n elements of type
+         */
+        template <typename T>
+        static T* advance(T* buf, MPIWrap_Int n, const Datatype& type)
+        {
+            return (T*)((const char*)buf+n*(MPI_Aint)type.extent());
+        }
+
+        /*
+         * Whether counts and their packed displacements fit in an MPI_Int
+         */
+        template <typename Count>
+        bool packedFit(const Count* counts) const
+        {
+            MPIWrap_Int displ = 0;
+            for (int i = 0;i < npeers;i++)
+            {
+                if (counts[i] > MPIWRAP_MAX_COUNT || displ > MPIWRAP_MAX_COUNT) return false;
+                displ += counts[i];
+            }
+            return true;
+        }
+
+        template <typename Count>
+        std::vector<MPI_Int> packedDispls(const Count* counts) const
+        {
+            std::vector<MPI_Int> displs(npeers);
+            for (int i = 1;i < npeers;i++) displs[i] = displs[i-1]+counts[i-1];
+            return displs;
+        }
+
+        /*
+         * One type for each peer which places counts[i] elements of type at
+         * the packed (byte) displacement of peer i, for MPI_(I)alltoallw with
+         * zero displacements
+         */
+        template <typename Count>
+        std::vector<MPI_Datatype> placedTypes(const Count* counts, const Datatype& type) const
+        {
+            std::vector<MPI_Datatype> types(npeers);
+            MPI_Aint bdispl = 0;
+            for (int i = 0;i < npeers;i++)
+            {
+                bool big = counts[i] > MPIWRAP_MAX_COUNT;
+                MPI_Int blocklen = (big ? 1 : counts[i]);
+                MPI_Datatype elem = (big ? contiguousType(counts[i], type) : (MPI_Datatype)type);
+                MPIWRAP_CALL(MPI_Type_create_hindexed(1, &blocklen, &bdispl, elem, &types[i]));
+                MPIWRAP_CALL(MPI_Type_commit(&types[i]));
+                if (big) MPIWRAP_CALL(MPI_Type_free(&elem));
+                bdispl += counts[i]*(MPI_Aint)type.extent();
+            }
+            return types;
+        }
+
+        /*
+         * The arguments of MPI_(I)allgatherv, or of MPI_(I)alltoallw when a
+         * count or packed displacement does not fit in an MPI_Int
+         */
+        template <typename Count>
+        void allgatherArgs(internal::CollectiveArgs& args, Count sendcount, const Count* recvcounts,
+                           const Datatype& type) const
+        {
+            if (sendcount <= MPIWRAP_MAX_COUNT && packedFit(recvcounts))
+            {
+                args.sendcounts.assign(1, sendcount);
+                args.recvcounts.assign(recvcounts, recvcounts+npeers);
+                args.recvdispls = packedDispls(recvcounts);
+                return;
+            }
+
+            args.w = true;
+            MPI_Datatype sendtype = type;
+            MPI_Int n = sendcount;
+            if (sendcount > MPIWRAP_MAX_COUNT)
+            {
+                sendtype = contiguousType(sendcount, type);
+                n = 1;
+                args.derived.push_back(sendtype);
+            }
+            args.sendcounts.assign(npeers, n);
+            args.senddispls.assign(npeers, 0);
+            args.sendtypes.assign(npeers, sendtype);
+            args.recvcounts.assign(npeers, 1);
+            args.recvdispls.assign(npeers, 0);
+            args.recvtypes = placedTypes(recvcounts, type);
+            args.derived.insert(args.derived.end(), args.recvtypes.begin(), args.recvtypes.end());
+        }
+
+        /*
+         * The arguments of MPI_(I)alltoallv, or of MPI_(I)alltoallw as above
+         */
+        template <typename Count>
+        void alltoallArgs(internal::CollectiveArgs& args, const Count* sendcounts, const Count* recvcounts,
+                          const Datatype& type) const
+        {
+            if (packedFit(sendcounts) && packedFit(recvcounts))
+            {
+                args.sendcounts.assign(sendcounts, sendcounts+npeers);
+                args.senddispls = packedDispls(sendcounts);
+                args.recvcounts.assign(recvcounts, recvcounts+npeers);
+                args.recvdispls = packedDispls(recvcounts);
+                return;
+            }
+
+            args.w = true;
+            args.sendcounts.assign(npeers, 1);
+            args.senddispls.assign(npeers, 0);
+            args.sendtypes = placedTypes(sendcounts, type);
+            args.recvcounts.assign(npeers, 1);
+            args.recvdispls.assign(npeers, 0);
+            args.recvtypes = placedTypes(recvcounts, type);
+            args.derived.insert(args.derived.end(), args.sendtypes.begin(), args.sendtypes.end());
+            args.derived.insert(args.derived.end(), args.recvtypes.begin(), args.recvtypes.end());
+        }
+
+        template <typename T, typename Count>
+        void allgatherv(const T* sendbuf, Count sendcount, T* recvbuf, const Count* recvcounts,
+                        const Datatype& type) const
+        {
+            internal::CollectiveArgs args;
+            allgatherArgs(args, sendcount, recvcounts, type);
+
+            if (args.w)
+            {
+                MPIWRAP_CALL(MPI_Alltoallw(nc(sendbuf), &args.sendcounts.front(), &args.senddispls.front(), &args.sendtypes.front(),
+                                              recvbuf , &args.recvcounts.front(), &args.recvdispls.front(), &args.recvtypes.front(), comm));
+            }
+            else
+            {
+                MPIWRAP_CALL(MPI_Allgatherv(nc(sendbuf), args.sendcounts[0], type,
+                                               recvbuf , &args.recvcounts.front(), &args.recvdispls.front(), type, comm));
+            }
+        }
+
+        template <typename T, typename Count>
+        void alltoallv(const T* sendbuf, const Count* sendcounts, T* recvbuf, const Count* recvcounts,
+                       const Datatype& type) const
+        {
+            internal::CollectiveArgs args;
+            alltoallArgs(args, sendcounts, recvcounts, type);
+
+            if (args.w)
+            {
+                MPIWRAP_CALL(MPI_Alltoallw(nc(sendbuf), &args.sendcounts.front(), &args.senddispls.front(), &args.sendtypes.front(),
+                                              recvbuf , &args.recvcounts.front(), &args.recvdispls.front(), &args.recvtypes.front(), comm));
+            }
+            else
+            {
+                MPIWRAP_CALL(MPI_Alltoallv(nc(sendbuf), &args.sendcounts.front(), &args.senddispls.front(), type,
+                                              recvbuf , &args.recvcounts.front(), &args.recvdispls.front(), type, comm));
+            }
+        }
+
+#if MPIWRAP_HAVE_MPI_ICOLLECTIVES
+
+        /*
+         * The returned request keeps the arguments until the operation completes
+         */
+        template <typename T, typename Count>
+        Request iallgatherv(const T* sendbuf, Count sendcount, T* recvbuf, const Count* recvcounts,
+                            const Datatype& type) const
+        {
+            internal::CollectiveArgs* args = new internal::CollectiveArgs;
+            allgatherArgs(*args, sendcount, recvcounts, type);
+
+            MPI_Request req;
+            if (args->w)
+            {
+                MPIWRAP_CALL(MPI_Ialltoallw(nc(sendbuf), &args->sendcounts.front(), &args->senddispls.front(), &args->sendtypes.front(),
+                                               recvbuf , &args->recvcounts.front(), &args->recvdispls.front(), &args->recvtypes.front(), comm, &req));
+            }
+            else
+            {
+                MPIWRAP_CALL(MPI_Iallgatherv(nc(sendbuf), args->sendcounts[0], type,
+                                                recvbuf , &args->recvcounts.front(), &args->recvdispls.front(), type, comm, &req));
+            }
+            return Request(req, args);
+        }
+
+        template <typename T, typename Count>
+        Request ialltoallv(const T* sendbuf, const Count* sendcounts, T* recvbuf, const Count* recvcounts,
+                           const Datatype& type) const
+        {
+            internal::CollectiveArgs* args = new internal::CollectiveArgs;
+            alltoallArgs(*args, sendcounts, recvcounts, type);
+
+            MPI_Request req;
+            if (args->w)
+            {
+                MPIWRAP_CALL(MPI_Ialltoallw(nc(sendbuf), &args->sendcounts.front(), &args->senddispls.front(), &args->sendtypes.front(),
+                                               recvbuf , &args->recvcounts.front(), &args->recvdispls.front(), &args->recvtypes.front(), comm, &req));
+            }
+            else
+            {
+                MPIWRAP_CALL(MPI_Ialltoallv(nc(sendbuf), &args->sendcounts.front(), &args->senddispls.front(), type,
+                                               recvbuf , &args->recvcounts.front(), &args->recvdispls.front(), type, comm, &req));
+            }
+            return Request(req, args);
+        }
+
+#endif
+
         explicit Comm(const MPI_Comm& comm, MPI_Int npeers)
         : comm(comm), npeers(npeers), rank(getRank(comm)), size(getSize(comm)) {}
 
@@ -914,17 +1148,53 @@ class Comm
         void Allgather(const T* sendbuf, MPI_Int sendcount, T* recvbuf, const MPI_Int* recvcounts,
                        const Datatype& type) const
         {
-            std::vector<MPI_Int> displs = displacements(recvcounts);
-            Allgather(sendbuf, sendcount, recvbuf, recvcounts, displs, type);
+            allgatherv(sendbuf, sendcount, recvbuf, recvcounts, type);
         }
 
         template <typename T>
         void Allgather(const std::vector<T>& sendbuf, std::vector<T>& recvbuf, const std::vector<MPI_Int>& recvcounts,
                        const Datatype& type) const
         {
+            MPIWRAP_ASSERT(recvcounts.size() == npeers,
+                           "There must be exactly one receive count for each process.");
             MPIWRAP_ASSERT(recvbuf.size() == sum(recvcounts),
                            "The receive buffer size must equal the sum of the receive counts.");
-            Allgather(sendbuf, recvbuf, recvcounts, displacements(recvcounts), type);
+            Allgather(&sendbuf.front(), sendbuf.size(), &recvbuf.front(), &recvcounts.front(), type);
+        }
+
+        /*
+         * MPI_Allgatherv with counts which may exceed MPIWRAP_MAX_COUNT
+         */
+
+        template <typename T>
+        void Allgather(const T* sendbuf, MPIWrap_Int sendcount, T* recvbuf, const MPIWrap_Int* recvcounts) const
+        {
+            Allgather(sendbuf, sendcount, recvbuf, recvcounts, MPI_TYPE_<T>::value());
+        }
+
+        template <typename T>
+        void Allgather(const std::vector<T>& sendbuf, std::vector<T>& recvbuf,
+                       const std::vector<MPIWrap_Int>& recvcounts) const
+        {
+            Allgather(sendbuf, recvbuf, recvcounts, MPI_TYPE_<T>::value());
+        }
+
+        template <typename T>
+        void Allgather(const T* sendbuf, MPIWrap_Int sendcount, T* recvbuf, const MPIWrap_Int* recvcounts,
+                       const Datatype& type) const
+        {
+            allgatherv(sendbuf, sendcount, recvbuf, recvcounts, type);
+        }
+
+        template <typename T>
+        void Allgather(const std::vector<T>& sendbuf, std::vector<T>& recvbuf, const std::vector<MPIWrap_Int>& recvcounts,
+                       const Datatype& type) const
+        {
+            MPIWRAP_ASSERT(recvcounts.size() == npeers,
+                           "There must be exactly one receive count for each process.");
+            MPIWRAP_ASSERT(recvbuf.size() == sum(recvcounts),
+                           "The receive buffer size must equal the sum of the receive counts.");
+            Allgather(&sendbuf.front(), (MPIWrap_Int)sendbuf.size(), &recvbuf.front(), &recvcounts.front(), type);
         }
 
         template <typename T>
@@ -965,7 +1235,7 @@ class Comm
          */
 
         template <typename T>
-        void Allreduce(const T* sendbuf, T* recvbuf, MPI_Int count, const MPI_Op& op) const
+        void Allreduce(const T* sendbuf, T* recvbuf, MPIWrap_Int count, const MPI_Op& op) const
         {
             Allreduce(sendbuf, recvbuf, count, op, MPI_TYPE_<T>::value());
         }
@@ -977,9 +1247,14 @@ class Comm
         }
 
         template <typename T>
-        void Allreduce(const T* sendbuf, T* recvbuf, MPI_Int count, const MPI_Op& op, const Datatype& type) const
+        void Allreduce(const T* sendbuf, T* recvbuf, MPIWrap_Int count, const MPI_Op& op, const Datatype& type) const
         {
-            MPIWRAP_CALL(MPI_Allreduce(nc(sendbuf), recvbuf, count, type, op, comm));
+            for (MPIWrap_Int off = 0;off < count;off += MPIWRAP_MAX_COUNT)
+            {
+                MPI_Int n = std::min<MPIWrap_Int>(count-off, MPIWRAP_MAX_COUNT);
+                MPIWRAP_CALL(MPI_Allreduce(nc(advance(sendbuf, off, type)), advance(recvbuf, off, type),
+                                           n, type, op, comm));
+            }
         }
 
         template <typename T>
@@ -1044,10 +1319,7 @@ class Comm
         void Alltoall(const T* sendbuf, const MPI_Int* sendcounts,
                             T* recvbuf, const MPI_Int* recvcounts, const Datatype& type) const
         {
-            std::vector<MPI_Int> senddispls = displacements(sendcounts);
-            std::vector<MPI_Int> recvdispls = displacements(recvcounts);
-            Alltoall(sendbuf, sendcounts, senddispls,
-                     recvbuf, recvcounts, recvdispls, type);
+            alltoallv(sendbuf, sendcounts, recvbuf, recvcounts, type);
         }
 
         template <typename T>
@@ -1055,12 +1327,57 @@ class Comm
                             std::vector<T>& recvbuf, const std::vector<MPI_Int>& recvcounts,
                       const Datatype& type) const
         {
+            MPIWRAP_ASSERT(sendcounts.size() == npeers,
+                           "There must be exactly one send count for each process.");
+            MPIWRAP_ASSERT(recvcounts.size() == npeers,
+                           "There must be exactly one receive count for each process.");
+            MPIWRAP_ASSERT(sendbuf.size() == sum(sendcounts),
+                           "The send buffer size must equal the sum of the send counts.");
+            MPIWRAP_ASSERT(recvbuf.size() == sum(recvcounts),
+                           "The receive buffer size must equal the sum of the receive counts.");
+            Alltoall(&sendbuf.front(), &sendcounts.front(),
+                     &recvbuf.front(), &recvcounts.front(), type);
+        }
+
+        /*
+         * MPI_Alltoallv with counts which may exceed MPIWRAP_MAX_COUNT
+         */
+
+        template <typename T>
+        void Alltoall(const T* sendbuf, const MPIWrap_Int* sendcounts, T* recvbuf, const MPIWrap_Int* recvcounts) const
+        {
+            Alltoall(sendbuf, sendcounts, recvbuf, recvcounts, MPI_TYPE_<T>::value());
+        }
+
+        template <typename T>
+        void Alltoall(const std::vector<T>& sendbuf, const std::vector<MPIWrap_Int>& sendcounts,
+                            std::vector<T>& recvbuf, const std::vector<MPIWrap_Int>& recvcounts) const
+        {
+            Alltoall(sendbuf, sendcounts, recvbuf, recvcounts, MPI_TYPE_<T>::value());
+        }
+
+        template <typename T>
+        void Alltoall(const T* sendbuf, const MPIWrap_Int* sendcounts,
+                            T* recvbuf, const MPIWrap_Int* recvcounts, const Datatype& type) const
+        {
+            alltoallv(sendbuf, sendcounts, recvbuf, recvcounts, type);
+        }
+
+        template <typename T>
+        void Alltoall(const std::vector<T>& sendbuf, const std::vector<MPIWrap_Int>& sendcounts,
+                            std::vector<T>& recvbuf, const std::vector<MPIWrap_Int>& recvcounts,
+                      const Datatype& type) const
+        {
+            MPIWRAP_ASSERT(sendcounts.size() == npeers,
+                           "There must be exactly one send count for each process.");
+            MPIWRAP_ASSERT(recvcounts.size() == npeers,
+                           "There must be exactly one receive count for each process.");
             MPIWRAP_ASSERT(sendbuf.size() == sum(sendcounts),
                            "The send buffer size must equal the sum of the send counts.");
             MPIWRAP_ASSERT(recvbuf.size() == sum(recvcounts),
                            "The receive buffer size must equal the sum of the receive counts.");
-            Alltoall(sendbuf, sendcounts, displacements(sendcounts),
-                     recvbuf, recvcounts, displacements(recvcounts), type);
+            Alltoall(&sendbuf.front(), &sendcounts.front(),
+                     &recvbuf.front(), &recvcounts.front(), type);
         }
 
         template <typename T>
@@ -1246,17 +1563,49 @@ class Comm
         Request Iallgather(const T* sendbuf, MPI_Int sendcount, T* recvbuf, const MPI_Int* recvcounts,
                        const Datatype& type) const
         {
-            std::vector<MPI_Int> displs = displacements(recvcounts);
-            return Iallgather(sendbuf, sendcount, recvbuf, recvcounts, displs, type);
+            return iallgatherv(sendbuf, sendcount, recvbuf, recvcounts, type);
         }
 
         template <typename T>
         Request Iallgather(const std::vector<T>& sendbuf, std::vector<T>& recvbuf, const std::vector<MPI_Int>& recvcounts,
                        const Datatype& type) const
         {
+            MPIWRAP_ASSERT(recvcounts.size() == npeers,
+                           "There must be exactly one receive count for each process.");
+            MPIWRAP_ASSERT(recvbuf.size() == sum(recvcounts),
+                           "The receive buffer size must equal the sum of the receive counts.");
+            return Iallgather(&sendbuf.front(), sendbuf.size(), &recvbuf.front(), &recvcounts.front(), type);
+        }
+
+        template <typename T>
+        Request Iallgather(const T* sendbuf, MPIWrap_Int sendcount, T* recvbuf, const MPIWrap_Int* recvcounts) const
+        {
+            return Iallgather(sendbuf, sendcount, recvbuf, recvcounts, MPI_TYPE_<T>::value());
+        }
+
+        template <typename T>
+        Request Iallgather(const std::vector<T>& sendbuf, std::vector<T>& recvbuf,
+                       const std::vector<MPIWrap_Int>& recvcounts) const
+        {
+            return Iallgather(sendbuf, recvbuf, recvcounts, MPI_TYPE_<T>::value());
+        }
+
+        template <typename T>
+        Request Iallgather(const T* sendbuf, MPIWrap_Int sendcount, T* recvbuf, const MPIWrap_Int* recvcounts,
+                       const Datatype& type) const
+        {
+            return iallgatherv(sendbuf, sendcount, recvbuf, recvcounts, type);
+        }
+
+        template <typename T>
+        Request Iallgather(const std::vector<T>& sendbuf, std::vector<T>& recvbuf, const std::vector<MPIWrap_Int>& recvcounts,
+                       const Datatype& type) const
+        {
+            MPIWRAP_ASSERT(recvcounts.size() == npeers,
+                           "There must be exactly one receive count for each process.");
             MPIWRAP_ASSERT(recvbuf.size() == sum(recvcounts),
                            "The receive buffer size must equal the sum of the receive counts.");
-            return Iallgather(sendbuf, recvbuf, recvcounts, displacements(recvcounts), type);
+            return Iallgather(&sendbuf.front(), (MPIWrap_Int)sendbuf.size(), &recvbuf.front(), &recvcounts.front(), type);
         }
 
         template <typename T>
@@ -1299,7 +1648,7 @@ class Comm
          */
 
         template <typename T>
-        Request Iallreduce(const T* sendbuf, T* recvbuf, MPI_Int count, const MPI_Op& op) const
+        Request Iallreduce(const T* sendbuf, T* recvbuf, MPIWrap_Int count, const MPI_Op& op) const
         {
             return Iallreduce(sendbuf, recvbuf, count, op, MPI_TYPE_<T>::value());
         }
@@ -1311,9 +1660,18 @@ class Comm
         }
 
         template <typename T>
-        Request Iallreduce(const T* sendbuf, T* recvbuf, MPI_Int count, const MPI_Op& op, const Datatype& type) const
+        Request Iallreduce(const T* sendbuf, T* recvbuf, MPIWrap_Int count, const MPI_Op& op, const Datatype& type) const
         {
             MPI_Request req;
+#if MPIWRAP_HAVE_MPI_LARGE_COUNT
+            if (count > MPIWRAP_MAX_COUNT)
+            {
+                MPIWRAP_CALL(MPI_Iallreduce_c(nc(sendbuf), recvbuf, count, type, op, comm, &req));
+                return Request(req);
+            }
+#endif
+            MPIWRAP_ASSERT(count <= MPIWRAP_MAX_COUNT,
+                           "Non-blocking reductions of more than MPIWRAP_MAX_COUNT elements require MPI 4.0.");
             MPIWRAP_CALL(MPI_Iallreduce(nc(sendbuf), recvbuf, count, type, op, comm, &req));
             return Request(req);
         }
@@ -1382,10 +1740,7 @@ class Comm
         Request Ialltoall(const T* sendbuf, const MPI_Int* sendcounts,
                                 T* recvbuf, const MPI_Int* recvcounts, const Datatype& type) const
         {
-            std::vector<MPI_Int> senddispls = displacements(sendcounts);
-            std::vector<MPI_Int> recvdispls = displacements(recvcounts);
-            return Ialltoall(sendbuf, sendcounts, senddispls,
-                             recvbuf, recvcounts, recvdispls, type);
+            return ialltoallv(sendbuf, sendcounts, recvbuf, recvcounts, type);
         }
 
         template <typename T>
@@ -1393,12 +1748,53 @@ class Comm
                                 std::vector<T>& recvbuf, const std::vector<MPI_Int>& recvcounts,
                           const Datatype& type) const
         {
+            MPIWRAP_ASSERT(sendcounts.size() == npeers,
+                           "There must be exactly one send count for each process.");
+            MPIWRAP_ASSERT(recvcounts.size() == npeers,
+                           "There must be exactly one receive count for each process.");
+            MPIWRAP_ASSERT(sendbuf.size() == sum(sendcounts),
+                           "The send buffer size must equal the sum of the send counts.");
+            MPIWRAP_ASSERT(recvbuf.size() == sum(recvcounts),
+                           "The receive buffer size must equal the sum of the receive counts.");
+            return Ialltoall(&sendbuf.front(), &sendcounts.front(),
+                             &recvbuf.front(), &recvcounts.front(), type);
+        }
+
+        template <typename T>
+        Request Ialltoall(const T* sendbuf, const MPIWrap_Int* sendcounts, T* recvbuf, const MPIWrap_Int* recvcounts) const
+        {
+            return Ialltoall(sendbuf, sendcounts, recvbuf, recvcounts, MPI_TYPE_<T>::value());
+        }
+
+        template <typename T>
+        Request Ialltoall(const std::vector<T>& sendbuf, const std::vector<MPIWrap_Int>& sendcounts,
+                                std::vector<T>& recvbuf, const std::vector<MPIWrap_Int>& recvcounts) const
+        {
+            return Ialltoall(sendbuf, sendcounts, recvbuf, recvcounts, MPI_TYPE_<T>::value());
+        }
+
+        template <typename T>
+        Request Ialltoall(const T* sendbuf, const MPIWrap_Int* sendcounts,
+                                T* recvbuf, const MPIWrap_Int* recvcounts, const Datatype& type) const
+        {
+            return ialltoallv(sendbuf, sendcounts, recvbuf, recvcounts, type);
+        }
+
+        template <typename T>
+        Request Ialltoall(const std::vector<T>& sendbuf, const std::vector<MPIWrap_Int>& sendcounts,
+                                std::vector<T>& recvbuf, const std::vector<MPIWrap_Int>& recvcounts,
+                          const Datatype& type) const
+        {
+            MPIWRAP_ASSERT(sendcounts.size() == npeers,
+                           "There must be exactly one send count for each process.");
+            MPIWRAP_ASSERT(recvcounts.size() == npeers,
+                           "There must be exactly one receive count for each process.");
             MPIWRAP_ASSERT(sendbuf.size() == sum(sendcounts),
                            "The send buffer size must equal the sum of the send counts.");
             MPIWRAP_ASSERT(recvbuf.size() == sum(recvcounts),
                            "The receive buffer size must equal the sum of the receive counts.");
-            return Ialltoall(sendbuf, sendcounts, displacements(sendcounts),
-                             recvbuf, recvcounts, displacements(recvcounts), type);
+            return Ialltoall(&sendbuf.front(), &sendcounts.front(),
+                             &recvbuf.front(), &recvcounts.front(), type);
         }
 
         template <typename T>
@@ -3,10 +3,12 @@
 
 #include "mpi.h"
 
+#include <algorithm>
 #include <complex>
 #include <vector>
 #include <cassert>
 #include <numeric>
+#include <limits>
 #include <cwchar>
 #include <stdexcept>
 
@@ -33,7 +35,15 @@
 typedef MPIWRAP_MPI_INT MPI_Int;
 typedef MPIWRAP_INT MPIWrap_Int;
 
-//TODO: actually use MPIWrap_Int
+/*
+ * Largest number of elements passed to a single MPI call. Contiguous
+ * buffers with a larger count (given as an MPIWrap_Int) are split or
+ * described by a derived type, and v-collectives whose packed displacements
+ * do not fit in an MPI_Int go through MPI_(I)alltoallw with byte offsets.
+ */
+#ifndef MPIWRAP_MAX_COUNT
+#define MPIWRAP_MAX_COUNT std::numeric_limits<MPI_Int>::max()
+#endif
 
 #define MPIWRAP_CALL(...) \
 { \
@@ -120,6 +130,11 @@ namespace MPIWrap
     }
 }
 
+/*
+ * MPI 4.0 has MPI_Count variants (MPI_Xxx_c) of all collectives
+ */
+#define MPIWRAP_HAVE_MPI_LARGE_COUNT MPIWRAP_VERSION_AT_LEAST(4,0)
+
 #if !MPIWRAP_VERSION_AT_LEAST(2,1)
 #error "An MPI implementation of at least MPI 2.1 must be available."
 #endif
@@ -66,6 +66,12 @@ class Intracomm : protected internal::Comm<Intracomm>
         using internal::Comm<Intracomm>::operator MPI_Comm*;
         using internal::Comm<Intracomm>::operator const MPI_Comm*;
 
+#if MPIWRAP_HAVE_MPI_WIN
+
+        using internal::Comm<Intracomm>::window;
+
+#endif
+
 #if MPIWRAP_HAVE_MPI_MESSAGE
 
         using internal::Comm<Intracomm>::Mprobe;
@@ -204,7 +210,7 @@ class Intracomm : protected internal::Comm<Intracomm>
          */
 
         template <typename T>
-        void Allreduce(T* buf, MPI_Int count, const MPI_Op& op) const
+        void Allreduce(T* buf, MPIWrap_Int count, const MPI_Op& op) const
         {
             Allreduce(buf, count, op, MPI_TYPE_<T>::value());
         }
@@ -216,9 +222,13 @@ class Intracomm : protected internal::Comm<Intracomm>
         }
 
         template <typename T>
-        void Allreduce(T* buf, MPI_Int count, const MPI_Op& op, const Datatype& type) const
+        void Allreduce(T* buf, MPIWrap_Int count, const MPI_Op& op, const Datatype& type) const
         {
-            MPIWRAP_CALL(MPI_Allreduce(MPI_IN_PLACE, buf, count, type, op, comm));
+            for (MPIWrap_Int off = 0;off < count;off += MPIWRAP_MAX_COUNT)
+            {
+                MPI_Int n = std::min<MPIWrap_Int>(count-off, MPIWRAP_MAX_COUNT);
+                MPIWRAP_CALL(MPI_Allreduce(MPI_IN_PLACE, advance(buf, off, type), n, type, op, comm));
+            }
         }
 
         template <typename T>
@@ -332,7 +342,7 @@ class Intracomm : protected internal::Comm<Intracomm>
          */
 
         template <typename T>
-        void Bcast(T* buffer, MPI_Int count, MPI_Int root) const
+        void Bcast(T* buffer, MPIWrap_Int count, MPI_Int root) const
         {
             Bcast(buffer, count, root, MPI_TYPE_<T>::value());
         }
@@ -344,9 +354,13 @@ class Intracomm : protected internal::Comm<Intracomm>
         }
 
         template <typename T>
-        void Bcast(T* buffer, MPI_Int count, MPI_Int root, const Datatype& type) const
+        void Bcast(T* buffer, MPIWrap_Int count, MPI_Int root, const Datatype& type) const
         {
-            MPIWRAP_CALL(MPI_Bcast(buffer, count, type, root, comm));
+            for (MPIWrap_Int off = 0;off < count;off += MPIWRAP_MAX_COUNT)
+            {
+                MPI_Int n = std::min<MPIWrap_Int>(count-off, MPIWRAP_MAX_COUNT);
+                MPIWRAP_CALL(MPI_Bcast(advance(buffer, off, type), n, type, root, comm));
+            }
         }
 
         template <typename T>
@@ -360,7 +374,7 @@ class Intracomm : protected internal::Comm<Intracomm>
          */
 
         template <typename T>
-        void Bcast(const T* buffer, MPI_Int count) const
+        void Bcast(const T* buffer, MPIWrap_Int count) const
         {
             Bcast(buffer, count, MPI_TYPE_<T>::value());
         }
@@ -372,9 +386,13 @@ class Intracomm : protected internal::Comm<Intracomm>
         }
 
         template <typename T>
-        void Bcast(const T* buffer, MPI_Int count, const Datatype& type) const
+        void Bcast(const T* buffer, MPIWrap_Int count, const Datatype& type) const
         {
-            MPIWRAP_CALL(MPI_Bcast(const_cast<T*>(buffer), count, type, rank, comm));
+            for (MPIWrap_Int off = 0;off < count;off += MPIWRAP_MAX_COUNT)
+            {
+                MPI_Int n = std::min<MPIWrap_Int>(count-off, MPIWRAP_MAX_COUNT);
+                MPIWRAP_CALL(MPI_Bcast(nc(advance(buffer, off, type)), n, type, rank, comm));
+            }
         }
 
         template <typename T>
@@ -634,7 +652,7 @@ class Intracomm : protected internal::Comm<Intracomm>
          */
 
         template <typename T>
-        void Reduce(const T* sendbuf, MPI_Int count, const MPI_Op& op, MPI_Int root) const
+        void Reduce(const T* sendbuf, MPIWrap_Int count, const MPI_Op& op, MPI_Int root) const
         {
             Reduce(sendbuf, count, op, root, MPI_TYPE_<T>::value());
         }
@@ -646,9 +664,13 @@ class Intracomm : protected internal::Comm<Intracomm>
         }
 
         template <typename T>
-        void Reduce(const T* sendbuf, MPI_Int count, const MPI_Op& op, MPI_Int root, const Datatype& type) const
+        void Reduce(const T* sendbuf, MPIWrap_Int count, const MPI_Op& op, MPI_Int root, const Datatype& type) const
         {
-            MPIWRAP_CALL(MPI_Reduce(nc(sendbuf), NULL, count, type, op, root, comm));
+            for (MPIWrap_Int off = 0;off < count;off += MPIWRAP_MAX_COUNT)
+            {
+                MPI_Int n = std::min<MPIWrap_Int>(count-off, MPIWRAP_MAX_COUNT);
+                MPIWRAP_CALL(MPI_Reduce(nc(advance(sendbuf, off, type)), NULL, n, type, op, root, comm));
+            }
         }
 
         template <typename T>
@@ -662,7 +684,7 @@ class Intracomm : protected internal::Comm<Intracomm>
          */
 
         template <typename T>
-        void Reduce(const T* sendbuf, T* recvbuf, MPI_Int count, const MPI_Op& op) const
+        void Reduce(const T* sendbuf, T* recvbuf, MPIWrap_Int count, const MPI_Op& op) const
         {
             Reduce(sendbuf, recvbuf, count, op, MPI_TYPE_<T>::value());
         }
@@ -674,9 +696,14 @@ class Intracomm : protected internal::Comm<Intracomm>
         }
 
         template <typename T>
-        void Reduce(const T* sendbuf, T* recvbuf, MPI_Int count, const MPI_Op& op, const Datatype& type) const
+        void Reduce(const T* sendbuf, T* recvbuf, MPIWrap_Int count, const MPI_Op& op, const Datatype& type) const
         {
-            MPIWRAP_CALL(MPI_Reduce(nc(sendbuf), recvbuf, count, type, op, rank, comm));
+            for (MPIWrap_Int off = 0;off < count;off += MPIWRAP_MAX_COUNT)
+            {
+                MPI_Int n = std::min<MPIWrap_Int>(count-off, MPIWRAP_MAX_COUNT);
+                MPIWRAP_CALL(MPI_Reduce(nc(advance(sendbuf, off, type)), advance(recvbuf, off, type),
+                                        n, type, op, rank, comm));
+            }
         }
 
         template <typename T>
@@ -692,7 +719,7 @@ class Intracomm : protected internal::Comm<Intracomm>
          */
 
         template <typename T>
-        void Reduce(T* recvbuf, MPI_Int count, const MPI_Op& op) const
+        void Reduce(T* recvbuf, MPIWrap_Int count, const MPI_Op& op) const
         {
             Reduce(recvbuf, count, op, MPI_TYPE_<T>::value());
         }
@@ -704,9 +731,13 @@ class Intracomm : protected internal::Comm<Intracomm>
         }
 
         template <typename T>
-        void Reduce(T* recvbuf, MPI_Int count, const MPI_Op& op, const Datatype& type) const
+        void Reduce(T* recvbuf, MPIWrap_Int count, const MPI_Op& op, const Datatype& type) const
         {
-            MPIWRAP_CALL(MPI_Reduce(MPI_IN_PLACE, recvbuf, count, type, op, rank, comm));
+            for (MPIWrap_Int off = 0;off < count;off += MPIWRAP_MAX_COUNT)
+            {
+                MPI_Int n = std::min<MPIWrap_Int>(count-off, MPIWRAP_MAX_COUNT);
+                MPIWRAP_CALL(MPI_Reduce(MPI_IN_PLACE, advance(recvbuf, off, type), n, type, op, rank, comm));
+            }
         }
 
         template <typename T>
@@ -1242,7 +1273,7 @@ class Intracomm : protected internal::Comm<Intracomm>
          */
 
         template <typename T>
-        Request Iallreduce(T* buf, MPI_Int count, const MPI_Op& op) const
+        Request Iallreduce(T* buf, MPIWrap_Int count, const MPI_Op& op) const
         {
             return Iallreduce(buf, count, op, MPI_TYPE_<T>::value());
         }
@@ -1254,9 +1285,18 @@ class Intracomm : protected internal::Comm<Intracomm>
         }
 
         template <typename T>
-        Request Iallreduce(T* buf, MPI_Int count, const MPI_Op& op, const Datatype& type) const
+        Request Iallreduce(T* buf, MPIWrap_Int count, const MPI_Op& op, const Datatype& type) const
         {
             MPI_Request req;
+#if MPIWRAP_HAVE_MPI_LARGE_COUNT
+            if (count > MPIWRAP_MAX_COUNT)
+            {
+                MPIWRAP_CALL(MPI_Iallreduce_c(MPI_IN_PLACE, buf, count, type, op, comm, &req));
+                return Request(req);
+            }
+#endif
+            MPIWRAP_ASSERT(count <= MPIWRAP_MAX_COUNT,
+                           "Non-blocking reductions of more than MPIWRAP_MAX_COUNT elements require MPI 4.0.");
             MPIWRAP_CALL(MPI_Iallreduce(MPI_IN_PLACE, buf, count, type, op, comm, &req));
             return Request(req);
         }
@@ -1376,7 +1416,7 @@ class Intracomm : protected internal::Comm<Intracomm>
          */
 
         template <typename T>
-        Request Ibcast(T* buffer, MPI_Int count, MPI_Int root) const
+        Request Ibcast(T* buffer, MPIWrap_Int count, MPI_Int root) const
         {
             return Ibcast(buffer, count, root, MPI_TYPE_<T>::value());
         }
@@ -1388,10 +1428,19 @@ class Intracomm : protected internal::Comm<Intracomm>
         }
 
         template <typename T>
-        Request Ibcast(T* buffer, MPI_Int count, MPI_Int root, const Datatype& type) const
+        Request Ibcast(T* buffer, MPIWrap_Int count, MPI_Int root, const Datatype& type) const
         {
             MPI_Request req;
-            MPIWRAP_CALL(MPI_Ibcast(buffer, count, type, root, comm, &req));
+            if (count > MPIWRAP_MAX_COUNT)
+            {
+                MPI_Datatype big = contiguousType(count, type);
+                MPIWRAP_CALL(MPI_Ibcast(buffer, 1, big, root, comm, &req));
+                MPIWRAP_CALL(MPI_Type_free(&big));
+            }
+            else
+            {
+                MPIWRAP_CALL(MPI_Ibcast(buffer, count, type, root, comm, &req));
+            }
             return Request(req);
         }
 
@@ -1406,7 +1455,7 @@ class Intracomm : protected internal::Comm<Intracomm>
          */
 
         template <typename T>
-        Request Ibcast(const T* buffer, MPI_Int count) const
+        Request Ibcast(const T* buffer, MPIWrap_Int count) const
         {
             return Ibcast(buffer, count, MPI_TYPE_<T>::value());
         }
@@ -1418,10 +1467,19 @@ class Intracomm : protected internal::Comm<Intracomm>
         }
 
         template <typename T>
-        Request Ibcast(const T* buffer, MPI_Int count, const Datatype& type) const
+        Request Ibcast(const T* buffer, MPIWrap_Int count, const Datatype& type) const
         {
             MPI_Request req;
-            MPIWRAP_CALL(MPI_Ibcast(const_cast<T*>(buffer), count, type, rank, comm, &req));
+            if (count > MPIWRAP_MAX_COUNT)
+            {
+                MPI_Datatype big = contiguousType(count, type);
+                MPIWRAP_CALL(MPI_Ibcast(const_cast<T*>(buffer), 1, big, rank, comm, &req));
+                MPIWRAP_CALL(MPI_Type_free(&big));
+            }
+            else
+            {
+                MPIWRAP_CALL(MPI_Ibcast(const_cast<T*>(buffer), count, type, rank, comm, &req));
+            }
             return Request(req);
         }
 
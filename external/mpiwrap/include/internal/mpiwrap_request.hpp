@@ -10,6 +10,28 @@ namespace MPIWrap
 namespace internal
 {
     template <typename Derived> class Comm;
+
+    /*
+     * Counts, displacements and derived types computed by a non-blocking
+     * collective, which must stay valid until the operation completes; the
+     * derived types are freed along with them
+     */
+    struct CollectiveArgs
+    {
+        bool w;
+        std::vector<MPI_Int> sendcounts, senddispls, recvcounts, recvdispls;
+        std::vector<MPI_Datatype> sendtypes, recvtypes, derived;
+
+        CollectiveArgs() : w(false) {}
+
+        ~CollectiveArgs()
+        {
+            for (size_t i = 0;i < derived.size();i++)
+            {
+                MPIWRAP_CALL(MPI_Type_free(&derived[i]));
+            }
+        }
+    };
 }
 
 class Request
@@ -21,15 +43,50 @@ class Request
 
     protected:
         MPI_Request req;
+        internal::CollectiveArgs* args;
+
+        explicit Request(const MPI_Request& req, internal::CollectiveArgs* args = NULL)
+        : req(req), args(args) {}
+
+        /*
+         * Release the arguments of a completed operation
+         */
+        void completed()
+        {
+            if (req == MPI_REQUEST_NULL)
+            {
+                delete args;
+                args = NULL;
+            }
+        }
+
+        /*
+         * The MPI handles of count requests (which are not layout-compatible
+         * with MPI_Request), and the reverse after an MPI_Wait/Test* call
+         */
+        static std::vector<MPI_Request> handles(const Request* reqs, MPI_Int count)
+        {
+            std::vector<MPI_Request> h(count+1, MPI_REQUEST_NULL);
+            for (MPI_Int i = 0;i < count;i++) h[i] = reqs[i].req;
+            return h;
+        }
 
-        explicit Request(const MPI_Request& req) : req(req) {}
+        static void update(Request* reqs, const std::vector<MPI_Request>& h, MPI_Int count)
+        {
+            for (MPI_Int i = 0;i < count;i++)
+            {
+                reqs[i].req = h[i];
+                reqs[i].completed();
+            }
+        }
 
     public:
 #if MPIWRAP_CXX11
 
-        Request(Request&& other) : req(other.req)
+        Request(Request&& other) : req(other.req), args(other.args)
         {
             other.req = MPI_REQUEST_NULL;
+            other.args = NULL;
         }
 
 #endif
@@ -38,8 +95,19 @@ class Request
         {
             if (req != MPI_REQUEST_NULL)
             {
-                MPIWRAP_CALL(MPI_Request_free(&req));
+                /*
+                 * Requests of non-blocking collectives may not be freed
+                 */
+                if (args)
+                {
+                    MPIWRAP_CALL(MPI_Wait(&req, MPI_STATUS_IGNORE));
+                }
+                else
+                {
+                    MPIWRAP_CALL(MPI_Request_free(&req));
+                }
             }
+            delete args;
         }
 
         operator MPI_Request&() { return req; }
@@ -64,6 +132,7 @@ class Request
         {
 #if MPIWRAP_VERSION_AT_LEAST(2,0)
             MPIWRAP_CALL(MPI_Wait(&req, MPI_STATUS_IGNORE));
+            completed();
 #else
             Status status;
             wait(status);
@@ -73,6 +142,7 @@ class Request
         void wait(Status& status)
         {
             MPIWRAP_CALL(MPI_Wait(&req, status));
+            completed();
         }
 
         bool test()
@@ -80,6 +150,7 @@ class Request
 #if MPIWRAP_VERSION_AT_LEAST(2,0)
             MPI_Int flag;
             MPIWRAP_CALL(MPI_Test(&req, &flag, MPI_STATUS_IGNORE));
+            completed();
             return flag;
 #else
             Status status;
@@ -91,6 +162,7 @@ class Request
         {
             MPI_Int flag;
             MPIWRAP_CALL(MPI_Test(&req, &flag, status));
+            completed();
             return flag;
         }
 
@@ -98,7 +170,9 @@ class Request
         {
 #if MPIWRAP_VERSION_AT_LEAST(2,0)
             MPI_Int i;
-            MPIWRAP_CALL(MPI_Waitany(count, reinterpret_cast<MPI_Request*>(reqs), &i, MPI_STATUS_IGNORE));
+            std::vector<MPI_Request> h = handles(reqs, count);
+            MPIWRAP_CALL(MPI_Waitany(count, &h.front(), &i, MPI_STATUS_IGNORE));
+            update(reqs, h, count);
             return reqs[i];
 #else
             Status status;
@@ -114,7 +188,9 @@ class Request
         friend Request& waitAny(Request* reqs, MPI_Int count, Status& status)
         {
             MPI_Int i;
-            MPIWRAP_CALL(MPI_Waitany(count, reinterpret_cast<MPI_Request*>(reqs), &i, status));
+            std::vector<MPI_Request> h = handles(reqs, count);
+            MPIWRAP_CALL(MPI_Waitany(count, &h.front(), &i, status));
+            update(reqs, h, count);
             return reqs[i];
         }
 
@@ -127,7 +203,9 @@ class Request
         {
 #if MPIWRAP_VERSION_AT_LEAST(2,0)
             MPI_Int i, flag;
-            MPIWRAP_CALL(MPI_Testany(count, reinterpret_cast<MPI_Request*>(reqs), &i, &flag, MPI_STATUS_IGNORE));
+            std::vector<MPI_Request> h = handles(reqs, count);
+            MPIWRAP_CALL(MPI_Testany(count, &h.front(), &i, &flag, MPI_STATUS_IGNORE));
+            update(reqs, h, count);
             return (flag ? &reqs[i] : NULL);
 #else
             Status status;
@@ -143,7 +221,9 @@ class Request
         friend Request* testAny(Request* reqs, MPI_Int count, Status& status)
         {
             MPI_Int i, flag;
-            MPIWRAP_CALL(MPI_Testany(count, reinterpret_cast<MPI_Request*>(reqs), &i, &flag, status));
+            std::vector<MPI_Request> h = handles(reqs, count);
+            MPIWRAP_CALL(MPI_Testany(count, &h.front(), &i, &flag, status));
+            update(reqs, h, count);
             return (flag ? &reqs[i] : NULL);
         }
 
@@ -155,7 +235,9 @@ class Request
         friend void waitAll(Request* reqs, MPI_Int count)
         {
 #if MPIWRAP_VERSION_AT_LEAST(2,0)
-            MPIWRAP_CALL(MPI_Waitall(count, reinterpret_cast<MPI_Request*>(reqs), MPI_STATUSES_IGNORE));
+            std::vector<MPI_Request> h = handles(reqs, count);
+            MPIWRAP_CALL(MPI_Waitall(count, &h.front(), MPI_STATUSES_IGNORE));
+            update(reqs, h, count);
 #else
             std::vector<Status> stats(count);
             waitAll(reqs, &stats.front(), count);
@@ -169,7 +251,9 @@ class Request
 
         friend void waitAll(Request* reqs, Status* stats, MPI_Int count)
         {
-            MPIWRAP_CALL(MPI_Waitall(count, reinterpret_cast<MPI_Request*>(reqs), reinterpret_cast<MPI_Status*>(stats)));
+            std::vector<MPI_Request> h = handles(reqs, count);
+            MPIWRAP_CALL(MPI_Waitall(count, &h.front(), reinterpret_cast<MPI_Status*>(stats)));
+            update(reqs, h, count);
         }
 
         friend void waitAll(std::vector<Request>& reqs, std::vector<Status>& stats)
@@ -183,7 +267,9 @@ class Request
         {
 #if MPIWRAP_VERSION_AT_LEAST(2,0)
             MPI_Int flag;
-            MPIWRAP_CALL(MPI_Testall(count, reinterpret_cast<MPI_Request*>(reqs), &flag, MPI_STATUSES_IGNORE));
+            std::vector<MPI_Request> h = handles(reqs, count);
+            MPIWRAP_CALL(MPI_Testall(count, &h.front(), &flag, MPI_STATUSES_IGNORE));
+            update(reqs, h, count);
             return flag;
 #else
             std::vector<Status> stats(count);
@@ -199,7 +285,9 @@ class Request
         friend bool testAll(Request* reqs, Status* stats, MPI_Int count)
         {
             MPI_Int flag;
-            MPIWRAP_CALL(MPI_Testall(count, reinterpret_cast<MPI_Request*>(reqs), &flag, reinterpret_cast<MPI_Status*>(stats)));
+            std::vector<MPI_Request> h = handles(reqs, count);
+            MPIWRAP_CALL(MPI_Testall(count, &h.front(), &flag, reinterpret_cast<MPI_Status*>(stats)));
+            update(reqs, h, count);
             return flag;
         }
 
@@ -215,7 +303,9 @@ class Request
 #if MPIWRAP_VERSION_AT_LEAST(2,0)
             std::vector<MPI_Int> i(count);
             MPI_Int n;
-            MPIWRAP_CALL(MPI_Waitsome(count, reinterpret_cast<MPI_Request*>(reqs), &n, &i.front(), MPI_STATUSES_IGNORE))
+            std::vector<MPI_Request> h = handles(reqs, count);
+            MPIWRAP_CALL(MPI_Waitsome(count, &h.front(), &n, &i.front(), MPI_STATUSES_IGNORE))
+            update(reqs, h, count);
             std::vector<Request*> ret(n);
             for (MPI_Int j = 0;j < n;j++)
             {
@@ -237,7 +327,9 @@ class Request
         {
             std::vector<MPI_Int> i(count);
             MPI_Int n;
-            MPIWRAP_CALL(MPI_Waitsome(count, reinterpret_cast<MPI_Request*>(reqs), &n, &i.front(), reinterpret_cast<MPI_Status*>(stats)))
+            std::vector<MPI_Request> h = handles(reqs, count);
+            MPIWRAP_CALL(MPI_Waitsome(count, &h.front(), &n, &i.front(), reinterpret_cast<MPI_Status*>(stats)))
+            update(reqs, h, count);
             std::vector<Request*> ret(n);
             for (MPI_Int j = 0;j < n;j++)
             {
@@ -258,7 +350,9 @@ class Request
 #if MPIWRAP_VERSION_AT_LEAST(2,0)
             std::vector<MPI_Int> i(count);
             MPI_Int n;
-            MPIWRAP_CALL(MPI_Testsome(count, reinterpret_cast<MPI_Request*>(reqs), &n, &i.front(), MPI_STATUSES_IGNORE))
+            std::vector<MPI_Request> h = handles(reqs, count);
+            MPIWRAP_CALL(MPI_Testsome(count, &h.front(), &n, &i.front(), MPI_STATUSES_IGNORE))
+            update(reqs, h, count);
             std::vector<Request*> ret(n);
             for (MPI_Int j = 0;j < n;j++)
             {
@@ -280,7 +374,9 @@ class Request
         {
             std::vector<MPI_Int> i(count);
             MPI_Int n;
-            MPIWRAP_CALL(MPI_Testsome(count, reinterpret_cast<MPI_Request*>(reqs), &n, &i.front(), reinterpret_cast<MPI_Status*>(stats)))
+            std::vector<MPI_Request> h = handles(reqs, count);
+            MPIWRAP_CALL(MPI_Testsome(count, &h.front(), &n, &i.front(), reinterpret_cast<MPI_Status*>(stats)))
+            update(reqs, h, count);
             std::vector<Request*> ret(n);
             for (MPI_Int j = 0;j < n;j++)
             {
@@ -0,0 +1,392 @@
+#include "codegen.hpp"
+
+namespace aquarius
+{
+namespace autocc
+{
+
+/*
+ * Assign spins to lines ordered by space, the first alpha[s] lines of
+ * space s being alpha
+ */
+static vector<Line> spinLines(const vector<Line>& lines, const vector<int>& alpha)
+{
+    vector<int> n(alpha.size(), 0);
+    vector<Line> s;
+    for (vector<Line>::const_iterator l = lines.begin();l != lines.end();++l)
+    {
+        int t = l->getType();
+        s.push_back(Line(l->getIndex(), t, Line::VIRTUAL, n[t]++ < alpha[t] ? Line::ALPHA : Line::BETA));
+    }
+    return s;
+}
+
+/*
+ * Lines of an operand, where those shared with the result take its spin
+ * (and are also added to shared) and the rest are summed over
+ */
+static vector<Line> operandLines(const vector<Line>& lines, const vector<Line>& result,
+                                 vector<Line>& shared)
+{
+    vector<Line> op;
+    for (vector<Line>::const_iterator l = lines.begin();l != lines.end();++l)
+    {
+        vector<Line>::const_iterator r;
+        for (r = result.begin();r != result.end() && r->getIndex() != l->getIndex();++r);
+
+        if (r != result.end())
+        {
+            op.push_back(*r);
+            shared.push_back(*r);
+        }
+        else
+        {
+            op.push_back(Line(l->getIndex(), l->getType(), Line::VIRTUAL, Line::BETA));
+        }
+    }
+    return op;
+}
+
+static vector<int> alphaCount(const vector<Line>& lines, int nspaces)
+{
+    vector<int> n(nspaces, 0);
+    for (vector<Line>::const_iterator l = lines.begin();l != lines.end();++l)
+        if (l->isAlpha()) n[l->getType()]++;
+    return n;
+}
+
+static int spin(const Fragment& f)
+{
+    int nalpha_out = 0, nalpha_in = 0;
+    for (auto& l : f.getIndicesOut()) if (l.isAlpha()) nalpha_out++;
+    for (auto& l : f.getIndicesIn()) if (l.isAlpha()) nalpha_in++;
+    return (2*nalpha_out-(int)f.getIndicesOut().size()) -
+           (2*nalpha_in -(int)f.getIndicesIn().size());
+}
+
+static string literal(double x)
+{
+    string s = str("%.15g", x);
+    if (s.find_first_of(".en") == string::npos) s += ".0";
+    return s;
+}
+
+static string literal(const vector<int>& v)
+{
+    string s = "{";
+    for (int i = 0;i < v.size();i++) s += (i ? "," : "") + std::to_string(v[i]);
+    return s + "}";
+}
+
+CodeGenerator::CodeGenerator(const Schedule& schedule, const string& name,
+                             const string& type, int nspaces)
+: schedule(schedule), name(name), type(type), nspaces(nspaces) {}
+
+vector<pair<vector<int>,vector<int>>> CodeGenerator::spinCases(const vector<int>& nout,
+                                                               const vector<int>& nin)
+{
+    vector<pair<vector<int>,vector<int>>> cases;
+
+    int nouttot = aquarius::sum(nout);
+    int nintot = aquarius::sum(nin);
+
+    vector<int> alpha_out(nout.size(), 0);
+    for (bool doneout = false;!doneout;)
+    {
+        vector<int> alpha_in(nin.size(), 0);
+        for (bool donein = false;!donein;)
+        {
+            if (aquarius::sum(alpha_in)-aquarius::sum(alpha_out) == (nintot-nouttot)/2)
+                cases.push_back(make_pair(alpha_out, alpha_in));
+
+            int s;
+            for (s = 0;s < nin.size() && alpha_in[s] == nin[s];s++) alpha_in[s] = 0;
+            if (s == nin.size()) donein = true;
+            else alpha_in[s]++;
+        }
+
+        int s;
+        for (s = 0;s < nout.size() && alpha_out[s] == nout[s];s++) alpha_out[s] = 0;
+        if (s == nout.size()) doneout = true;
+        else alpha_out[s]++;
+    }
+
+    return cases;
+}
+
+vector<CodeGenerator::Contraction> CodeGenerator::expand(const Schedule::Operand& A,
+                                                         const Schedule::Operand* B,
+                                                         const Schedule::Operand& C,
+                                                         const vector<int>& alpha_out_C,
+                                                         const vector<int>& alpha_in_C,
+                                                         int nspaces)
+{
+    /*
+     * This follows SpinorbitalTensor::mult and SpinorbitalTensor::sum
+     */
+    vector<Line> lines_C_out = spinLines(C.out, alpha_out_C);
+    vector<Line> lines_C_in = spinLines(C.in, alpha_in_C);
+    vector<Line> lines_C = lines_C_out+lines_C_in;
+
+    vector<Line> lines_AandC_out, lines_AandC_in;
+    vector<Line> lines_BandC_out, lines_BandC_in;
+    vector<Line> lines_A_out = operandLines(A.out, lines_C, lines_AandC_out);
+    vector<Line> lines_A_in = operandLines(A.in, lines_C, lines_AandC_in);
+
+    Term term = Term(Diagram::SPINORBITAL)*Fragment("A", lines_A_out, lines_A_in);
+    if (B)
+    {
+        vector<Line> lines_B_out = operandLines(B->out, lines_C, lines_BandC_out);
+        vector<Line> lines_B_in = operandLines(B->in, lines_C, lines_BandC_in);
+        term *= Fragment("B", lines_B_out, lines_B_in);
+    }
+
+    vector<Line> lines_CnotAB_out = lines_C_out;
+    unique(lines_AandC_out);
+    unique(lines_BandC_out);
+    unique(lines_CnotAB_out);
+    exclude(lines_CnotAB_out, lines_AandC_out);
+    exclude(lines_CnotAB_out, lines_BandC_out);
+
+    vector<Line> lines_CnotAB_in = lines_C_in;
+    unique(lines_AandC_in);
+    unique(lines_BandC_in);
+    unique(lines_CnotAB_in);
+    exclude(lines_CnotAB_in, lines_AandC_in);
+    exclude(lines_CnotAB_in, lines_BandC_in);
+
+    Diagram d(Diagram::SPINORBITAL, {term});
+
+    /*
+     * A sum is only antisymmetrized when both the shared and the new lines
+     * are present, while a contraction always is
+     */
+    int minGroups = (B ? 1 : 2);
+
+    for (int side = 0;side < 2;side++)
+    {
+        for (int s = 0;s < nspaces;s++)
+        {
+            vector<vector<Line>> assym;
+            for (const vector<Line>* group : side == 0 ?
+                 vector<const vector<Line>*>{&lines_AandC_out, &lines_BandC_out, &lines_CnotAB_out} :
+                 vector<const vector<Line>*>{&lines_AandC_in, &lines_BandC_in, &lines_CnotAB_in})
+            {
+                vector<Line> g = filtered(*group, isType(s));
+                if (!g.empty()) assym.push_back(g);
+            }
+            if (assym.size() >= minGroups) d.antisymmetrize(assym);
+        }
+    }
+
+    d.convert(Diagram::UHF);
+
+    /*
+     * Remove terms which are antisymmetrizations of same-spin groups
+     */
+    for (int s = 0;s < nspaces;s++)
+    {
+        for (int spin = 0;spin < 2;spin++)
+        {
+            vector<Term> terms = d.getTerms();
+            for (vector<Term>::iterator t1 = terms.begin();t1 != terms.end();++t1)
+            {
+                for (vector<Term>::iterator t2 = t1+1;t2 != terms.end();++t2)
+                {
+                    if (Term(*t1).fixorder(filtered(t1->indices(), and1(isSpin(spin),isType(s)))) ==
+                        Term(*t2).fixorder(filtered(t2->indices(), and1(isSpin(spin),isType(s)))))
+                    {
+                        d -= *t1;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    d *= Term(Diagram::UHF)*Fragment("C", lines_C_out, lines_C_in);
+    d.fixorder(true);
+
+    vector<Contraction> contractions;
+
+    for (vector<Term>::const_iterator t = d.getTerms().begin();t != d.getTerms().end();++t)
+    {
+        const Fragment *fA = NULL, *fB = NULL, *fC = NULL;
+        for (vector<Fragment>::const_iterator f = t->getFragments().begin();f != t->getFragments().end();++f)
+        {
+            if (f->getOp() == "A") fA = &*f;
+            if (f->getOp() == "B") fB = &*f;
+            if (f->getOp() == "C") fC = &*f;
+        }
+
+        if (spin(*fA) != 0 || (fB && spin(*fB) != 0)) continue;
+
+        Contraction c;
+        c.factor = t->getFactor();
+        c.alpha_out_A = alphaCount(fA->getIndicesOut(), nspaces);
+        c.alpha_in_A = alphaCount(fA->getIndicesIn(), nspaces);
+        c.alpha_out_C = alpha_out_C;
+        c.alpha_in_C = alpha_in_C;
+
+        /*
+         * Label the spin-orbital lines A, B, ... in order of appearance
+         */
+        vector<int> labels;
+        auto label = [&](const vector<Line>& lines, string& idx)
+        {
+            for (vector<Line>::const_iterator l = lines.begin();l != lines.end();++l)
+            {
+                int i;
+                for (i = 0;i < labels.size() && labels[i] != l->asInt();i++);
+                if (i == labels.size()) labels.push_back(l->asInt());
+                idx += (char)('A'+i);
+            }
+        };
+
+        label(fA->getIndicesOut(), c.idx_A);
+        label(fA->getIndicesIn(), c.idx_A);
+        if (fB)
+        {
+            c.alpha_out_B = alphaCount(fB->getIndicesOut(), nspaces);
+            c.alpha_in_B = alphaCount(fB->getIndicesIn(), nspaces);
+            label(fB->getIndicesOut(), c.idx_B);
+            label(fB->getIndicesIn(), c.idx_B);
+        }
+        label(fC->getIndicesOut(), c.idx_C);
+        label(fC->getIndicesIn(), c.idx_C);
+
+        contractions.push_back(c);
+    }
+
+    return contractions;
+}
+
+void CodeGenerator::writeStep(ostream& out, const Schedule::Step& step, Style style) const
+{
+    auto ref = [&](const string& name)
+    {
+        return contains(schedule.intermediates, name) ? "(*" + name + ")" : name;
+    };
+
+    string C = ref(step.C.name);
+    string A = ref(step.A.name);
+    string B = ref(step.B.name);
+
+    if (style == SPINORBITAL)
+    {
+        out << "    " << C << "[\"" << step.C.indices() << "\"] "
+            << (step.accumulate ? "+= " : "= ");
+        if (step.factor != 1) out << literal(step.factor) << "*";
+        out << A << "[\"" << step.A.indices() << "\"]";
+        if (!step.B.name.empty())
+            out << "*" << B << "[\"" << step.B.indices() << "\"]";
+        out << ";" << endl;
+        return;
+    }
+
+    vector<pair<vector<int>,vector<int>>> cases =
+        spinCases(step.C.getNumOut(nspaces), step.C.getNumIn(nspaces));
+
+    for (vector<pair<vector<int>,vector<int>>>::iterator sc = cases.begin();sc != cases.end();++sc)
+    {
+        vector<Contraction> contractions =
+            expand(step.A, step.B.name.empty() ? NULL : &step.B, step.C,
+                   sc->first, sc->second, nspaces);
+
+        double beta = (step.accumulate ? 1 : 0);
+
+        for (vector<Contraction>::iterator c = contractions.begin();c != contractions.end();++c)
+        {
+            string Csc = C + "(" + literal(c->alpha_out_C) + "," + literal(c->alpha_in_C) + ")";
+            string Asc = A + "(" + literal(c->alpha_out_A) + "," + literal(c->alpha_in_A) + ")";
+
+            if (step.B.name.empty())
+            {
+                out << "    " << Csc << ".sum(" << literal(step.factor*c->factor)
+                    << ", false, " << Asc << ", \"" << c->idx_A << "\", "
+                    << literal(beta) << ", \"" << c->idx_C << "\");" << endl;
+            }
+            else
+            {
+                string Bsc = B + "(" + literal(c->alpha_out_B) + "," + literal(c->alpha_in_B) + ")";
+
+                out << "    " << Csc << ".mult(" << literal(step.factor*c->factor)
+                    << ", false, " << Asc << ", \"" << c->idx_A << "\", false, "
+                    << Bsc << ", \"" << c->idx_B << "\", "
+                    << literal(beta) << ", \"" << c->idx_C << "\");" << endl;
+            }
+
+            beta = 1;
+        }
+    }
+}
+
+void CodeGenerator::write(ostream& out, Style style) const
+{
+    const vector<Schedule::Step>& steps = schedule.steps;
+    const string& result = schedule.result.name;
+    string tensor = "SpinorbitalTensor<" + type + ">";
+
+    vector<string> operands;
+    for (vector<Schedule::Step>::const_iterator step = steps.begin();step != steps.end();++step)
+    {
+        for (const string& name : {step->A.name, step->B.name})
+        {
+            if (name.empty() || name == result ||
+                contains(schedule.intermediates, name) ||
+                contains(operands, name)) continue;
+            operands.push_back(name);
+        }
+    }
+
+    out << "/*" << endl;
+    out << " * Generated by autocc::CodeGenerator; "
+        << printos("%g multiply-adds, %g words in intermediates",
+                   schedule.getFlops(), schedule.getMemory()) << endl;
+    out << " */" << endl;
+    out << "inline void " << name << "(";
+    for (vector<string>::iterator op = operands.begin();op != operands.end();++op)
+        out << "const " << tensor << "& " << *op << "," << endl << string(name.size()+13, ' ');
+    out << tensor << "& " << result << "," << endl << string(name.size()+13, ' ')
+        << "const vector<op::Space>& spaces)" << endl;
+    out << "{" << endl;
+
+    for (int s = 0;s < steps.size();s++)
+    {
+        const Schedule::Step& step = steps[s];
+
+        if (contains(schedule.intermediates, step.C.name))
+        {
+            out << "    unique_ptr<" << tensor << "> " << step.C.name << "(new " << tensor
+                << "(\"" << step.C.name << "\", " << result << ".arena, " << result << ".getGroup(), spaces, "
+                << literal(step.C.getNumOut(nspaces)) << ", "
+                << literal(step.C.getNumIn(nspaces)) << "));" << endl;
+        }
+
+        if (style == SPINCASES)
+        {
+            out << "    // " << step.C.name << "[\"" << step.C.indices() << "\"] "
+                << (step.accumulate ? "+= " : "= ");
+            if (step.factor != 1) out << literal(step.factor) << "*";
+            out << step.A.name << "[\"" << step.A.indices() << "\"]";
+            if (!step.B.name.empty())
+                out << "*" << step.B.name << "[\"" << step.B.indices() << "\"]";
+            out << endl;
+        }
+
+        writeStep(out, step, style);
+
+        for (int i = 0;i < schedule.intermediates.size();i++)
+        {
+            if (schedule.lastUse[i] == s)
+                out << "    " << schedule.intermediates[i] << ".reset();" << endl;
+        }
+
+        if (s != steps.size()-1) out << endl;
+    }
+
+    out << "}" << endl;
+}
+
+}
+}
@@ -0,0 +1,82 @@
+#ifndef _AQUARIUS_AUTOCC_CODEGEN_HPP_
+#define _AQUARIUS_AUTOCC_CODEGEN_HPP_
+
+#include "util/global.hpp"
+
+#include "schedule.hpp"
+
+namespace aquarius
+{
+namespace autocc
+{
+
+/*
+ * Write a Schedule out as a C++ function which evaluates the residual.
+ *
+ * The function takes the operands (in order of first use) as const
+ * SpinorbitalTensors, the result, and the spaces on which the intermediates
+ * are created (as for Schedule::execute). With SPINORBITAL, each step is
+ * written in the index-string notation of the CC codes, and the spin cases
+ * are expanded at run time as usual. With SPINCASES, each step is expanded
+ * here into the SymmetryBlockedTensor contractions which
+ * SpinorbitalTensor::mult (or sum) would perform, with the prefactors of the
+ * individual spin cases folded in, so that no diagram algebra is left to be
+ * done at run time. All operands, intermediates and the result are taken to
+ * have spin 0.
+ */
+class CodeGenerator
+{
+    public:
+        enum Style {SPINORBITAL, SPINCASES};
+
+        /*
+         * A single spin case of a binary contraction (or of a sum, if
+         * idx_B is empty), C(alpha_out_C,alpha_in_C)[idx_C] +=
+         * factor*A(alpha_out_A,alpha_in_A)[idx_A]*B(alpha_out_B,alpha_in_B)[idx_B]
+         */
+        struct Contraction
+        {
+            double factor;
+            vector<int> alpha_out_A, alpha_in_A;
+            vector<int> alpha_out_B, alpha_in_B;
+            vector<int> alpha_out_C, alpha_in_C;
+            string idx_A, idx_B, idx_C;
+        };
+
+    protected:
+        const Schedule& schedule;
+        string name;
+        string type;
+        int nspaces;
+
+        void writeStep(ostream& out, const Schedule::Step& step, Style style) const;
+
+    public:
+        CodeGenerator(const Schedule& schedule, const string& name,
+                      const string& type = "double", int nspaces = 2);
+
+        /*
+         * The spin cases (with spin 0) of a tensor with the given number of
+         * out and in lines in each space
+         */
+        static vector<pair<vector<int>,vector<int>>> spinCases(const vector<int>& nout,
+                                                               const vector<int>& nin);
+
+        /*
+         * Expand the spin case (alpha_out_C,alpha_in_C) of C = A*B (or C = A
+         * if B is NULL) into contractions of individual spin cases
+         */
+        static vector<Contraction> expand(const Schedule::Operand& A,
+                                          const Schedule::Operand* B,
+                                          const Schedule::Operand& C,
+                                          const vector<int>& alpha_out_C,
+                                          const vector<int>& alpha_in_C,
+                                          int nspaces);
+
+        void write(ostream& out, Style style = SPINCASES) const;
+};
+
+}
+}
+
+#endif
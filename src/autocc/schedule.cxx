@@ -0,0 +1,435 @@
+#include "schedule.hpp"
+
+namespace aquarius
+{
+namespace autocc
+{
+
+ostream& operator<<(ostream& out, const Schedule& s)
+{
+    for (vector<Schedule::Step>::const_iterator step = s.steps.begin();step != s.steps.end();++step)
+    {
+        out << step->C.name << "[\"" << step->C.indices() << "\"] "
+            << (step->accumulate ? "+= " : "= ");
+        if (step->factor != 1) out << step->factor << "*";
+        out << step->A.name << "[\"" << step->A.indices() << "\"]";
+        if (!step->B.name.empty())
+            out << "*" << step->B.name << "[\"" << step->B.indices() << "\"]";
+        out << ";" << endl;
+    }
+
+    out << printos("# %g multiply-adds, %g words in intermediates", s.flops, s.peak) << endl;
+
+    return out;
+}
+
+string Schedule::Operand::indices() const
+{
+    string s;
+    for (vector<Line>::const_iterator l = out.begin();l != out.end();++l) s += (char)l->getIndex();
+    for (vector<Line>::const_iterator l =  in.begin();l !=  in.end();++l) s += (char)l->getIndex();
+    return s;
+}
+
+vector<int> Schedule::Operand::getNumOut(int nspaces) const
+{
+    vector<int> n(nspaces, 0);
+    for (vector<Line>::const_iterator l = out.begin();l != out.end();++l) n[l->getType()]++;
+    return n;
+}
+
+vector<int> Schedule::Operand::getNumIn(int nspaces) const
+{
+    vector<int> n(nspaces, 0);
+    for (vector<Line>::const_iterator l = in.begin();l != in.end();++l) n[l->getType()]++;
+    return n;
+}
+
+/*
+ * Subsets of the fragments of a single term, as bit masks
+ */
+struct Schedule::Node
+{
+    const vector<Fragment>& frags;
+    vector<Line> external;
+
+    Node(const Term& term)
+    : frags(term.getFragments()), external(term.external()) {}
+
+    vector<Line> lines(unsigned S) const
+    {
+        vector<Line> l;
+        for (int f = 0;f < frags.size();f++)
+            if (S & (1u<<f)) l += frags[f].indices();
+        return uniqued(l);
+    }
+
+    /*
+     * Lines of the subset S which are either external to the term or
+     * connect to a fragment outside of S
+     */
+    vector<Line> ext(unsigned S) const
+    {
+        vector<Line> outside;
+        for (int f = 0;f < frags.size();f++)
+            if (!(S & (1u<<f))) outside += frags[f].indices();
+
+        vector<Line> e;
+        for (auto& l : lines(S))
+            if (contains(external, l) || contains(outside, l)) e.push_back(l);
+        return e;
+    }
+
+    bool isOut(unsigned S, const Line& l) const
+    {
+        for (int f = 0;f < frags.size();f++)
+            if ((S & (1u<<f)) && contains(frags[f].getIndicesOut(), l)) return true;
+        return false;
+    }
+
+    /*
+     * A key which is equal for subsets (of this or any other term) which
+     * are the same up to a relabeling of lines, and the external lines of S
+     * in the corresponding canonical order (out lines first, each ordered
+     * by space)
+     */
+    string canonical(unsigned S, vector<Line>& out, vector<Line>& in) const
+    {
+        vector<int> which;
+        for (int f = 0;f < frags.size();f++)
+            if (S & (1u<<f)) which.push_back(f);
+
+        vector<Line> e = ext(S);
+
+        string best;
+        vector<Line> order;
+
+        do
+        {
+            map<Line,int> label;
+            vector<Line> seen;
+            string key;
+
+            auto code = [&](const Line& l)
+            {
+                if (!label.count(l))
+                {
+                    label[l] = seen.size();
+                    seen.push_back(l);
+                }
+                key += std::to_string(label[l]) + (l.isOccupied() ? "o" : "v") +
+                       (contains(external, l) ? "E" : contains(e, l) ? "C" : "I") + " ";
+            };
+
+            for (int f : which)
+            {
+                key += frags[f].getOp() + "(";
+                for (auto& l : frags[f].getIndicesOut()) code(l);
+                key += ",";
+                for (auto& l : frags[f].getIndicesIn()) code(l);
+                key += ")";
+            }
+
+            if (best.empty() || key < best)
+            {
+                best = key;
+                order = seen;
+            }
+        }
+        while (next_permutation(which.begin(), which.end()));
+
+        out.clear();
+        in.clear();
+        for (auto& l : order)
+        {
+            if (!contains(e, l)) continue;
+            if (isOut(S, l)) out.push_back(l);
+            else in.push_back(l);
+        }
+
+        auto bySpace = [](const Line& a, const Line& b) { return a.getType() < b.getType(); };
+        stable_sort(out.begin(), out.end(), bySpace);
+        stable_sort(in.begin(), in.end(), bySpace);
+
+        return best;
+    }
+
+    /*
+     * Whether S = S1+S2 may be formed as an (antisymmetrized) intermediate
+     */
+    bool legal(unsigned S1, unsigned S2) const
+    {
+        unsigned S = S1|S2;
+        if (S == (1u<<frags.size())-1) return true;
+
+        vector<Line> e = ext(S), e1 = ext(S1), e2 = ext(S2);
+
+        for (int side = 0;side < 2;side++)
+        {
+            for (int space = 0;space < 2;space++)
+            {
+                bool from1 = false, from2 = false, allext = true;
+
+                for (auto& l : e)
+                {
+                    if (isOut(S, l) != (side == 0) || l.getType() != space) continue;
+                    if (contains(e1, l)) from1 = true;
+                    if (contains(e2, l)) from2 = true;
+                    if (!contains(external, l)) allext = false;
+                }
+
+                if (from1 && from2 && !allext) return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+double Schedule::size(const vector<Line>& lines) const
+{
+    double s = 1;
+    for (vector<Line>::const_iterator l = lines.begin();l != lines.end();++l) s *= len[l->getType()];
+    return s;
+}
+
+Schedule::Schedule(const Fragment& result_, const Diagram& residual,
+                   const vector<double>& len, double memory)
+: result(result_), len(len), memory(memory), flops(0), peak(0)
+{
+    const vector<Term>& terms = residual.getTerms();
+    const double inf = numeric_limits<double>::infinity();
+
+    /*
+     * Count the number of terms in which each intermediate could be used
+     */
+    map<string,set<int>> uses;
+
+    for (int t = 0;t < terms.size();t++)
+    {
+        Node node(terms[t]);
+        int n = node.frags.size();
+        if (n > 16) throw logic_error("too many fragments in term");
+
+        vector<Line> out, in;
+        for (unsigned S = 1;S < (1u<<n)-1;S++)
+        {
+            if (__builtin_popcount(S) < 2) continue;
+            uses[node.canonical(S, out, in)].insert(t);
+        }
+    }
+
+    map<string,Operand> formed;
+    vector<double> sizes;
+
+    for (int t = 0;t < terms.size();t++)
+    {
+        Node node(terms[t]);
+        int n = node.frags.size();
+        unsigned full = (1u<<n)-1;
+
+        if (n == 0) continue;
+
+        /*
+         * Optimal binary contraction tree for this term
+         */
+        vector<double> cost(full+1, inf);
+        vector<unsigned> split(full+1, 0);
+        vector<string> key(full+1);
+        vector<Operand> shape(full+1);
+
+        for (unsigned S = 1;S <= full;S++)
+        {
+            if (__builtin_popcount(S) == 1)
+            {
+                cost[S] = 0;
+                continue;
+            }
+
+            key[S] = node.canonical(S, shape[S].out, shape[S].in);
+
+            if (S != full && formed.count(key[S]))
+            {
+                cost[S] = 0;
+                continue;
+            }
+
+            if (S != full && memory > 0 &&
+                size(shape[S].out)*size(shape[S].in) > memory) continue;
+
+            double share = (S == full ? 1 : uses[key[S]].size());
+
+            for (unsigned S1 = (S-1)&S;S1 > 0;S1 = (S1-1)&S)
+            {
+                unsigned S2 = S^S1;
+                if (S1 < S2) continue;
+                if (cost[S1] == inf || cost[S2] == inf) continue;
+                if (!node.legal(S1, S2)) continue;
+
+                double c = cost[S1]+cost[S2]+size(uniqued(node.ext(S1)+node.ext(S2)))/share;
+
+                if (c < cost[S])
+                {
+                    cost[S] = c;
+                    split[S] = S1;
+                }
+            }
+        }
+
+        if (cost[full] == inf)
+            throw runtime_error("no factorization of a term fits in memory");
+
+        /*
+         * Write out the contractions, forming each new intermediate once
+         */
+        std::function<Operand(unsigned)> emit = [&](unsigned S) -> Operand
+        {
+            if (__builtin_popcount(S) == 1)
+            {
+                int f = __builtin_ctz(S);
+                return Operand(node.frags[f]);
+            }
+
+            if (S != full && formed.count(key[S]))
+            {
+                Operand op = shape[S];
+                op.name = formed[key[S]].name;
+                return op;
+            }
+
+            Step step;
+            step.A = emit(split[S]);
+            step.B = emit(S^split[S]);
+            step.flops = size(uniqued(node.ext(split[S])+node.ext(S^split[S])));
+
+            if (S == full)
+            {
+                step.C = result;
+                step.factor = terms[t].getFactor();
+                step.accumulate = true;
+            }
+            else
+            {
+                step.C = shape[S];
+                step.C.name = "I" + std::to_string(intermediates.size()+1);
+                step.factor = 1;
+                step.accumulate = false;
+                formed[key[S]] = step.C;
+                intermediates.push_back(step.C.name);
+                sizes.push_back(size(step.C.out)*size(step.C.in));
+            }
+
+            flops += step.flops;
+            steps.push_back(step);
+            return step.C;
+        };
+
+        if (n == 1)
+        {
+            Step step;
+            step.C = result;
+            step.A = Operand(node.frags[0]);
+            step.factor = terms[t].getFactor();
+            step.accumulate = true;
+            step.flops = size(node.external);
+            flops += step.flops;
+            steps.push_back(step);
+        }
+        else
+        {
+            emit(full);
+        }
+    }
+
+    /*
+     * Free each intermediate after its last use
+     */
+    lastUse.assign(intermediates.size(), -1);
+    for (int s = 0;s < steps.size();s++)
+    {
+        for (int i = 0;i < intermediates.size();i++)
+        {
+            if (steps[s].A.name == intermediates[i] ||
+                steps[s].B.name == intermediates[i]) lastUse[i] = s;
+        }
+    }
+
+    double current = 0;
+    for (int s = 0;s < steps.size();s++)
+    {
+        for (int i = 0;i < intermediates.size();i++)
+        {
+            if (steps[s].C.name == intermediates[i]) current += sizes[i];
+        }
+        peak = max(peak, current);
+        for (int i = 0;i < intermediates.size();i++)
+        {
+            if (lastUse[i] == s) current -= sizes[i];
+        }
+    }
+}
+
+Fragment Schedule::parseFragment(const string& s)
+{
+    size_t lp = s.find('(');
+    size_t comma = s.find(',');
+    size_t rp = s.find(')');
+
+    if (lp == string::npos || comma == string::npos || rp == string::npos ||
+        !(lp < comma && comma < rp))
+    {
+        throw logic_error("malformed fragment: " + s);
+    }
+
+    auto parse = [](const string& idx)
+    {
+        vector<Line> lines;
+        for (char c : idx)
+        {
+            bool occ = c >= 'i' && c <= 'p';
+            lines.push_back(Line((int)c, occ ? 1 : 0, occ ? Line::OCCUPIED : Line::VIRTUAL, Line::ALPHA));
+        }
+        return lines;
+    };
+
+    return Fragment(s.substr(0, lp), parse(s.substr(lp+1, comma-lp-1)),
+                                     parse(s.substr(comma+1, rp-comma-1)));
+}
+
+Term Schedule::parseTerm(const string& s)
+{
+    istringstream iss(s);
+    string token;
+    Fraction factor;
+    vector<Fragment> fragments;
+
+    while (iss >> token)
+    {
+        /*
+         * A sign written directly in front of a fragment, as in "-F(m,i)"
+         */
+        if (token.size() > 1 && token[0] == '-' && !isdigit(token[1]))
+        {
+            factor = -factor;
+            token.erase(0, 1);
+        }
+
+        if (token == "-")
+        {
+            factor = -factor;
+        }
+        else if (isdigit(token[0]) || token[0] == '-')
+        {
+            factor *= Fraction(token);
+        }
+        else
+        {
+            fragments.push_back(parseFragment(token));
+        }
+    }
+
+    return Term(Diagram::SPINORBITAL, factor, fragments);
+}
+
+}
+}
@@ -0,0 +1,178 @@
+#ifndef _AQUARIUS_AUTOCC_SCHEDULE_HPP_
+#define _AQUARIUS_AUTOCC_SCHEDULE_HPP_
+
+#include "util/global.hpp"
+
+#include "tensor/spinorbital_tensor.hpp"
+#include "operator/space.hpp"
+
+#include "autocc.hpp"
+
+namespace aquarius
+{
+namespace autocc
+{
+
+class Schedule;
+class CodeGenerator;
+
+ostream& operator<<(ostream& out, const Schedule& s);
+
+/*
+ * Factorize a residual, given as a spin-orbital Diagram, into a sequence of
+ * binary tensor contractions.
+ *
+ * Each term is understood as in the tensor expressions of the CC codes,
+ * i.e. the product is implicitly antisymmetrized over the external lines of
+ * the result. Every line must have its space (0 = virtual, 1 = occupied) as
+ * its type and a letter as its index (see parseTerm), which is used when
+ * writing or executing the contractions.
+ *
+ * For each term, the contraction order is found by dynamic programming over
+ * subsets of its fragments, where the cost of an intermediate is shared
+ * among all of the terms in which it appears (up to relabeling of lines);
+ * such intermediates are then only formed once. Intermediates larger than
+ * the memory limit (in words) are never formed. Intermediates may only mix
+ * lines of the same space and side (in or out) from both operands when all
+ * of these lines are external to the whole term, since the intermediate is
+ * antisymmetrized over them.
+ */
+class Schedule
+{
+    friend ostream& operator<<(ostream& out, const Schedule& s);
+    friend class CodeGenerator;
+
+    public:
+        struct Operand
+        {
+            string name;
+            vector<Line> out, in;
+
+            Operand() {}
+
+            Operand(const string& name, const vector<Line>& out, const vector<Line>& in)
+            : name(name), out(out), in(in) {}
+
+            Operand(const Fragment& f)
+            : name(f.getOp()), out(f.getIndicesOut()), in(f.getIndicesIn()) {}
+
+            string indices() const;
+
+            vector<int> getNumOut(int nspaces) const;
+
+            vector<int> getNumIn(int nspaces) const;
+        };
+
+        /*
+         * C = factor*A*B (or C += ... if accumulate); B is empty (no name)
+         * for a term with a single fragment
+         */
+        struct Step
+        {
+            Operand C, A, B;
+            double factor;
+            bool accumulate;
+            double flops;
+        };
+
+    protected:
+        Operand result;
+        vector<double> len;
+        double memory;
+        vector<Step> steps;
+        vector<string> intermediates;
+        vector<int> lastUse;
+        double flops;
+        double peak;
+
+        struct Node;
+
+        double size(const vector<Line>& lines) const;
+
+    public:
+        Schedule(const Fragment& result, const Diagram& residual,
+                 const vector<double>& len, double memory = -1);
+
+        /*
+         * Parse a fragment such as "V(ab,ej)", where i-p denote occupied
+         * and all other letters virtual lines
+         */
+        static Fragment parseFragment(const string& s);
+
+        /*
+         * Parse a term such as "-1/2 V(mn,ef) T(ef,ij) T(ab,mn)"
+         */
+        static Term parseTerm(const string& s);
+
+        const vector<Step>& getSteps() const { return steps; }
+
+        /*
+         * Number of multiply-adds (ignoring permutational symmetry)
+         */
+        double getFlops() const { return flops; }
+
+        /*
+         * Largest number of words held in intermediates at any one time
+         */
+        double getMemory() const { return peak; }
+
+        /*
+         * Evaluate the residual into R, where the operands are given by name
+         * and the intermediates are created on the spaces of R
+         */
+        template <typename T>
+        void execute(const map<string,const tensor::SpinorbitalTensor<T>*>& operands,
+                     tensor::SpinorbitalTensor<T>& R, const vector<op::Space>& spaces) const
+        {
+            map<string,unique_ptr<tensor::SpinorbitalTensor<T>>> temps;
+
+            auto find = [&](const Operand& op) -> const tensor::SpinorbitalTensor<T>&
+            {
+                if (temps.count(op.name)) return *temps.at(op.name);
+                if (!operands.count(op.name))
+                    throw logic_error("operand " + op.name + " not given");
+                return *operands.at(op.name);
+            };
+
+            for (int s = 0;s < steps.size();s++)
+            {
+                const Step& step = steps[s];
+
+                tensor::SpinorbitalTensor<T>* C;
+                if (step.C.name == result.name)
+                {
+                    C = &R;
+                }
+                else
+                {
+                    C = new tensor::SpinorbitalTensor<T>(step.C.name, R.arena, R.getGroup(), spaces,
+                                                         step.C.getNumOut(spaces.size()),
+                                                         step.C.getNumIn(spaces.size()));
+                    temps[step.C.name].reset(C);
+                }
+
+                T beta = (step.accumulate ? 1 : 0);
+                if (step.B.name.empty())
+                {
+                    C->sum((T)step.factor, false, find(step.A), step.A.indices(),
+                           beta, step.C.indices());
+                }
+                else
+                {
+                    C->mult((T)step.factor, false, find(step.A), step.A.indices(),
+                                            false, find(step.B), step.B.indices(),
+                            beta, step.C.indices());
+                }
+
+                for (int i = 0;i < intermediates.size();i++)
+                {
+                    if (lastUse[i] == s) temps.erase(intermediates[i]);
+                }
+            }
+        }
+};
+
+}
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "ccd.hpp"
+#include "ccd_residual.hpp"
 
 using namespace aquarius::op;
 using namespace aquarius::input;
@@ -13,7 +14,8 @@ namespace cc
 
 template <typename U>
 CCD<U>::CCD(const string& name, Config& config)
-: Iterative<U>(name, config), diis(config.get("diis"))
+: Iterative<U>(name, config), diis(config.get("diis")),
+  generated(config.get<bool>("generated"))
 {
     vector<Requirement> reqs;
     reqs.push_back(Requirement("moints", "H"));
@@ -98,36 +100,44 @@ void CCD<U>::iterate(const Arena& arena)
     auto& WMNIJ = this->template gettmp<SpinorbitalTensor<U>>("WMNIJ");
     auto& WAMEI = this->template gettmp<SpinorbitalTensor<U>>("WAMEI");
 
-    /**************************************************************************
-     *
-     * Intermediates for CCD
-     */
-      FMI[  "mi"]  =       fMI[  "mi"];
-      FMI[  "mi"] += 0.5*VMNEF["mnef"]*T(2)["efin"];
-
-      FAE[  "ae"]  =       fAE[  "ae"];
-      FAE[  "ae"] -= 0.5*VMNEF["mnef"]*T(2)["afmn"];
-
-    WMNIJ["mnij"]  =     VMNIJ["mnij"];
-    WMNIJ["mnij"] += 0.5*VMNEF["mnef"]*T(2)["efij"];
-
-    WAMEI["amei"]  =     VAMEI["amei"];
-    WAMEI["amei"] += 0.5*VMNEF["mnef"]*T(2)["afni"];
-    /*
-     *************************************************************************/
-
-    /**************************************************************************
-     *
-     * CCD Iteration
-     */
-    Z(2)["abij"]  =     VABIJ["abij"];
-    Z(2)["abij"] +=       FAE[  "af"]*T(2)["fbij"];
-    Z(2)["abij"] -=       FMI[  "ni"]*T(2)["abnj"];
-    Z(2)["abij"] += 0.5*VABEF["abef"]*T(2)["efij"];
-    Z(2)["abij"] += 0.5*WMNIJ["mnij"]*T(2)["abmn"];
-    Z(2)["abij"] +=     WAMEI["amei"]*T(2)["ebjm"];
-    /*
-     *************************************************************************/
+    if (generated)
+    {
+        Z(2) = 0;
+        generated::ccdResidual(VABIJ, fMI, T(2), VMNIJ, fAE, VAMEI, VABEF, VMNEF, Z(2), {H.vrt, H.occ});
+    }
+    else
+    {
+        /**********************************************************************
+         *
+         * Intermediates for CCD
+         */
+          FMI[  "mi"]  =       fMI[  "mi"];
+          FMI[  "mi"] += 0.5*VMNEF["mnef"]*T(2)["efin"];
+
+          FAE[  "ae"]  =       fAE[  "ae"];
+          FAE[  "ae"] -= 0.5*VMNEF["mnef"]*T(2)["afmn"];
+
+        WMNIJ["mnij"]  =     VMNIJ["mnij"];
+        WMNIJ["mnij"] += 0.5*VMNEF["mnef"]*T(2)["efij"];
+
+        WAMEI["amei"]  =     VAMEI["amei"];
+        WAMEI["amei"] += 0.5*VMNEF["mnef"]*T(2)["afni"];
+        /*
+         *********************************************************************/
+
+        /**********************************************************************
+         *
+         * CCD Iteration
+         */
+        Z(2)["abij"]  =     VABIJ["abij"];
+        Z(2)["abij"] +=       FAE[  "af"]*T(2)["fbij"];
+        Z(2)["abij"] -=       FMI[  "ni"]*T(2)["abnj"];
+        Z(2)["abij"] += 0.5*VABEF["abef"]*T(2)["efij"];
+        Z(2)["abij"] += 0.5*WMNIJ["mnij"]*T(2)["abmn"];
+        Z(2)["abij"] +=     WAMEI["amei"]*T(2)["ebjm"];
+        /*
+         *********************************************************************/
+    }
 
     Z.weight(D);
     T += Z;
@@ -149,6 +159,8 @@ max_iterations?
     int 50,
 conv_type?
     enum { MAXE, RMSE, MAE },
+generated?
+    bool false,
 diis?
 {
     damping?
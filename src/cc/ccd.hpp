@@ -22,6 +22,11 @@ class CCD : public Iterative<U>
 {
     protected:
         convergence::DIIS<op::ExcitationOperator<U,2>> diis;
+        /*
+         * Use the residual generated by autocc (see ccd_residual.hpp) instead
+         * of the one below, as a check of the code generator
+         */
+        bool generated;
 
     public:
         CCD(const string& name, input::Config& config);
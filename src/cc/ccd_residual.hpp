@@ -0,0 +1,164 @@
+#ifndef _AQUARIUS_CC_CCD_RESIDUAL_HPP_
+#define _AQUARIUS_CC_CCD_RESIDUAL_HPP_
+
+#include "util/global.hpp"
+
+#include "tensor/spinorbital_tensor.hpp"
+#include "operator/space.hpp"
+
+namespace aquarius
+{
+namespace cc
+{
+namespace generated
+{
+
+using tensor::SpinorbitalTensor;
+
+/*
+ * The CCD residual, as used by ccd with generated = true to check the
+ * spin-case expansion of autocc::CodeGenerator against the hand-written
+ * iteration. The function below is the output of
+ *
+ *   bin/autocc-codegen -n ccdResidual <file>
+ *
+ * for a file containing the residual (with the intermediates of CCD<U>::
+ * iterate written out), and should not be edited by hand:
+ *
+ *   Z(ab,ij)
+ *   VABIJ(ab,ij)
+ *   fAE(a,e) T(eb,ij)
+ *   -1/2 VMNEF(mn,ef) T(af,mn) T(eb,ij)
+ *   -fMI(m,i) T(ab,mj)
+ *   -1/2 VMNEF(mn,ef) T(ef,in) T(ab,mj)
+ *   1/2 VABEF(ab,ef) T(ef,ij)
+ *   1/2 VMNIJ(mn,ij) T(ab,mn)
+ *   1/4 VMNEF(mn,ef) T(ef,ij) T(ab,mn)
+ *   VAMEI(am,ei) T(eb,jm)
+ *   1/2 VMNEF(mn,ef) T(af,ni) T(eb,jm)
+ */
+/*
+ * Generated by autocc::CodeGenerator; 1.3631e+10 multiply-adds, 1e+06 words in intermediates
+ */
+inline void ccdResidual(const SpinorbitalTensor<double>& VABIJ,
+                        const SpinorbitalTensor<double>& fMI,
+                        const SpinorbitalTensor<double>& T,
+                        const SpinorbitalTensor<double>& VMNIJ,
+                        const SpinorbitalTensor<double>& fAE,
+                        const SpinorbitalTensor<double>& VAMEI,
+                        const SpinorbitalTensor<double>& VABEF,
+                        const SpinorbitalTensor<double>& VMNEF,
+                        SpinorbitalTensor<double>& Z,
+                        const vector<op::Space>& spaces)
+{
+    // Z["abij"] += VABIJ["abij"]
+    Z({0,0},{0,0}).sum(1.0, false, VABIJ({0,0},{0,0}), "ABCD", 1.0, "ABCD");
+    Z({1,0},{0,1}).sum(1.0, false, VABIJ({1,0},{0,1}), "ABCD", 1.0, "ABCD");
+    Z({2,0},{0,2}).sum(1.0, false, VABIJ({2,0},{0,2}), "ABCD", 1.0, "ABCD");
+
+    // Z["abij"] += fMI["mi"]*T["abjm"]
+    Z({0,0},{0,0}).mult(-1.0, false, fMI({0,0},{0,0}), "AB", false, T({0,0},{0,0}), "CDAE", 1.0, "CDBE");
+    Z({1,0},{0,1}).mult(-1.0, false, fMI({0,1},{0,1}), "AB", false, T({1,0},{0,1}), "CDAE", 1.0, "CDBE");
+    Z({1,0},{0,1}).mult(-1.0, false, fMI({0,0},{0,0}), "AB", false, T({1,0},{0,1}), "CDEA", 1.0, "CDEB");
+    Z({2,0},{0,2}).mult(-1.0, false, fMI({0,1},{0,1}), "AB", false, T({2,0},{0,2}), "CDAE", 1.0, "CDBE");
+
+    // Z["abij"] += 0.5*VMNIJ["mnij"]*T["abmn"]
+    Z({0,0},{0,0}).mult(0.5, false, VMNIJ({0,0},{0,0}), "ABCD", false, T({0,0},{0,0}), "EFAB", 1.0, "EFCD");
+    Z({1,0},{0,1}).mult(1.0, false, VMNIJ({0,1},{0,1}), "ABCD", false, T({1,0},{0,1}), "EFAB", 1.0, "EFCD");
+    Z({2,0},{0,2}).mult(0.5, false, VMNIJ({0,2},{0,2}), "ABCD", false, T({2,0},{0,2}), "EFAB", 1.0, "EFCD");
+
+    // Z["abij"] += -1.0*fAE["ae"]*T["beij"]
+    Z({0,0},{0,0}).mult(1.0, false, fAE({0,0},{0,0}), "AB", false, T({0,0},{0,0}), "BCDE", 1.0, "ACDE");
+    Z({1,0},{0,1}).mult(1.0, false, fAE({1,0},{1,0}), "AB", false, T({1,0},{0,1}), "BCDE", 1.0, "ACDE");
+    Z({1,0},{0,1}).mult(1.0, false, fAE({0,0},{0,0}), "AB", false, T({1,0},{0,1}), "CBDE", 1.0, "CADE");
+    Z({2,0},{0,2}).mult(1.0, false, fAE({1,0},{1,0}), "AB", false, T({2,0},{0,2}), "BCDE", 1.0, "ACDE");
+
+    // Z["abij"] += -1.0*VAMEI["amei"]*T["bejm"]
+    Z({0,0},{0,0}).mult(-1.0, false, VAMEI({0,0},{0,0}), "ABCD", false, T({0,0},{0,0}), "CEBF", 1.0, "AEDF");
+    Z({0,0},{0,0}).mult(-1.0, false, VAMEI({0,1},{1,0}), "ABCD", false, T({1,0},{0,1}), "CEBF", 1.0, "AEDF");
+    Z({1,0},{0,1}).mult(-1.0, false, VAMEI({1,1},{1,1}), "ABCD", false, T({1,0},{0,1}), "CEBF", 1.0, "AEDF");
+    Z({1,0},{0,1}).mult(-1.0, false, VAMEI({1,0},{1,0}), "ABCD", false, T({1,0},{0,1}), "CEFB", 1.0, "AEFD");
+    Z({1,0},{0,1}).mult(-1.0, false, VAMEI({1,0},{0,1}), "ABCD", false, T({0,0},{0,0}), "CEBF", 1.0, "AEDF");
+    Z({1,0},{0,1}).mult(-1.0, false, VAMEI({0,1},{0,1}), "ABCD", false, T({1,0},{0,1}), "ECBF", 1.0, "EADF");
+    Z({1,0},{0,1}).mult(-1.0, false, VAMEI({0,0},{0,0}), "ABCD", false, T({1,0},{0,1}), "ECFB", 1.0, "EAFD");
+    Z({1,0},{0,1}).mult(-1.0, false, VAMEI({0,1},{1,0}), "ABCD", false, T({2,0},{0,2}), "CEBF", 1.0, "EAFD");
+    Z({2,0},{0,2}).mult(-1.0, false, VAMEI({1,1},{1,1}), "ABCD", false, T({2,0},{0,2}), "CEBF", 1.0, "AEDF");
+    Z({2,0},{0,2}).mult(-1.0, false, VAMEI({1,0},{0,1}), "ABCD", false, T({1,0},{0,1}), "ECFB", 1.0, "AEDF");
+
+    // Z["abij"] += 0.5*VABEF["abef"]*T["efij"]
+    Z({0,0},{0,0}).mult(0.5, false, VABEF({0,0},{0,0}), "ABCD", false, T({0,0},{0,0}), "CDEF", 1.0, "ABEF");
+    Z({1,0},{0,1}).mult(1.0, false, VABEF({1,0},{1,0}), "ABCD", false, T({1,0},{0,1}), "CDEF", 1.0, "ABEF");
+    Z({2,0},{0,2}).mult(0.5, false, VABEF({2,0},{2,0}), "ABCD", false, T({2,0},{0,2}), "CDEF", 1.0, "ABEF");
+
+    unique_ptr<SpinorbitalTensor<double>> I1(new SpinorbitalTensor<double>("I1", Z.arena, Z.getGroup(), spaces, {0,1}, {0,1}));
+    // I1["mi"] = VMNEF["mnef"]*T["efin"]
+    (*I1)({0,0},{0,0}).mult(2.0, false, VMNEF({0,1},{1,0}), "ABCD", false, T({1,0},{0,1}), "CDAE", 0.0, "BE");
+    (*I1)({0,0},{0,0}).mult(-1.0, false, VMNEF({0,0},{0,0}), "ABCD", false, T({0,0},{0,0}), "CDBE", 1.0, "AE");
+    (*I1)({0,1},{0,1}).mult(-1.0, false, VMNEF({0,2},{2,0}), "ABCD", false, T({2,0},{0,2}), "CDBE", 0.0, "AE");
+    (*I1)({0,1},{0,1}).mult(2.0, false, VMNEF({0,1},{1,0}), "ABCD", false, T({1,0},{0,1}), "CDEB", 1.0, "AE");
+
+    // Z["abij"] += 0.5*I1["mi"]*T["abjm"]
+    Z({0,0},{0,0}).mult(-0.5, false, (*I1)({0,0},{0,0}), "AB", false, T({0,0},{0,0}), "CDAE", 1.0, "CDBE");
+    Z({1,0},{0,1}).mult(-0.5, false, (*I1)({0,1},{0,1}), "AB", false, T({1,0},{0,1}), "CDAE", 1.0, "CDBE");
+    Z({1,0},{0,1}).mult(-0.5, false, (*I1)({0,0},{0,0}), "AB", false, T({1,0},{0,1}), "CDEA", 1.0, "CDEB");
+    Z({2,0},{0,2}).mult(-0.5, false, (*I1)({0,1},{0,1}), "AB", false, T({2,0},{0,2}), "CDAE", 1.0, "CDBE");
+    I1.reset();
+
+    unique_ptr<SpinorbitalTensor<double>> I2(new SpinorbitalTensor<double>("I2", Z.arena, Z.getGroup(), spaces, {0,2}, {0,2}));
+    // I2["mnij"] = VMNEF["mnef"]*T["efij"]
+    (*I2)({0,0},{0,0}).mult(1.0, false, VMNEF({0,0},{0,0}), "ABCD", false, T({0,0},{0,0}), "CDEF", 0.0, "ABEF");
+    (*I2)({0,1},{0,1}).mult(2.0, false, VMNEF({0,1},{1,0}), "ABCD", false, T({1,0},{0,1}), "CDEF", 0.0, "ABEF");
+    (*I2)({0,2},{0,2}).mult(1.0, false, VMNEF({0,2},{2,0}), "ABCD", false, T({2,0},{0,2}), "CDEF", 0.0, "ABEF");
+
+    // Z["abij"] += 0.25*I2["mnij"]*T["abmn"]
+    Z({0,0},{0,0}).mult(0.25, false, (*I2)({0,0},{0,0}), "ABCD", false, T({0,0},{0,0}), "EFAB", 1.0, "EFCD");
+    Z({1,0},{0,1}).mult(0.5, false, (*I2)({0,1},{0,1}), "ABCD", false, T({1,0},{0,1}), "EFAB", 1.0, "EFCD");
+    Z({2,0},{0,2}).mult(0.25, false, (*I2)({0,2},{0,2}), "ABCD", false, T({2,0},{0,2}), "EFAB", 1.0, "EFCD");
+    I2.reset();
+
+    unique_ptr<SpinorbitalTensor<double>> I3(new SpinorbitalTensor<double>("I3", Z.arena, Z.getGroup(), spaces, {1,1}, {1,1}));
+    // I3["bnfj"] = VMNEF["mnef"]*T["bejm"]
+    (*I3)({0,0},{0,0}).mult(1.0, false, VMNEF({0,1},{1,0}), "ABCD", false, T({1,0},{0,1}), "CEAF", 0.0, "EBDF");
+    (*I3)({0,0},{0,0}).mult(1.0, false, VMNEF({0,0},{0,0}), "ABCD", false, T({0,0},{0,0}), "CEAF", 1.0, "EBDF");
+    (*I3)({1,0},{1,0}).mult(1.0, false, VMNEF({0,1},{1,0}), "ABCD", false, T({1,0},{0,1}), "EDAF", 0.0, "EBCF");
+    (*I3)({1,0},{0,1}).mult(1.0, false, VMNEF({0,1},{1,0}), "ABCD", false, T({2,0},{0,2}), "CEAF", 0.0, "EBDF");
+    (*I3)({1,0},{0,1}).mult(1.0, false, VMNEF({0,0},{0,0}), "ABCD", false, T({1,0},{0,1}), "ECFA", 1.0, "EBDF");
+    (*I3)({0,1},{1,0}).mult(1.0, false, VMNEF({0,2},{2,0}), "ABCD", false, T({1,0},{0,1}), "CEAF", 0.0, "EBDF");
+    (*I3)({0,1},{1,0}).mult(1.0, false, VMNEF({0,1},{1,0}), "ABCD", false, T({0,0},{0,0}), "DEBF", 1.0, "EACF");
+    (*I3)({0,1},{0,1}).mult(1.0, false, VMNEF({0,1},{1,0}), "ABCD", false, T({1,0},{0,1}), "CEFB", 0.0, "EADF");
+    (*I3)({1,1},{1,1}).mult(1.0, false, VMNEF({0,2},{2,0}), "ABCD", false, T({2,0},{0,2}), "CEAF", 0.0, "EBDF");
+    (*I3)({1,1},{1,1}).mult(1.0, false, VMNEF({0,1},{1,0}), "ABCD", false, T({1,0},{0,1}), "EDFB", 1.0, "EACF");
+
+    // Z["abij"] += 0.5*I3["bnfj"]*T["afin"]
+    Z({0,0},{0,0}).mult(0.5, false, (*I3)({0,0},{0,0}), "ABCD", false, T({0,0},{0,0}), "CEBF", 1.0, "AEDF");
+    Z({0,0},{0,0}).mult(0.5, false, (*I3)({0,1},{1,0}), "ABCD", false, T({1,0},{0,1}), "CEBF", 1.0, "AEDF");
+    Z({1,0},{0,1}).mult(0.5, false, (*I3)({1,1},{1,1}), "ABCD", false, T({1,0},{0,1}), "CEBF", 1.0, "AEDF");
+    Z({1,0},{0,1}).mult(0.5, false, (*I3)({1,0},{1,0}), "ABCD", false, T({1,0},{0,1}), "CEFB", 1.0, "AEFD");
+    Z({1,0},{0,1}).mult(0.5, false, (*I3)({1,0},{0,1}), "ABCD", false, T({0,0},{0,0}), "CEBF", 1.0, "AEDF");
+    Z({1,0},{0,1}).mult(0.5, false, (*I3)({0,1},{0,1}), "ABCD", false, T({1,0},{0,1}), "ECBF", 1.0, "EADF");
+    Z({1,0},{0,1}).mult(0.5, false, (*I3)({0,0},{0,0}), "ABCD", false, T({1,0},{0,1}), "ECFB", 1.0, "EAFD");
+    Z({1,0},{0,1}).mult(0.5, false, (*I3)({0,1},{1,0}), "ABCD", false, T({2,0},{0,2}), "CEBF", 1.0, "EAFD");
+    Z({2,0},{0,2}).mult(0.5, false, (*I3)({1,1},{1,1}), "ABCD", false, T({2,0},{0,2}), "CEBF", 1.0, "AEDF");
+    Z({2,0},{0,2}).mult(0.5, false, (*I3)({1,0},{0,1}), "ABCD", false, T({1,0},{0,1}), "ECFB", 1.0, "AEDF");
+    I3.reset();
+
+    unique_ptr<SpinorbitalTensor<double>> I4(new SpinorbitalTensor<double>("I4", Z.arena, Z.getGroup(), spaces, {1,0}, {1,0}));
+    // I4["ae"] = VMNEF["mnef"]*T["afmn"]
+    (*I4)({0,0},{0,0}).mult(2.0, false, VMNEF({0,1},{1,0}), "ABCD", false, T({1,0},{0,1}), "CEAB", 0.0, "ED");
+    (*I4)({0,0},{0,0}).mult(-1.0, false, VMNEF({0,0},{0,0}), "ABCD", false, T({0,0},{0,0}), "DEAB", 1.0, "EC");
+    (*I4)({1,0},{1,0}).mult(-1.0, false, VMNEF({0,2},{2,0}), "ABCD", false, T({2,0},{0,2}), "DEAB", 0.0, "EC");
+    (*I4)({1,0},{1,0}).mult(2.0, false, VMNEF({0,1},{1,0}), "ABCD", false, T({1,0},{0,1}), "EDAB", 1.0, "EC");
+
+    // Z["abij"] += 0.5*I4["ae"]*T["beij"]
+    Z({0,0},{0,0}).mult(-0.5, false, (*I4)({0,0},{0,0}), "AB", false, T({0,0},{0,0}), "BCDE", 1.0, "ACDE");
+    Z({1,0},{0,1}).mult(-0.5, false, (*I4)({1,0},{1,0}), "AB", false, T({1,0},{0,1}), "BCDE", 1.0, "ACDE");
+    Z({1,0},{0,1}).mult(-0.5, false, (*I4)({0,0},{0,0}), "AB", false, T({1,0},{0,1}), "CBDE", 1.0, "CADE");
+    Z({2,0},{0,2}).mult(-0.5, false, (*I4)({1,0},{1,0}), "AB", false, T({2,0},{0,2}), "BCDE", 1.0, "ACDE");
+    I4.reset();
+}
+
+}
+}
+}
+
+#endif
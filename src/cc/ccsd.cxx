@@ -13,7 +13,8 @@ namespace cc
 
 template <typename U>
 CCSD<U>::CCSD(const string& name, Config& config)
-: Iterative<U>(name, config), diis(config.get("diis"))
+: Iterative<U>(name, config), diis(config.get("diis")),
+  checkpoint(config.get<string>("checkpoint")), layout_copies(config.get<int>("layout_copies"))
 {
     vector<Requirement> reqs;
     reqs.push_back(Requirement("moints", "H"));
@@ -61,14 +62,29 @@ bool CCSD<U>::run(TaskDAG& dag, const Arena& arena)
     Logger::log(arena) << "MP2 energy = " << setprecision(15) << mp2 << endl;
     this->put("mp2", new U(mp2));
 
+    if (checkpoint != "none" && T.load(checkpoint))
+    {
+        Logger::log(arena) << "Amplitudes read from " << checkpoint << endl;
+    }
+
+    /*
+     * H is only read from here on, so it may keep copies laid out for
+     * each of the contractions it takes part in
+     */
+    H.keepLayouts(layout_copies);
+
     CTF_Timer_epoch ep(this->name.c_str());
     ep.begin();
     Iterative<U>::run(dag, arena);
     ep.end();
 
+    H.keepLayouts(0);
+
     this->put("energy", new U(this->energy()));
     this->put("convergence", new U(this->conv()));
 
+    if (checkpoint != "none") T.save(checkpoint);
+
     /*
     if (isUsed("S2") || isUsed("multiplicity"))
     {
@@ -82,7 +98,14 @@ bool CCSD<U>::run(TaskDAG& dag, const Arena& arena)
 
     if (this->isUsed("Hbar"))
     {
-        this->put("Hbar", new STTwoElectronOperator<U>("Hbar", H, T, true));
+        Product& Hbar = this->getProduct("Hbar");
+
+        this->put("Hbar", new STTwoElectronOperator<U>("Hbar", H, T, true, Hbar.getUsage()));
+
+        /*
+         * An unformed (ab,ef) block refers to the one in H
+         */
+        if (!(Hbar.getUsage()&TwoElectronOperator<U>::ABCD)) Hbar.keepRequirements();
     }
 
     return true;
@@ -272,6 +295,10 @@ max_iterations?
     int 50,
 conv_type?
     enum { MAXE, RMSE, MAE },
+checkpoint?
+    string none,
+layout_copies?
+    int 0,
 diis?
 {
     damping?
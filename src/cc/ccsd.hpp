@@ -22,6 +22,8 @@ class CCSD : public Iterative<U>
 {
     protected:
         convergence::DIIS<op::ExcitationOperator<U,2>> diis;
+        string checkpoint;
+        int layout_copies;
 
     public:
         CCSD(const string& name, input::Config& config);
@@ -13,7 +13,8 @@ namespace cc
 
 template <typename U>
 CCSDT<U>::CCSDT(const string& name, Config& config)
-: Iterative<U>(name, config), diis(config.get("diis")), guess(config.get<string>("guess"))
+: Iterative<U>(name, config), diis(config.get("diis")), guess(config.get<string>("guess")),
+  checkpoint(config.get<string>("checkpoint"))
 {
     vector<Requirement> reqs;
     reqs.emplace_back("moints", "H");
@@ -73,6 +74,11 @@ bool CCSDT<U>::run(task::TaskDAG& dag, const Arena& arena)
         T(2) = Tccsd(2);
     }
 
+    if (checkpoint != "none" && T.load(checkpoint))
+    {
+        Logger::log(arena) << "Amplitudes read from " << checkpoint << endl;
+    }
+
     CTF_Timer_epoch ep(this->name.c_str());
     ep.begin();
     Iterative<U>::run(dag, arena);
@@ -81,6 +87,8 @@ bool CCSDT<U>::run(task::TaskDAG& dag, const Arena& arena)
     this->put("energy", new U(this->energy()));
     this->put("convergence", new U(this->conv()));
 
+    if (checkpoint != "none") T.save(checkpoint);
+
     /*
     if (isUsed("S2") || isUsed("multiplicity"))
     {
@@ -282,6 +290,8 @@ max_iterations?
     int 50,
 conv_type?
     enum { MAXE, RMSE, MAE },
+checkpoint?
+    string none,
 guess?
     enum { mp2, ccsd },
 diis?
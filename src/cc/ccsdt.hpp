@@ -23,6 +23,7 @@ class CCSDT : public Iterative<U>
     protected:
         convergence::DIIS<op::ExcitationOperator<U,3>> diis;
         string guess;
+        string checkpoint;
 
     public:
         CCSDT(const string& name, input::Config& config);
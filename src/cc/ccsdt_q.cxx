@@ -1,5 +1,7 @@
 #include "ccsdt_q.hpp"
 
+#include <unistd.h>
+
 using namespace aquarius::op;
 using namespace aquarius::input;
 using namespace aquarius::tensor;
@@ -14,7 +16,8 @@ namespace cc
 
 template <typename U>
 CCSDT_Q<U>::CCSDT_Q(const string& name, Config& config)
-: Task(name, config)
+: Task(name, config), batch_size(config.get<int>("batch_size")),
+  memory(config.get<double>("memory"))
 {
     vector<Requirement> reqs;
     reqs.push_back(Requirement("moints", "H"));
@@ -35,38 +38,157 @@ bool CCSDT_Q<U>::run(task::TaskDAG& dag, const Arena& arena)
     const ExcitationOperator<U,3>& T = this->template get<ExcitationOperator<U,3>>("T");
 
     const SpinorbitalTensor<U>& VABIJ = H.getABIJ();
-    const SpinorbitalTensor<U>& VAMEF = H.getAIBC();
     const SpinorbitalTensor<U>& VABEJ = H.getABCI();
     const SpinorbitalTensor<U>& VABEF = H.getABCD();
     const SpinorbitalTensor<U>& VMNIJ = H.getIJKL();
-    const SpinorbitalTensor<U>& VMNEJ = H.getIJAK();
     const SpinorbitalTensor<U>& VAMIJ = H.getAIJK();
     const SpinorbitalTensor<U>& VAMEI = H.getAIBJ();
 
+    int nirrep = group.getNumIrreps();
+
+    /*
+     * T4 is never formed in full: instead, the last occupied index l is
+     * restricted to a batch of orbitals in one irrep, which is described by
+     * an additional occupied space. All tensors are carried over to the
+     * space list {vrt,occ,batch}, and tensors which carry the index l are
+     * projected onto the batch space. Since T4 is antisymmetric only among
+     * ijk in this representation, the permutations which exchange l with
+     * one of ijk are written out explicitly. Summing Z4*T4 over all
+     * batches then gives the full unrestricted sum.
+     */
+    int nv = aquarius::sum(vrt.nalpha)+aquarius::sum(vrt.nbeta);
+    int no = aquarius::sum(occ.nalpha)+aquarius::sum(occ.nbeta);
+
+    int batch = batch_size;
+    if (batch <= 0)
+    {
+        double avail = memory*1024*1024;
+        if (avail <= 0) avail = 0.5*sysconf(_SC_PHYS_PAGES)*sysconf(_SC_PAGE_SIZE);
+
+        /*
+         * Approximate size of T4 and Z4 (per process) for one occupied
+         * spin-orbital in the batch
+         */
+        double per_orb = 2.0*sizeof(U)*pow(nv,4)/24*pow(no,3)/6/nirrep/arena.size;
+        batch = max(1, (int)min(avail/(2*per_orb), (double)no));
+    }
+
+    this->log(arena) << "batch size: " << batch << endl;
+
+    /*
+     * The intermediates without the index l do not depend on the batch, so
+     * they are formed once, and their batched (_l) variants are projections
+     */
     SpinorbitalTensor<U> WABCEJK("W(abc,ejk)", arena, group, {vrt,occ}, {3,0}, {1,2});
     SpinorbitalTensor<U> WABMIJK("W(abm,ijk)", arena, group, {vrt,occ}, {2,1}, {0,3});
 
-    SpinorbitalTensor<U> T4("T4", arena, group, {vrt,occ}, {4,0}, {0,4});
-    SpinorbitalTensor<U> Z4("L4", arena, group, {vrt,occ}, {4,0}, {0,4});
-
     WABCEJK[  "abcejk"]  = 0.5*VABEF[  "abef"]*T(2)[  "fcjk"];
 
     WABMIJK[  "abmijk"]  =     VAMEI[  "amek"]*T(2)[  "ebij"];
     WABMIJK[  "abmijk"] -= 0.5*VMNIJ[  "nmjk"]*T(2)[  "abin"];
 
-         T4["abcdijkl"]  =     VABEJ[  "abej"]*T(3)["ecdikl"];
-         T4["abcdijkl"] -=     VAMIJ[  "amij"]*T(3)["bcdmkl"];
-
-         Z4 = T4;
-
-         T4["abcdijkl"] +=   WABCEJK["abcejk"]*T(2)[  "edil"];
-         T4["abcdijkl"] -=   WABMIJK["abmijk"]*T(2)[  "cdml"];
-
-         Z4["abcdijkl"] +=     VABIJ[  "abij"]*T(2)[  "cdkl"];
-
-    T4.weight({&D.getDA(), &D.getDI()}, {&D.getDa(), &D.getDi()});
-
-    U E = (1.0/576.0)*scalar(Z4*T4);
+    U E = 0;
+
+    for (int h = 0;h < nirrep;h++)
+    {
+        int nI = occ.nalpha[h];
+        int ni = occ.nbeta[h];
+
+        for (int l0 = 0;l0 < max(nI,ni);l0 += batch)
+        {
+            vector<int> nL(nirrep, 0), nl(nirrep, 0);
+            nL[h] = max(0, min(batch, nI-l0));
+            nl[h] = max(0, min(batch, ni-l0));
+
+            Space blk(group, nL, nl);
+            vector<Space> spaces = {vrt, occ, blk};
+
+            vector<vector<U>> dL(nirrep), dl(nirrep);
+            if (nL[h] > 0) dL[h].assign(D.getDI()[h].begin()+l0, D.getDI()[h].begin()+l0+nL[h]);
+            if (nl[h] > 0) dl[h].assign(D.getDi()[h].begin()+l0, D.getDi()[h].begin()+l0+nl[h]);
+
+            /*
+             * P(ml) = delta(m,l0+l) maps occupied indices onto the batch
+             */
+            SpinorbitalTensor<U> P("P", arena, group, spaces, {0,1,0}, {0,0,1});
+
+            for (int spin = 0;spin < 2;spin++)
+            {
+                int n = (spin == 0 ? nL[h] : nl[h]);
+                int nocc = (spin == 0 ? nI : ni);
+                vector<int> alpha_out = {0,1-spin,0};
+                vector<int> alpha_in = {0,0,1-spin};
+
+                if (n == 0) continue;
+
+                if (arena.rank == 0)
+                {
+                    vector<tkv_pair<U>> pairs(n);
+                    for (int l = 0;l < n;l++)
+                    {
+                        pairs[l].k = (l0+l)+l*nocc;
+                        pairs[l].d = 1;
+                    }
+                    P(alpha_out, alpha_in).writeRemoteData({h,h}, pairs);
+                }
+                else
+                {
+                    P(alpha_out, alpha_in).writeRemoteData({h,h});
+                }
+            }
+
+            /*
+             * These only reference the data of the original tensors
+             */
+            SpinorbitalTensor<U> VABEJ3("VABEJ", VABEJ, spaces, true);
+            SpinorbitalTensor<U> VAMIJ3("VAMIJ", VAMIJ, spaces, true);
+            SpinorbitalTensor<U> VABIJ3("VABIJ", VABIJ, spaces, true);
+            SpinorbitalTensor<U> T2("T2", T(2), spaces, true);
+            SpinorbitalTensor<U> T3("T3", T(3), spaces, true);
+            SpinorbitalTensor<U> WABCEJK3("W(abc,ejk)", WABCEJK, spaces, true);
+            SpinorbitalTensor<U> WABMIJK3("W(abm,ijk)", WABMIJK, spaces, true);
+
+            SpinorbitalTensor<U> VABEJs("VABEJ_l", arena, group, spaces, {2,0,0}, {1,0,1});
+            SpinorbitalTensor<U> VAMIJs("VAMIJ_l", arena, group, spaces, {1,1,0}, {0,1,1});
+            SpinorbitalTensor<U> VABIJs("VABIJ_l", arena, group, spaces, {2,0,0}, {0,1,1});
+            SpinorbitalTensor<U> T2s("T2_l", arena, group, spaces, {2,0,0}, {0,1,1});
+            SpinorbitalTensor<U> T3s("T3_l", arena, group, spaces, {3,0,0}, {0,2,1});
+
+            VABEJs["abel"] = VABEJ3["abem"]*P["ml"];
+            VAMIJs["amil"] = VAMIJ3["amin"]*P["nl"];
+            VABIJs["abil"] = VABIJ3["abim"]*P["ml"];
+               T2s["abil"] =    T2["abim"]*P["ml"];
+               T3s["abcijl"] =  T3["abcijm"]*P["ml"];
+
+            SpinorbitalTensor<U> WABCEJKs("W(abc,ejk)_l", arena, group, spaces, {3,0,0}, {1,1,1});
+            SpinorbitalTensor<U> WABMIJKs("W(abm,ijk)_l", arena, group, spaces, {2,1,0}, {0,2,1});
+
+            SpinorbitalTensor<U> T4("T4", arena, group, spaces, {4,0,0}, {0,3,1});
+            SpinorbitalTensor<U> Z4("L4", arena, group, spaces, {4,0,0}, {0,3,1});
+
+            WABCEJKs["abcejl"] = WABCEJK3["abcejm"]*P["ml"];
+            WABMIJKs["abmijl"] = WABMIJK3["abmijn"]*P["nl"];
+
+                  T4["abcdijkl"]  =      VABEJ3[  "abej"]*  T3s["ecdikl"];
+                  T4["abcdijkl"] -=      VABEJs[  "abel"]*   T3["ecdikj"];
+                  T4["abcdijkl"] -=      VAMIJ3[  "amij"]*  T3s["bcdmkl"];
+                  T4["abcdijkl"] +=      VAMIJs[  "amil"]*   T3["bcdmkj"];
+
+                  Z4 = T4;
+
+                  T4["abcdijkl"] +=    WABCEJK3["abcejk"]*  T2s[  "edil"];
+                  T4["abcdijkl"] -=    WABCEJKs["abcejl"]*   T2[  "edik"];
+                  T4["abcdijkl"] -=    WABMIJK3["abmijk"]*  T2s[  "cdml"];
+                  T4["abcdijkl"] +=    WABMIJKs["abmijl"]*   T2[  "cdmk"];
+
+                  Z4["abcdijkl"] +=      VABIJ3[  "abij"]*  T2s[  "cdkl"];
+                  Z4["abcdijkl"] -=      VABIJs[  "abil"]*   T2[  "cdkj"];
+
+            T4.weight({&D.getDA(), &D.getDI(), &dL}, {&D.getDa(), &D.getDi(), &dl});
+
+            E += (1.0/576.0)*scalar(Z4*T4);
+        }
+    }
 
     this->log(arena) << printos("energy: %18.15f\n", E) << endl;
 
@@ -79,4 +201,13 @@ bool CCSDT_Q<U>::run(task::TaskDAG& dag, const Arena& arena)
 }
 
 INSTANTIATE_SPECIALIZATIONS(aquarius::cc::CCSDT_Q);
-REGISTER_TASK(aquarius::cc::CCSDT_Q<double>,"ccsdt(q)");
+static const char* spec = R"!(
+
+batch_size?
+    int 0,
+memory?
+    double 0
+
+)!";
+
+REGISTER_TASK(aquarius::cc::CCSDT_Q<double>,"ccsdt(q)",spec);
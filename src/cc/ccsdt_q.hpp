@@ -17,6 +17,10 @@ namespace cc
 template <typename U>
 class CCSDT_Q : public task::Task
 {
+    protected:
+        int batch_size;
+        double memory;
+
     public:
         CCSDT_Q(const string& name, input::Config& config);
 
@@ -23,7 +23,8 @@ EOMEECCSD<U>::EOMEECCSD(const string& name, Config& config)
 {
     vector<Requirement> reqs;
     reqs.emplace_back("ccsd.T", "T");
-    reqs.emplace_back("ccsd.Hbar", "Hbar");
+    reqs.emplace_back("ccsd.Hbar", "Hbar", TwoElectronOperator<U>::ALL &
+                                          ~TwoElectronOperator<U>::ABCD);
     reqs.emplace_back("tda.TDAevals", "TDAevals");
     reqs.emplace_back("tda.TDAevecs", "TDAevecs");
     this->addProduct("eomeeccsd.energy", "energy", reqs);
@@ -316,7 +317,6 @@ void EOMEECCSD<U>::iterate(const Arena& arena)
     const SpinorbitalTensor<U>& WMNEF = H.getIJAB();
     const SpinorbitalTensor<U>& WAMEF = H.getAIBC();
     const SpinorbitalTensor<U>& WABEJ = H.getABCI();
-    const SpinorbitalTensor<U>& WABEF = H.getABCD();
     const SpinorbitalTensor<U>& WMNIJ = H.getIJKL();
     const SpinorbitalTensor<U>& WMNEJ = H.getIJAK();
     const SpinorbitalTensor<U>& WAMIJ = H.getAIJK();
@@ -367,7 +367,7 @@ void EOMEECCSD<U>::iterate(const Arena& arena)
         Z(2)["abij"] +=       XAE[  "ae"]*T(2)["ebij"];
         Z(2)["abij"] -=       XMI[  "mi"]*T(2)["abmj"];
         Z(2)["abij"] += 0.5*WMNIJ["mnij"]*R(2)["abmn"];
-        Z(2)["abij"] += 0.5*WABEF["abef"]*R(2)["efij"];
+        H.rightContractABCD(0.5, Z(2), R(2));
         Z(2)["abij"] -=     WAMEI["amei"]*R(2)["ebmj"];
     }
 
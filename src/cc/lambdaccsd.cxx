@@ -16,7 +16,8 @@ LambdaCCSD<U>::LambdaCCSD(const string& name, Config& config)
 : Iterative<U>(name, config), diis(config.get("diis"))
 {
     vector<Requirement> reqs;
-    reqs.push_back(Requirement("ccsd.Hbar", "Hbar"));
+    reqs.push_back(Requirement("ccsd.Hbar", "Hbar", TwoElectronOperator<U>::ALL &
+                                                  ~TwoElectronOperator<U>::ABCD));
     reqs.push_back(Requirement("ccsd.T", "T"));
     this->addProduct(Product("double", "energy", reqs));
     this->addProduct(Product("double", "convergence", reqs));
@@ -66,7 +67,6 @@ void LambdaCCSD<U>::iterate(const Arena& arena)
     const SpinorbitalTensor<U>& WMNEF = H.getIJAB();
     const SpinorbitalTensor<U>& WAMEF = H.getAIBC();
     const SpinorbitalTensor<U>& WABEJ = H.getABCI();
-    const SpinorbitalTensor<U>& WABEF = H.getABCD();
     const SpinorbitalTensor<U>& WMNIJ = H.getIJKL();
     const SpinorbitalTensor<U>& WMNEJ = H.getIJAK();
     const SpinorbitalTensor<U>& WAMIJ = H.getAIJK();
@@ -108,7 +108,7 @@ void LambdaCCSD<U>::iterate(const Arena& arena)
     Z(2)["ijab"] -=     WMNEJ["ijam"]*L(1)[  "mb"];
     Z(2)["ijab"] +=       FAE[  "ea"]*L(2)["ijeb"];
     Z(2)["ijab"] -=       FMI[  "im"]*L(2)["mjab"];
-    Z(2)["ijab"] += 0.5*WABEF["efab"]*L(2)["ijef"];
+    H.leftContractABCD(0.5, L(2), Z(2));
     Z(2)["ijab"] += 0.5*WMNIJ["ijmn"]*L(2)["mnab"];
     Z(2)["ijab"] +=     WAMEI["eiam"]*L(2)["mjbe"];
     Z(2)["ijab"] -=     WMNEF["mjab"]* GIM[  "im"];
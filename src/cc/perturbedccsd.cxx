@@ -4,6 +4,7 @@ using namespace aquarius::op;
 using namespace aquarius::input;
 using namespace aquarius::tensor;
 using namespace aquarius::task;
+using namespace aquarius::convergence;
 
 namespace aquarius
 {
@@ -12,21 +13,34 @@ namespace cc
 
 template <typename U>
 PerturbedCCSD<U>::PerturbedCCSD(const string& name, Config& config)
-: Iterative<U>(name, config), diis(config.get("diis"))
+: Iterative<U>(name, config), diis_config(config.get("diis")), ifreq(0)
 {
+    double omega_min = config.get<double>("omega");
+    double omega_max = config.get<double>("omega_max");
+    int nomega = config.get<int>("nomega");
+
+    assert(nomega > 0);
+
+    for (int i = 0;i < nomega;i++)
+    {
+        omega.push_back(nomega == 1 ? omega_min :
+                        omega_min + i*(omega_max-omega_min)/(nomega-1));
+    }
+
     vector<Requirement> reqs;
     reqs.push_back(Requirement("ccsd.T", "T"));
-    reqs.push_back(Requirement("ccsd.Hbar", "Hbar"));
+    reqs.push_back(Requirement("ccsd.Hbar", "Hbar", TwoElectronOperator<U>::ALL &
+                                                  ~TwoElectronOperator<U>::ABCD));
     reqs.push_back(Requirement("1epert", "A"));
-    reqs.push_back(Requirement("double", "omega"));
     this->addProduct(Product("double", "convergence", reqs));
+    this->addProduct(Product("ccsd.omega", "omega", reqs));
     this->addProduct(Product("ccsd.TA", "TA", reqs));
 }
 
 template <typename U>
 bool PerturbedCCSD<U>::run(TaskDAG& dag, const Arena& arena)
 {
-    const auto& A = this->template get<OneElectronOperator  <U>>("A");
+    const auto& A = this->template get<unique_vector<OneElectronOperator<U>>>("A");
     const auto& H = this->template get<STTwoElectronOperator<U>>("Hbar");
 
     const Space& occ = H.occ;
@@ -34,15 +48,78 @@ bool PerturbedCCSD<U>::run(TaskDAG& dag, const Arena& arena)
 
     auto& T = this->template get<ExcitationOperator<U,2>>("T");
 
-    auto& TA = this->put   ("TA", new ExcitationOperator  <U,2>("T^A", arena, occ, vrt));
-    //auto& X  = this->puttmp( "X", new STExcitationOperator<U,2>("X", A, T));
-    auto& Z  = this->puttmp( "Z", new ExcitationOperator  <U,2>("Z", arena, occ, vrt));
-    auto& D  = this->puttmp( "D", new Denominator         <U  >(H));
-
-    omega = this->template get<U>("omega");
-
-    //X(0) = 0;
-    TA.weight(D, omega);
+    int npert = A.size();
+    assert(npert > 0);
+
+    auto& TAs = this->put   ( "TA", new vector<unique_vector<ExcitationOperator<U,2>>>(omega.size()));
+    auto& Xs  = this->puttmp(  "X", new unique_vector<ExcitationOperator<U,2>>());
+    auto& Zs  = this->puttmp(  "Z", new unique_vector<ExcitationOperator<U,2>>());
+    auto& D   = this->puttmp(  "D", new Denominator<U>(H));
+    this->puttmp("XMI", new SpinorbitalTensor<U>("X(mi)", H.getIJ()));
+    this->puttmp("XAE", new SpinorbitalTensor<U>("X(ae)", H.getAB()));
+
+    /*
+     * The right-hand sides do not depend on the frequency, so form them
+     * once for each perturbation
+     */
+    for (int i = 0;i < npert;i++)
+    {
+        STTwoElectronOperator<U> XA("X", A[i], T);
+
+        Xs.emplace_back("X", arena, occ, vrt);
+        Zs.emplace_back("Z", arena, occ, vrt);
+
+        Xs[i](0) = 0;
+        Xs[i](1)[  "ai"] = XA.getAI()[  "ai"];
+        Xs[i](2)["abij"] = XA.getABIJ()["abij"];
+    }
+
+    double conv = 0;
+
+    for (ifreq = 0;ifreq < omega.size();ifreq++)
+    {
+        auto& TA = TAs[ifreq];
+
+        this->log(arena) << "Solving for omega = " << fixed << setprecision(6) << omega[ifreq] << endl;
+
+        /*
+         * Start from first-order amplitudes at the first frequency, from the
+         * previous solutions at the second, and extrapolate linearly along
+         * the (evenly spaced) grid after that
+         */
+        for (int i = 0;i < npert;i++)
+        {
+            TA.emplace_back("T^A", arena, occ, vrt);
+
+            if (ifreq == 0)
+            {
+                TA[i] = Xs[i];
+                TA[i].weight(D, omega[ifreq]);
+            }
+            else if (ifreq == 1)
+            {
+                TA[i] = TAs[ifreq-1][i];
+            }
+            else
+            {
+                TA[i](0) = 0;
+                TA[i](1)[  "ai"]  = 2*TAs[ifreq-1][i](1)[  "ai"];
+                TA[i](1)[  "ai"] -=   TAs[ifreq-2][i](1)[  "ai"];
+                TA[i](2)["abij"]  = 2*TAs[ifreq-1][i](2)["abij"];
+                TA[i](2)["abij"] -=   TAs[ifreq-2][i](2)["abij"];
+            }
+        }
+
+        diis.clear();
+        for (int i = 0;i < npert;i++) diis.emplace_back(diis_config);
+
+        Iterative<U>::run(dag, arena, npert);
+
+        for (int i = 0;i < npert;i++) conv = max(conv, this->conv(i));
+    }
+
+    this->put("omega", new vector<double>(omega));
+    this->put("convergence", new U(conv));
 
     return true;
 }
@@ -52,24 +129,110 @@ void PerturbedCCSD<U>::iterate(const Arena& arena)
 {
     const auto& H = this->template get<STTwoElectronOperator<U>>("Hbar");
 
-    auto& TA = this->template get   <ExcitationOperator<U,2>>("TA");
-    auto& D  = this->template gettmp<Denominator       <U  >>( "D");
-    auto& X  = this->template gettmp<ExcitationOperator<U,2>>( "X");
-    auto& Z  = this->template gettmp<ExcitationOperator<U,2>>( "Z");
-
-    Z = X;
-    //TODO: H.contract(TA, Z);
+    const SpinorbitalTensor<U>&   FME =   H.getIA();
+    const SpinorbitalTensor<U>&   FAE =   H.getAB();
+    const SpinorbitalTensor<U>&   FMI =   H.getIJ();
+    const SpinorbitalTensor<U>& WMNEF = H.getIJAB();
+    const SpinorbitalTensor<U>& WAMEF = H.getAIBC();
+    const SpinorbitalTensor<U>& WABEJ = H.getABCI();
+    const SpinorbitalTensor<U>& WMNIJ = H.getIJKL();
+    const SpinorbitalTensor<U>& WMNEJ = H.getIJAK();
+    const SpinorbitalTensor<U>& WAMIJ = H.getAIJK();
+    const SpinorbitalTensor<U>& WAMEI = H.getAIBJ();
 
-    Z.weight(D, omega);
-    TA += Z;
-
-    this->conv() = Z.norm(00);
+    auto& T = this->template get<ExcitationOperator<U,2>>("T");
 
-    diis.extrapolate(TA, Z);
+    auto& TAs = this->template get   <vector<unique_vector<ExcitationOperator<U,2>>>>("TA");
+    auto& Xs  = this->template gettmp<unique_vector<ExcitationOperator<U,2>>>( "X");
+    auto& Zs  = this->template gettmp<unique_vector<ExcitationOperator<U,2>>>( "Z");
+    auto& D   = this->template gettmp<Denominator<U>>("D");
+
+    auto& XMI = this->template gettmp<SpinorbitalTensor<U>>("XMI");
+    auto& XAE = this->template gettmp<SpinorbitalTensor<U>>("XAE");
+
+    double w = omega[ifreq];
+
+    for (int i = 0;i < this->nsolution();i++)
+    {
+        /*
+         * Perturbations which have already converged at this frequency
+         * are left alone
+         */
+        if (this->isConverged(i)) continue;
+
+        ExcitationOperator<U,2>& TA = TAs[ifreq][i];
+        ExcitationOperator<U,2>& Z = Zs[i];
+
+        XMI[  "mi"]  =     WMNEJ["nmei"]*TA(1)[  "en"];
+        XMI[  "mi"] += 0.5*WMNEF["mnef"]*TA(2)["efin"];
+        XAE[  "ae"]  =     WAMEF["amef"]*TA(1)[  "fm"];
+        XAE[  "ae"] -= 0.5*WMNEF["mnef"]*TA(2)["afmn"];
+
+        Z = Xs[i];
+
+        Z(1)[  "ai"] +=       FAE[  "ae"]*TA(1)[  "ei"];
+        Z(1)[  "ai"] -=       FMI[  "mi"]*TA(1)[  "am"];
+        Z(1)[  "ai"] -=     WAMEI["amei"]*TA(1)[  "em"];
+        Z(1)[  "ai"] +=       FME[  "me"]*TA(2)["aeim"];
+        Z(1)[  "ai"] += 0.5*WAMEF["amef"]*TA(2)["efim"];
+        Z(1)[  "ai"] -= 0.5*WMNEJ["mnei"]*TA(2)["eamn"];
+        Z(1)[  "ai"] -=             w    *TA(1)[  "ai"];
+
+        Z(2)["abij"] +=     WABEJ["abej"]*TA(1)[  "ei"];
+        Z(2)["abij"] -=     WAMIJ["amij"]*TA(1)[  "bm"];
+        Z(2)["abij"] +=       FAE[  "ae"]*TA(2)["ebij"];
+        Z(2)["abij"] -=       FMI[  "mi"]*TA(2)["abmj"];
+        Z(2)["abij"] +=       XAE[  "ae"]* T(2)["ebij"];
+        Z(2)["abij"] -=       XMI[  "mi"]* T(2)["abmj"];
+        Z(2)["abij"] += 0.5*WMNIJ["mnij"]*TA(2)["abmn"];
+        H.rightContractABCD(0.5, Z(2), TA(2));
+        Z(2)["abij"] -=     WAMEI["amei"]*TA(2)["ebmj"];
+        Z(2)["abij"] -=             w    *TA(2)["abij"];
+
+        Z.weight(D, w);
+        TA += Z;
+
+        /*
+         * -<X|T^A> is only the unrelaxed response function, but is a
+         * convenient measure of convergence
+         */
+        this->energy(i) = -Xs[i].dot(false, TA, false);
+        this->conv(i) = Z.norm(00);
+
+        diis[i].extrapolate(TA, Z);
+    }
 }
 
 }
 }
 
+static const char* spec = R"!(
+
+omega?
+    double 0.0,
+omega_max?
+    double 0.0,
+nomega?
+    int 1,
+convergence?
+    double 1e-9,
+max_iterations?
+    int 50,
+conv_type?
+    enum { MAXE, RMSE, MAE },
+diis?
+{
+    damping?
+        double 0.0,
+    start?
+        int 1,
+    order?
+        int 5,
+    jacobi?
+        bool false
+}
+
+)!";
+
 INSTANTIATE_SPECIALIZATIONS(aquarius::cc::PerturbedCCSD);
-REGISTER_TASK(aquarius::cc::PerturbedCCSD<double>, "perturbedccsd");
+REGISTER_TASK(aquarius::cc::PerturbedCCSD<double>, "perturbedccsd", spec);
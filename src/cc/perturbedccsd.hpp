@@ -6,6 +6,9 @@
 #include "operator/2eoperator.hpp"
 #include "operator/st2eoperator.hpp"
 #include "operator/excitationoperator.hpp"
+#include "operator/denominator.hpp"
+#include "convergence/diis.hpp"
+#include "util/iterative.hpp"
 
 #include "ccsd.hpp"
 
@@ -24,13 +27,21 @@ namespace cc
  *       _    -T   T       T
  * where X = e  X e  = (X e )
  *                           c
+ *
+ * for every perturbation A in the given set and every frequency w on the
+ * grid. All perturbations at one frequency are iterated together so that
+ * the Hbar blocks, denominators, and right-hand sides are shared, and the
+ * frequencies are swept in order, with the guess at each frequency
+ * extrapolated from the solutions at the previous ones.
  */
 template <typename U>
 class PerturbedCCSD : public Iterative<U>
 {
     protected:
-        U omega;
-        convergence::DIIS<op::ExcitationOperator<U,2>> diis;
+        input::Config diis_config;
+        vector<double> omega;
+        int ifreq;
+        unique_vector<convergence::DIIS<op::ExcitationOperator<U,2>>> diis;
 
     public:
         PerturbedCCSD(const string& name, input::Config& config);
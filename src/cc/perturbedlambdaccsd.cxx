@@ -4,6 +4,7 @@ using namespace aquarius::op;
 using namespace aquarius::input;
 using namespace aquarius::tensor;
 using namespace aquarius::task;
+using namespace aquarius::convergence;
 
 namespace aquarius
 {
@@ -12,13 +13,15 @@ namespace cc
 
 template <typename U>
 PerturbedLambdaCCSD<U>::PerturbedLambdaCCSD(const string& name, Config& config)
-: Iterative<U>(name, config), diis(config.get("diis"))
+: Iterative<U>(name, config), diis_config(config.get("diis")), ifreq(0)
 {
     vector<Requirement> reqs;
+    reqs.push_back(Requirement("ccsd.T", "T"));
     reqs.push_back(Requirement("ccsd.L", "L"));
     reqs.push_back(Requirement("ccsd.Hbar", "Hbar"));
     reqs.push_back(Requirement("1epert", "A"));
-    reqs.push_back(Requirement("double", "omega"));
+    reqs.push_back(Requirement("ccsd.omega", "omega"));
+    reqs.push_back(Requirement("ccsd.TA", "TA"));
     this->addProduct(Product("double", "convergence", reqs));
     this->addProduct(Product("ccsd.LA", "LA", reqs));
 }
@@ -26,40 +29,138 @@ PerturbedLambdaCCSD<U>::PerturbedLambdaCCSD(const string& name, Config& config)
 template <typename U>
 bool PerturbedLambdaCCSD<U>::run(TaskDAG& dag, const Arena& arena)
 {
-    const auto& A = this->template get<PerturbedSTTwoElectronOperator<U>>("A");
-    const auto& H = this->template get<STTwoElectronOperator         <U>>("Hbar");
+    const auto& A = this->template get<unique_vector<OneElectronOperator<U>>>("A");
+    const auto& H = this->template get<STTwoElectronOperator<U>>("Hbar");
 
     const Space& occ = H.occ;
     const Space& vrt = H.vrt;
 
-    auto& LA = this->put   ("LA", new DeexcitationOperator<U,2>("L^A", arena, occ, vrt));
-    auto& D  = this->puttmp( "D", new DeexcitationOperator<U,2>(  "D", arena, occ, vrt));
-    auto& N  = this->puttmp( "N", new DeexcitationOperator<U,2>(  "N", arena, occ, vrt));
-    auto& Z  = this->puttmp( "Z", new DeexcitationOperator<U,2>(  "Z", arena, occ, vrt));
+    const SpinorbitalTensor<U>& WMNEF = H.getIJAB();
+    const SpinorbitalTensor<U>& WAMEF = H.getAIBC();
+    const SpinorbitalTensor<U>& WMNEJ = H.getIJAK();
+
+    auto& T   = this->template get<ExcitationOperator  <U,2>>("T");
+    auto& L   = this->template get<DeexcitationOperator<U,2>>("L");
+    auto& TAs = this->template get<vector<unique_vector<ExcitationOperator<U,2>>>>("TA");
+
+    omega = this->template get<vector<double>>("omega");
+
+    int npert = A.size();
+    assert(npert > 0);
+    assert(TAs.size() == omega.size());
+
+    auto& LAs = this->put   ( "LA", new vector<unique_vector<DeexcitationOperator<U,2>>>(omega.size()));
+    auto& Ns  = this->puttmp(  "N", new unique_vector<DeexcitationOperator<U,2>>());
+    auto& Zs  = this->puttmp(  "Z", new unique_vector<DeexcitationOperator<U,2>>());
+    auto& D   = this->puttmp(  "D", new Denominator<U>(H));
+    auto& GIM = this->puttmp("GIM", new SpinorbitalTensor<U>("G(im)", H.getIJ()));
+    auto& GEA = this->puttmp("GEA", new SpinorbitalTensor<U>("G(ea)", H.getAB()));
+
+    SpinorbitalTensor<U> LIM("L(im)", H.getIJ());
+    SpinorbitalTensor<U> LEA("L(ea)", H.getAB());
+
+    LIM["mn"]  =  0.5*T(2)["efno"]*L(2)["moef"];
+    LEA["ef"]  = -0.5*T(2)["egmn"]*L(2)["mnfg"];
+
+    for (int i = 0;i < npert;i++)
+    {
+        Ns.emplace_back("N", arena, occ, vrt);
+        Zs.emplace_back("Z", arena, occ, vrt);
+    }
+
+    double conv = 0;
+
+    for (ifreq = 0;ifreq < omega.size();ifreq++)
+    {
+        auto& LA = LAs[ifreq];
+
+        this->log(arena) << "Solving for omega = " << fixed << setprecision(6) << omega[ifreq] << endl;
+
+        for (int i = 0;i < npert;i++)
+        {
+            const ExcitationOperator<U,2>& TA = TAs[ifreq][i];
+
+            PerturbedSTTwoElectronOperator<U> HA("H^A", H, A[i], T, TA);
+
+            const SpinorbitalTensor<U>&   FME =   HA.getIA();
+            const SpinorbitalTensor<U>&   FAE =   HA.getAB();
+            const SpinorbitalTensor<U>&   FMI =   HA.getIJ();
+            const SpinorbitalTensor<U>& WAMEF_A = HA.getAIBC();
+            const SpinorbitalTensor<U>& WABEJ_A = HA.getABCI();
+            const SpinorbitalTensor<U>& WMNIJ_A = HA.getIJKL();
+            const SpinorbitalTensor<U>& WMNEJ_A = HA.getIJAK();
+            const SpinorbitalTensor<U>& WAMIJ_A = HA.getAIJK();
+            const SpinorbitalTensor<U>& WAMEI_A = HA.getAIBJ();
+
+            DeexcitationOperator<U,2>& N = Ns[i];
+
+            /*
+             * N is the Lambda-CCSD residual with Hbar replaced by its
+             * derivative; the three-body part of the derivative gives both
+             * the L*T^A intermediates with the unperturbed Hbar and the
+             * L*T intermediates with the perturbed one. Since A is a
+             * one-electron operator, <mn||ef> does not contribute.
+             */
+            GIM["mn"]  =  0.5*TA(2)["efno"]*L(2)["moef"];
+            GEA["ef"]  = -0.5*TA(2)["egmn"]*L(2)["mnfg"];
 
-    U omega = this->template get<U>("omega");
+            N(0) = 0;
 
-    D(0) = (U)1.0;
-    D(1)["ia"]  = H.getIJ()["ii"];
-    D(1)["ia"] -= H.getAB()["aa"];
-    D(2)["ijab"]  = H.getIJ()["ii"];
-    D(2)["ijab"] += H.getIJ()["jj"];
-    D(2)["ijab"] -= H.getAB()["aa"];
-    D(2)["ijab"] -= H.getAB()["bb"];
+            N(1)[  "ia"]  =         FME[  "ia"];
+            N(1)[  "ia"] +=         FAE[  "ea"]*L(1)[  "ie"];
+            N(1)[  "ia"] -=         FMI[  "im"]*L(1)[  "ma"];
+            N(1)[  "ia"] -=     WAMEI_A["eiam"]*L(1)[  "me"];
+            N(1)[  "ia"] += 0.5*WABEJ_A["efam"]*L(2)["imef"];
+            N(1)[  "ia"] -= 0.5*WAMIJ_A["eimn"]*L(2)["mnea"];
+            N(1)[  "ia"] -=     WMNEJ_A["inam"]* LIM[  "mn"];
+            N(1)[  "ia"] -=     WAMEF_A["fiea"]* LEA[  "ef"];
+            N(1)[  "ia"] -=       WMNEJ["inam"]* GIM[  "mn"];
+            N(1)[  "ia"] -=       WAMEF["fiea"]* GEA[  "ef"];
 
-    D -= omega;
-    D = 1/D;
+            N(2)["ijab"]  =         FME[  "ia"]*L(1)[  "jb"];
+            N(2)["ijab"] +=     WAMEF_A["ejab"]*L(1)[  "ie"];
+            N(2)["ijab"] -=     WMNEJ_A["ijam"]*L(1)[  "mb"];
+            N(2)["ijab"] +=         FAE[  "ea"]*L(2)["ijeb"];
+            N(2)["ijab"] -=         FMI[  "im"]*L(2)["mjab"];
+            HA.leftContractABCD(0.5, L(2), N(2));
+            N(2)["ijab"] += 0.5*WMNIJ_A["ijmn"]*L(2)["mnab"];
+            N(2)["ijab"] +=     WAMEI_A["eiam"]*L(2)["mjbe"];
+            N(2)["ijab"] -=       WMNEF["mjab"]* GIM[  "im"];
+            N(2)["ijab"] +=       WMNEF["ijeb"]* GEA[  "ea"];
 
-    N(1) = (U)0.0;
-    N(2) = (U)0.0;
-    //TODO: A.contract(L, N);
-    N(0) = (U)0.0;
+            /*
+             * Guesses follow PerturbedCCSD
+             */
+            LA.emplace_back("L^A", arena, occ, vrt);
 
-    LA = N*D;
+            if (ifreq == 0)
+            {
+                LA[i] = N;
+                LA[i].weight(D, -omega[ifreq]);
+            }
+            else if (ifreq == 1)
+            {
+                LA[i] = LAs[ifreq-1][i];
+            }
+            else
+            {
+                LA[i](0) = 0;
+                LA[i](1)[  "ia"]  = 2*LAs[ifreq-1][i](1)[  "ia"];
+                LA[i](1)[  "ia"] -=   LAs[ifreq-2][i](1)[  "ia"];
+                LA[i](2)["ijab"]  = 2*LAs[ifreq-1][i](2)["ijab"];
+                LA[i](2)["ijab"] -=   LAs[ifreq-2][i](2)["ijab"];
+            }
+        }
 
-    Iterative<U>::run(dag, arena);
+        diis.clear();
+        for (int i = 0;i < npert;i++) diis.emplace_back(diis_config);
 
-    this->put("convergence", new U(this->conv()));
+        Iterative<U>::run(dag, arena, npert);
+
+        for (int i = 0;i < npert;i++) conv = max(conv, this->conv(i));
+    }
+
+    this->put("convergence", new U(conv));
 
     return true;
 }
@@ -69,24 +170,96 @@ void PerturbedLambdaCCSD<U>::iterate(const Arena& arena)
 {
     const auto& H = this->template get<STTwoElectronOperator<U>>("Hbar");
 
-    auto& LA = this->template get   <DeexcitationOperator<U,2>>("LA");
-    auto& D  = this->template gettmp<DeexcitationOperator<U,2>>( "D");
-    auto& N  = this->template gettmp<DeexcitationOperator<U,2>>( "N");
-    auto& Z  = this->template gettmp<DeexcitationOperator<U,2>>( "Z");
+    const SpinorbitalTensor<U>&   FME =   H.getIA();
+    const SpinorbitalTensor<U>&   FAE =   H.getAB();
+    const SpinorbitalTensor<U>&   FMI =   H.getIJ();
+    const SpinorbitalTensor<U>& WMNEF = H.getIJAB();
+    const SpinorbitalTensor<U>& WAMEF = H.getAIBC();
+    const SpinorbitalTensor<U>& WABEJ = H.getABCI();
+    const SpinorbitalTensor<U>& WMNIJ = H.getIJKL();
+    const SpinorbitalTensor<U>& WMNEJ = H.getIJAK();
+    const SpinorbitalTensor<U>& WAMIJ = H.getAIJK();
+    const SpinorbitalTensor<U>& WAMEI = H.getAIBJ();
+
+    auto& T = this->template get<ExcitationOperator<U,2>>("T");
+
+    auto& LAs = this->template get   <vector<unique_vector<DeexcitationOperator<U,2>>>>("LA");
+    auto& Ns  = this->template gettmp<unique_vector<DeexcitationOperator<U,2>>>( "N");
+    auto& Zs  = this->template gettmp<unique_vector<DeexcitationOperator<U,2>>>( "Z");
+    auto& D   = this->template gettmp<Denominator<U>>("D");
+
+    auto& GIM = this->template gettmp<SpinorbitalTensor<U>>("GIM");
+    auto& GEA = this->template gettmp<SpinorbitalTensor<U>>("GEA");
+
+    double w = omega[ifreq];
+
+    for (int i = 0;i < this->nsolution();i++)
+    {
+        if (this->isConverged(i)) continue;
+
+        DeexcitationOperator<U,2>& LA = LAs[ifreq][i];
+        DeexcitationOperator<U,2>& Z = Zs[i];
 
-    Z = N;
-    //TODO: H.contract(LA, Z);
+        GIM["mn"]  =  0.5*T(2)["efno"]*LA(2)["moef"];
+        GEA["ef"]  = -0.5*T(2)["egmn"]*LA(2)["mnfg"];
 
-     Z *= D;
-    LA += Z;
+        Z = Ns[i];
 
-    this->conv() = Z.norm(00);
+        Z(1)[  "ia"] +=       FAE[  "ea"]*LA(1)[  "ie"];
+        Z(1)[  "ia"] -=       FMI[  "im"]*LA(1)[  "ma"];
+        Z(1)[  "ia"] -=     WAMEI["eiam"]*LA(1)[  "me"];
+        Z(1)[  "ia"] += 0.5*WABEJ["efam"]*LA(2)["imef"];
+        Z(1)[  "ia"] -= 0.5*WAMIJ["eimn"]*LA(2)["mnea"];
+        Z(1)[  "ia"] -=     WMNEJ["inam"]*  GIM[  "mn"];
+        Z(1)[  "ia"] -=     WAMEF["fiea"]*  GEA[  "ef"];
+        Z(1)[  "ia"] +=             w    *LA(1)[  "ia"];
 
-    diis.extrapolate(LA, Z);
+        Z(2)["ijab"] +=       FME[  "ia"]*LA(1)[  "jb"];
+        Z(2)["ijab"] +=     WAMEF["ejab"]*LA(1)[  "ie"];
+        Z(2)["ijab"] -=     WMNEJ["ijam"]*LA(1)[  "mb"];
+        Z(2)["ijab"] +=       FAE[  "ea"]*LA(2)["ijeb"];
+        Z(2)["ijab"] -=       FMI[  "im"]*LA(2)["mjab"];
+        H.leftContractABCD(0.5, LA(2), Z(2));
+        Z(2)["ijab"] += 0.5*WMNIJ["ijmn"]*LA(2)["mnab"];
+        Z(2)["ijab"] +=     WAMEI["eiam"]*LA(2)["mjbe"];
+        Z(2)["ijab"] -=     WMNEF["mjab"]*  GIM[  "im"];
+        Z(2)["ijab"] +=     WMNEF["ijeb"]*  GEA[  "ea"];
+        Z(2)["ijab"] +=             w    *LA(2)["ijab"];
+
+        Z.weight(D, -w);
+        LA += Z;
+
+        this->energy(i) = -Ns[i].dot(false, LA, false);
+        this->conv(i) = Z.norm(00);
+
+        diis[i].extrapolate(LA, Z);
+    }
 }
 
 }
 }
 
+static const char* spec = R"!(
+
+convergence?
+    double 1e-9,
+max_iterations?
+    int 50,
+conv_type?
+    enum { MAXE, RMSE, MAE },
+diis?
+{
+    damping?
+        double 0.0,
+    start?
+        int 1,
+    order?
+        int 5,
+    jacobi?
+        bool false
+}
+
+)!";
+
 INSTANTIATE_SPECIALIZATIONS(aquarius::cc::PerturbedLambdaCCSD);
-REGISTER_TASK(aquarius::cc::PerturbedLambdaCCSD<double>, "perturbedlambdaccsd");
+REGISTER_TASK(aquarius::cc::PerturbedLambdaCCSD<double>, "perturbedlambdaccsd", spec);
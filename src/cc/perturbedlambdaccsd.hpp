@@ -8,6 +8,7 @@
 #include "operator/perturbedst2eoperator.hpp"
 #include "operator/deexcitationoperator.hpp"
 #include "operator/excitationoperator.hpp"
+#include "operator/denominator.hpp"
 #include "util/iterative.hpp"
 #include "convergence/diis.hpp"
 
@@ -28,12 +29,17 @@ namespace cc
  *                           c                    c
  *
  * As in LambdaCCSD, the full left-hand eigenfunction is used instead of lambda.
+ * The perturbations and frequency grid are those of PerturbedCCSD, and are
+ * solved for in the same way.
  */
 template <typename U>
 class PerturbedLambdaCCSD : public Iterative<U>
 {
     protected:
-        convergence::DIIS<op::DeexcitationOperator<U,2>> diis;
+        input::Config diis_config;
+        vector<double> omega;
+        int ifreq;
+        unique_vector<convergence::DIIS<op::DeexcitationOperator<U,2>>> diis;
 
     public:
         PerturbedLambdaCCSD(const string& name, input::Config& config);
@@ -14,7 +14,8 @@ namespace cc
 
 template <typename U>
 RHFCCSD<U>::RHFCCSD(const string& name, Config& config)
-: Iterative<U>(name, config), diis_config(config.get("diis"))
+: Iterative<U>(name, config), diis_config(config.get("diis")),
+  tile_size(config.get<int>("tile_size")), tile_screening(config.get<double>("tile_screening"))
 {
     vector<Requirement> reqs;
     reqs.push_back(Requirement( "mofock",     "f"));
@@ -97,6 +98,33 @@ bool RHFCCSD<U>::run(TaskDAG& dag, const Arena& arena)
 
     this->puttmp("DIIS", new DIIS<SymmetryBlockedTensor<U>>(diis_config, 2, 2));
 
+    /*
+     * Without symmetry, <ab||ef> and Tau are each a single block, so the
+     * particle-particle ladder is done on tiles of the virtual and occupied
+     * ranges instead, which lets zero and negligible tiles be skipped
+     */
+    if (tile_size > 0 && occ.group.getNumIrreps() > 1)
+    {
+        Logger::warn(arena) << "Tiling is only used without symmetry" << endl;
+        tile_size = 0;
+    }
+
+    if (tile_size > 0)
+    {
+        const auto& VABCD = this->template get<SymmetryBlockedTensor<U>>("VABCD");
+
+        vector<int> tA = TiledTensor<U>::partition(nA[0], tile_size);
+        vector<int> tI = TiledTensor<U>::partition(nI[0], tile_size);
+
+        auto& VABCDt = this->puttmp("VABCDt", new TiledTensor<U>("<Ab|Cd>", arena, {tA,tA,tA,tA}));
+        this->puttmp("Taut", new TiledTensor<U>("Tau", arena, {tA,tA,tI,tI}));
+        this->puttmp(  "Z2t", new TiledTensor<U>( "Z2", arena, {tA,tA,tI,tI}));
+
+        VABCDt.set(VABCD({0,0,0,0}));
+        Logger::log(arena) << "<Ab|Cd> is stored in " << VABCDt.getNumAllocated() << " of " <<
+                              VABCDt.getNumTiles() << " tiles" << endl;
+    }
+
     CTF_Timer_epoch ep(this->name.c_str());
     ep.begin();
     Iterative<U>::run(dag, arena);
@@ -300,7 +328,20 @@ void RHFCCSD<U>::iterate(const Arena& arena)
     Z2["abij"] -=     WAMIJ["amij"]*   T1[  "bm"];
     Z2["abij"] +=       FAE[  "ae"]*   T2["ebij"];
     Z2["abij"] -=       FMI[  "mi"]*   T2["abmj"];
-    Z2["abij"] += 0.5*VABCD["abef"]*  Tau["efij"];
+    if (tile_size > 0)
+    {
+        const auto& VABCDt = this->template gettmp<TiledTensor<U>>("VABCDt");
+        auto&         Taut = this->template gettmp<TiledTensor<U>>(  "Taut");
+        auto&          Z2t = this->template gettmp<TiledTensor<U>>(   "Z2t");
+
+        Taut.set(Tau({0,0,0,0}));
+        Z2t.mult(0.5, VABCDt, "abef", Taut, "efij", 0, "abij", tile_screening);
+        Z2t.get(1, Z2({0,0,0,0}), 1);
+    }
+    else
+    {
+        Z2["abij"] += 0.5*VABCD["abef"]*  Tau["efij"];
+    }
     Z2["abij"] += 0.5*WMNIJ["mnij"]*  Tau["abmn"];
     Z2["abij"] += 0.5*WAMIE["amie"]* T2SA["ebmj"];
     Z2["abij"] -= 0.5*WAMEI["amei"]*   T2["ebjm"];
@@ -337,6 +378,10 @@ max_iterations?
     int 50,
 conv_type?
     enum { MAXE, RMSE, MAE },
+tile_size?
+    int 0,
+tile_screening?
+    double 0.0,
 diis?
 {
     damping?
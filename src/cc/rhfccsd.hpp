@@ -10,6 +10,7 @@
 #include "operator/excitationoperator.hpp"
 #include "operator/st2eoperator.hpp"
 #include "operator/denominator.hpp"
+#include "tensor/tiled_tensor.hpp"
 #include "convergence/diis.hpp"
 
 namespace aquarius
@@ -22,6 +23,8 @@ class RHFCCSD : public Iterative<U>
 {
     protected:
         input::Config diis_config;
+        int tile_size;
+        double tile_screening;
 
     public:
         RHFCCSD(const string& name, input::Config& config);
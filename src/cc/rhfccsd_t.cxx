@@ -0,0 +1,146 @@
+#include "rhfccsd_t.hpp"
+
+using namespace aquarius::op;
+using namespace aquarius::input;
+using namespace aquarius::tensor;
+using namespace aquarius::task;
+using namespace aquarius::time;
+using namespace aquarius::symmetry;
+
+namespace aquarius
+{
+namespace cc
+{
+
+template <typename U>
+RHFCCSD_T<U>::RHFCCSD_T(const string& name, Config& config)
+: Task(name, config), batch_size(config.get<int>("batch_size"))
+{
+    vector<Requirement> reqs;
+    reqs.push_back(Requirement(    "mofock",     "f"));
+    reqs.push_back(Requirement(   "<Ab|Ci>", "VABCI"));
+    reqs.push_back(Requirement(   "<Ab|Ij>", "VABIJ"));
+    reqs.push_back(Requirement(   "<Ai|Jk>", "VAIJK"));
+    reqs.push_back(Requirement("rhfccsd.T1",    "T1"));
+    reqs.push_back(Requirement("rhfccsd.T2",    "T2"));
+    this->addProduct(Product("double", "energy", reqs));
+}
+
+template <typename U>
+bool RHFCCSD_T<U>::run(task::TaskDAG& dag, const Arena& arena)
+{
+    const auto& f = this->template get<OneElectronOperator<U>>("f");
+
+    const Space& occ = f.occ;
+    const Space& vrt = f.vrt;
+    const PointGroup& group = occ.group;
+    int nirrep = group.getNumIrreps();
+    const vector<int>& nI = occ.nalpha;
+    const vector<int>& nA = vrt.nalpha;
+
+    const auto& VABCI = this->template get<SymmetryBlockedTensor<U>>("VABCI");
+    const auto& VABIJ = this->template get<SymmetryBlockedTensor<U>>("VABIJ");
+    const auto& VAIJK = this->template get<SymmetryBlockedTensor<U>>("VAIJK");
+    const auto&    T1 = this->template get<SymmetryBlockedTensor<U>>(   "T1");
+    const auto&    T2 = this->template get<SymmetryBlockedTensor<U>>(   "T2");
+
+    Denominator<U> D(f);
+
+    vector<int> zero(nirrep, 0);
+
+    U E_T = 0;
+
+    CTF_Timer_epoch ep(this->name.c_str());
+    ep.begin();
+
+    for (int h = 0;h < nirrep;h++)
+    {
+        int batch = (batch_size > 0 ? batch_size : max(nI[h], 1));
+
+        for (int k0 = 0;k0 < nI[h];k0 += batch)
+        {
+            /*
+             * Occupied index k is restricted to k0..k0+nk-1 in irrep h
+             */
+            int nk = min(batch, nI[h]-k0);
+
+            vector<int> nK(nirrep, 0); nK[h] = nk;
+            vector<int> sK(nirrep, 0); sK[h] = k0;
+
+            vector<vector<U>> DK(nirrep);
+            DK[h].assign(D.getDI()[h].begin()+k0, D.getDI()[h].begin()+k0+nk);
+
+            SymmetryBlockedTensor<U>    Tk(   "T(ab,kj)",    T2, {zero,zero,  sK,zero}, {   nA,nA,nK,nI});
+            SymmetryBlockedTensor<U>   T1k(     "T(ak)",    T1, {zero,  sK},           {   nA,nK});
+            SymmetryBlockedTensor<U>    Vk("<Ab|Ck>", VABCI, {zero,zero,zero,  sK}, {   nA,nA,nA,nK});
+            SymmetryBlockedTensor<U>    Bk("<Ab|Ik>", VABIJ, {zero,zero,zero,  sK}, {   nA,nA,nI,nK});
+            SymmetryBlockedTensor<U>   A2k("<Ak|Ij>", VAIJK, {zero,  sK,zero,zero}, {   nA,nK,nI,nI});
+            SymmetryBlockedTensor<U>   A3k("<Aj|Kl>", VAIJK, {zero,zero,  sK,zero}, {   nA,nI,nK,nI});
+
+            SymmetryBlockedTensor<U> W("W(abc,ijk)", arena, group, 6, {nA,nA,nA,nI,nI,nK}, {NS,NS,NS,NS,NS,NS}, false);
+            SymmetryBlockedTensor<U> V("V(abc,ijk)", arena, group, 6, {nA,nA,nA,nI,nI,nK}, {NS,NS,NS,NS,NS,NS}, false);
+            SymmetryBlockedTensor<U> Y("Y(abc,ijk)", arena, group, 6, {nA,nA,nA,nI,nI,nK}, {NS,NS,NS,NS,NS,NS}, false);
+
+            /*
+             * W(abc,ijk) = P(ai,bj,ck) [ (bd|ai) t(cd,kj) - (ck|jl) t(ab,il) ]
+             *
+             * The six pair permutations are written out explicitly so that
+             * k only ever appears on a sliced operand.
+             */
+            W["abcijk"]  = VABCI["badi"]* Tk["cdkj"];
+            W["abcijk"] -=   A3k["cjkl"]* T2["abil"];
+            W["abcijk"] += VABCI["cadi"]* Tk["dbkj"];
+            W["abcijk"] -=   A2k["bkjl"]* T2["acil"];
+            W["abcijk"] += VABCI["abdj"]* Tk["cdki"];
+            W["abcijk"] -=   A3k["cikl"]* T2["bajl"];
+            W["abcijk"] += VABCI["cbdj"]* Tk["daki"];
+            W["abcijk"] -=   A2k["akil"]* T2["bcjl"];
+            W["abcijk"] +=    Vk["acdk"]* T2["bdji"];
+            W["abcijk"] -= VAIJK["bijl"]* Tk["cakl"];
+            W["abcijk"] +=    Vk["bcdk"]* T2["adij"];
+            W["abcijk"] -= VAIJK["ajil"]* Tk["cbkl"];
+
+            /*
+             * V(abc,ijk) = W(abc,ijk) + (bj|ck) t(a,i) + (ai|ck) t(b,j) + (ai|bj) t(c,k)
+             */
+            V["abcijk"]  =     W["abcijk"];
+            V["abcijk"] +=    Bk["bcjk"]* T1[  "ai"];
+            V["abcijk"] +=    Bk["acik"]* T1[  "bj"];
+            V["abcijk"] += VABIJ["abij"]*T1k[  "ck"];
+
+            /*
+             * E(T) = 1/3 sum (4 W(abc) + W(bca) + W(cab)) (V(abc) - V(cba)) / D(abc,ijk)
+             */
+            Y["abcijk"]  =   4*W["abcijk"];
+            Y["abcijk"] +=     W["bcaijk"];
+            Y["abcijk"] +=     W["cabijk"];
+
+            W["abcijk"]  =     V["abcijk"];
+            W["abcijk"] -=     V["cbaijk"];
+            W.weight({&D.getDA(), &D.getDA(), &D.getDA(), &D.getDI(), &D.getDI(), &DK});
+
+            E_T += scalar(Y*W)/3;
+        }
+    }
+
+    ep.end();
+
+    this->log(arena) << printos("energy: %18.15f", E_T) << endl;
+
+    this->put("energy", new U(E_T));
+
+    return true;
+}
+
+}
+}
+
+static const char* spec = R"!(
+
+batch_size?
+    int 0
+
+)!";
+
+INSTANTIATE_SPECIALIZATIONS(aquarius::cc::RHFCCSD_T);
+REGISTER_TASK(aquarius::cc::RHFCCSD_T<double>,"rhfccsd(t)",spec);
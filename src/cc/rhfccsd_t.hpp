@@ -0,0 +1,39 @@
+#ifndef _AQUARIUS_CC_RHFCCSD_T_HPP_
+#define _AQUARIUS_CC_RHFCCSD_T_HPP_
+
+#include "util/global.hpp"
+
+#include "task/task.hpp"
+#include "time/time.hpp"
+#include "operator/1eoperator.hpp"
+#include "operator/denominator.hpp"
+
+#include "rhfccsd.hpp"
+
+namespace aquarius
+{
+namespace cc
+{
+
+/*
+ * Closed-shell (T) correction from spin-adapted RHF-CCSD amplitudes, using the
+ * spin-summed expressions of Rendell, Lee, and Komornicki, CPL 178, 462 (1991).
+ * The third occupied index is batched (per irrep, in chunks of at most
+ * batch_size orbitals) so that only O(v^3 o^2 n_batch) storage is needed.
+ */
+template <typename U>
+class RHFCCSD_T : public task::Task
+{
+    protected:
+        int batch_size;
+
+    public:
+        RHFCCSD_T(const string& name, input::Config& config);
+
+        bool run(task::TaskDAG& dag, const Arena& arena);
+};
+
+}
+}
+
+#endif
@@ -12,6 +12,15 @@ BasisSet::BasisSet(const string& file)
     readBasisSet(file);
 }
 
+const BasisSet& BasisSet::load(const string& file)
+{
+    static map<string,BasisSet> cache;
+
+    auto it = cache.find(file);
+    if (it == cache.end()) it = cache.emplace(file, BasisSet(file)).first;
+    return it->second;
+}
+
 void BasisSet::readBasisSet(const string& file)
 {
     ifstream ifs(file.c_str());
@@ -81,21 +90,20 @@ string BasisSet::readLine(istream& is, const string& file, int& lineno)
     return line;
 }
 
-void BasisSet::apply(Atom& atom, bool spherical, bool contaminants)
+void BasisSet::apply(Atom& atom, bool spherical, bool contaminants) const
 {
     string e(atom.getCenter().getElement().getName());
-    vector<ShellBasis> v;
-    vector<ShellBasis>::iterator it2;
+    vector<ShellBasis>::const_iterator it2;
 
 		if (e == "Dummy" || e == "Ghost") return;
 
-    map<string,vector<ShellBasis>>::iterator it = atomBases.find(e);
+    map<string,vector<ShellBasis>>::const_iterator it = atomBases.find(e);
     if (it == atomBases.end())
     {
         throw BasisSetNotFoundError(e);
     }
 
-    v = it->second;
+    const vector<ShellBasis>& v = it->second;
 
     for (it2 = v.begin();it2 != v.end();++it2)
     {
@@ -104,7 +112,7 @@ void BasisSet::apply(Atom& atom, bool spherical, bool contaminants)
     }
 }
 
-void BasisSet::apply(Molecule& molecule, bool spherical, bool contaminants)
+void BasisSet::apply(Molecule& molecule, bool spherical, bool contaminants) const
 {
     vector<Atom>::iterator it;
 
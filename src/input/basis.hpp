@@ -116,9 +116,16 @@ class BasisSet
 
         BasisSet(const string& file);
 
-        void apply(Atom& atom, bool spherical = true, bool contaminants = false);
+        /*
+         * Return the basis set read from file, reading it only the first time
+         * it is requested so that repeated molecules (e.g. the jobs of a
+         * batch) share a single parsed copy
+         */
+        static const BasisSet& load(const string& file);
 
-        void apply(Molecule& molecule, bool spherical = true, bool contaminants = false);
+        void apply(Atom& atom, bool spherical = true, bool contaminants = false) const;
+
+        void apply(Molecule& molecule, bool spherical = true, bool contaminants = false) const;
 };
 
 }
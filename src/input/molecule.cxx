@@ -129,6 +129,30 @@ class Config::Extractor<AtomCartSpec>
         }
 };
 
+template<>
+class Config::Extractor<PointCharge>
+{
+    public:
+        static PointCharge extract(Node& node, int which = 0)
+        {
+            PointCharge c;
+
+            auto i = node.children.begin();
+            auto e = node.children.end();
+
+            if (i == e) throw BadValueError(node.fullName());
+            c.charge = Parser<double>::parse(i->data); ++i;
+
+            for (int xyz = 0;xyz < 3;xyz++)
+            {
+                if (i == e) throw BadValueError(node.fullName());
+                c.pos[xyz] = Parser<double>::parse(i->data); ++i;
+            }
+
+            return c;
+        }
+};
+
 MoleculeTask::MoleculeTask(const string& name, input::Config& config)
 : Task(name, config), config(config)
 {
@@ -170,6 +194,8 @@ Molecule::Molecule(Config& config, const Arena& arena)
         printf("Rotation constants (MHz): %15.6f %15.6f %15.6f\n", 29979.246*rota[0], 29979.246*rota[1], 29979.246*rota[2]);
         cout << "The molecular point group is " << group->getName() << endl;
         cout << "There are " << norb << " atomic orbitals by irrep\n";
+        if (!charges.empty())
+            cout << "There are " << charges.size() << " external point charges\n";
         cout << "There are " << getNumAlphaElectrons() << " alpha and "
                              << getNumBetaElectrons() << " beta electrons\n\n";
     }
@@ -267,6 +293,80 @@ void Molecule::initGeometry(Config& config, vector<AtomCartSpec>& cartpos)
             nucrep += ea.getCharge()*eb.getCharge()/norm(a->pos-b->pos);
         }
     }
+
+    /*
+     * External point charges, given either in the input as "charge, x, y, z"
+     * or one per line in a separate file (for large embedding environments)
+     */
+    vector<pair<string,PointCharge>> chargespecs = config.find<PointCharge>("point_charge");
+    for (vector<pair<string,PointCharge>>::iterator it = chargespecs.begin();it != chargespecs.end();++it)
+    {
+        charges.push_back(it->second);
+    }
+
+    try
+    {
+        string file = config.get<string>("point_charges");
+        ifstream ifs(file);
+        if (!ifs) throw runtime_error("could not open point charge file " + file);
+
+        string line;
+        while (getline(ifs, line))
+        {
+            if (line.empty() || line[0] == '#') continue;
+
+            PointCharge c;
+            istringstream iss(line);
+            if (!(iss >> c.charge >> c.pos[0] >> c.pos[1] >> c.pos[2]))
+                throw runtime_error("invalid point charge in " + file + ": " + line);
+
+            charges.push_back(c);
+        }
+    }
+    catch (EntryNotFoundError& e) {}
+
+    for (vector<PointCharge>::iterator c = charges.begin();c != charges.end();++c)
+    {
+        c->pos *= bohr;
+        c->pos -= com;
+
+        for (vector<AtomCartSpec>::iterator a = cartpos.begin();a != cartpos.end();++a)
+        {
+            Element ea = Element::getElement(a->symbol.c_str());
+            if (a->charge_from_input != 0.0)
+            {
+                ea.setCharge(a->charge_from_input);
+            }
+            nucrep += ea.getCharge()*c->charge/norm(a->pos-c->pos);
+        }
+    }
+}
+
+bool Molecule::isSymmetric(const vector<PointCharge>& charges, const mat3x3& op)
+{
+    /*
+     * There may be very many charges, so compare sorted lists of positions
+     * (rounded to 1e-8) instead of searching for each image
+     */
+    typedef tuple<int64_t,int64_t,int64_t,int64_t> key;
+
+    auto makeKey = [](const vec3& pos, double charge)
+    {
+        return key(llround(pos[0]*1e8), llround(pos[1]*1e8),
+                   llround(pos[2]*1e8), llround(charge*1e8));
+    };
+
+    vector<key> before, after;
+    for (vector<PointCharge>::const_iterator c = charges.begin();c != charges.end();++c)
+    {
+        before.push_back(makeKey(c->pos, c->charge));
+        after.push_back(makeKey(op*c->pos, c->charge));
+    }
+
+    sort(before.begin(), before.end());
+    sort(after.begin(), after.end());
+
+    return before == after;
 }
 
 bool Molecule::isSymmetric(const vector<AtomCartSpec>& cartpos, const mat3x3& op)
@@ -1177,9 +1277,18 @@ void Molecule::initSymmetry(Config& config, vector<AtomCartSpec>& cartpos)
         it->pos = O*it->pos;
     }
 
+    for (vector<PointCharge>::iterator it = charges.begin();it != charges.end();++it)
+    {
+        it->pos = O*it->pos;
+    }
+
     for (int i = 0;i < group->getOrder();i++)
     {
         assert(isSymmetric(cartpos, group->getOp(i)));
+
+        if (!isSymmetric(charges, group->getOp(i)))
+            throw runtime_error(string("the point charges do not have ") + group->getName() +
+                                " symmetry; use a lower subgroup");
     }
 
     I = 0;
@@ -1241,12 +1350,12 @@ void Molecule::initBasis(Config& config, const vector<AtomCartSpec>& cartpos)
     bool contaminants = config.get<bool>("basis.contaminants");
     bool spherical = config.get<bool>("basis.spherical");
 
-    BasisSet defaultBasis;
+    const BasisSet* defaultBasis = NULL;
     bool hasDefaultBasis;
     try
     {
         string name = config.get<string>("basis.basis_set");
-        defaultBasis = BasisSet(TOPDIR "/basis/" + name);
+        defaultBasis = &BasisSet::load(TOPDIR "/basis/" + name);
         hasDefaultBasis = true;
     }
     catch (EntryNotFoundError& e)
@@ -1266,11 +1375,11 @@ void Molecule::initBasis(Config& config, const vector<AtomCartSpec>& cartpos)
         Atom a(Center(*group, it->pos, myelem));
         if (it->basisSet != "")
         {
-            BasisSet(TOPDIR "/basis/" + it->basisSet).apply(a, spherical, contaminants);
+            BasisSet::load(TOPDIR "/basis/" + it->basisSet).apply(a, spherical, contaminants);
         }
         else if (hasDefaultBasis)
         {
-            defaultBasis.apply(a, spherical, contaminants);
+            defaultBasis->apply(a, spherical, contaminants);
         }
 
         atoms.push_back(a);
@@ -1359,6 +1468,13 @@ atom+
     # or xyz position
     *+
 },
+point_charge*
+{
+    # charge and position, e.g. -0.834, 1.0, 2.0, 3.0
+    *+
+},
+# file with one point charge per line, as "charge x y z"
+point_charges? string,
 basis?
 {
     contaminants?
@@ -23,6 +23,7 @@ class Molecule
 
     protected:
         vector<Atom> atoms;
+        vector<integrals::PointCharge> charges;
         int multiplicity;
         int nelec;
         vector<int> norb;
@@ -127,6 +128,8 @@ class Molecule
 
         static bool isSymmetric(const vector<AtomCartSpec>& cartpos, const mat3x3& op);
 
+        static bool isSymmetric(const vector<integrals::PointCharge>& charges, const mat3x3& op);
+
         void initGeometry(input::Config& config, vector<AtomCartSpec>& cartpos);
 
         void initSymmetry(input::Config& config, vector<AtomCartSpec>& cartpos);
@@ -152,6 +155,12 @@ class Molecule
 
         const symmetry::PointGroup& getGroup() const { return *group; }
 
+        /*
+         * External point charges, which enter the nuclear attraction
+         * integrals and the nuclear repulsion energy
+         */
+        const vector<integrals::PointCharge>& getPointCharges() const { return charges; }
+
         typedef shell_iterator_<integrals::Shell,
                                 vector<Atom>::iterator,
                                 vector<integrals::Shell>::iterator > shell_iterator;
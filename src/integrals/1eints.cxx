@@ -3,6 +3,7 @@
 #include "kei.hpp"
 #include "ovi.hpp"
 #include "nai.hpp"
+#include "moments.hpp"
 
 #define IDX_EQ(i,r,e,j,s,f) ((i) == (j) && (r) == (s) && (e) == (f))
 #define IDX_GE(i,r,e,j,s,f) ((i) > (j) || ((i) == (j) && ((r) > (s) || ((r) == (s) && (e) >= (f)))))
@@ -19,34 +20,45 @@ namespace integrals
 {
 
 OneElectronIntegrals::OneElectronIntegrals(const Shell& a, const Shell& b)
+: OneElectronIntegrals(a, b, vector<int>(1,0)) {}
+
+OneElectronIntegrals::OneElectronIntegrals(const Shell& a, const Shell& b, const vector<int>& opirrep)
 : sa(a), sb(b), group(a.getCenter().getPointGroup()),
   ca(a.getCenter()), cb(b.getCenter()), la(a.getL()), lb(b.getL()),
   na(a.getNPrim()), nb(b.getNPrim()), ma(a.getNContr()), mb(b.getNContr()),
   da(a.getDegeneracy()), db(b.getDegeneracy()), fsa(a.getNFunc()), fsb(b.getNFunc()),
-  za(a.getExponents()), zb(b.getExponents()), num_processed(0)
+  za(a.getExponents()), zb(b.getExponents()), nops(opirrep.size()), opirrep(opirrep),
+  opstart(nops+1, 0), num_processed(nops, 0)
 {
     fca = (la+1)*(la+2)/2;
     fcb = (lb+1)*(lb+2)/2;
 
-    int nints = 0;
-    for (int j = 0;j < fsb;j++)
+    for (int op = 0;op < nops;op++)
     {
-        for (int i = 0;i < fsa;i++)
+        const Representation& g = group.getIrrep(opirrep[op]);
+
+        int nints = 0;
+        for (int j = 0;j < fsb;j++)
         {
-            for (int s = 0;s < db;s++)
+            for (int i = 0;i < fsa;i++)
             {
-                for (int r = 0;r < da;r++)
+                for (int s = 0;s < db;s++)
                 {
-                    const Representation& w = group.getIrrep(a.getIrrepOfFunc(i, r));
-                    const Representation& x = group.getIrrep(b.getIrrepOfFunc(j, s));
+                    for (int r = 0;r < da;r++)
+                    {
+                        const Representation& w = group.getIrrep(a.getIrrepOfFunc(i, r));
+                        const Representation& x = group.getIrrep(b.getIrrepOfFunc(j, s));
 
-                    if ((w*x).isTotallySymmetric()) nints += ma*mb;
+                        if ((w*x*g).isTotallySymmetric()) nints += ma*mb;
+                    }
                 }
             }
         }
+
+        opstart[op+1] = opstart[op]+nints;
     }
 
-    ints.resize(nints);
+    ints.resize(opstart[nops]);
 }
 
 void OneElectronIntegrals::run()
@@ -56,10 +68,17 @@ void OneElectronIntegrals::run()
 
 size_t OneElectronIntegrals::process(const Context& ctx, const vector<int>& idxa, const vector<int>& idxb,
                                      size_t nprocess, double* integrals, idx2_t* indices, double cutoff)
+{
+    return process(0, ctx, idxa, idxb, nprocess, integrals, indices, cutoff);
+}
+
+size_t OneElectronIntegrals::process(int op, const Context& ctx, const vector<int>& idxa, const vector<int>& idxb,
+                                     size_t nprocess, double* integrals, idx2_t* indices, double cutoff)
 {
     const PointGroup& group = ca.getPointGroup();
+    const Representation& g = group.getIrrep(opirrep[op]);
 
-    size_t m = 0;
+    size_t m = opstart[op];
     size_t n = 0;
     for (int j = 0;j < fsb;j++)
     {
@@ -72,13 +91,13 @@ size_t OneElectronIntegrals::process(const Context& ctx, const vector<int>& idxa
                     const Representation w = group.getIrrep(sa.getIrrepOfFunc(i,r));
                     const Representation x = group.getIrrep(sb.getIrrepOfFunc(j,s));
 
-                    if (!(w*x).isTotallySymmetric()) continue;
+                    if (!(w*x*g).isTotallySymmetric()) continue;
 
                     for (int f = 0;f < mb;f++)
                     {
                         for (int e = 0;e < ma;e++)
                         {
-                            if (num_processed > m)
+                            if (opstart[op]+num_processed[op] > m)
                             {
                                 m++;
                                 continue;
@@ -91,7 +110,7 @@ size_t OneElectronIntegrals::process(const Context& ctx, const vector<int>& idxa
                                 integrals[n++] = ints[m];
                             }
 
-                            num_processed++;
+                            num_processed[op]++;
                             m++;
 
                             if (n >= nprocess) return n;
@@ -105,6 +124,14 @@ size_t OneElectronIntegrals::process(const Context& ctx, const vector<int>& idxa
     return n;
 }
 
+vector<double> OneElectronIntegrals::ao(const vec3& posa, const vec3& posb)
+{
+    vector<double> aointegrals(fca*fcb*na*nb*nops);
+    spher(posa, posb, aointegrals.data());
+    aointegrals.resize(fsa*fsb*ma*mb*nops);
+    return aointegrals;
+}
+
 void OneElectronIntegrals::prim(const vec3& posa, int e,
                                 const vec3& posb, int f, double* integrals)
 {
@@ -121,7 +148,7 @@ void OneElectronIntegrals::prims(const vec3& posa, const vec3& posb,
         {
             int f = m/na;
             int e = m%na;
-            prim(posa, e, posb, f, integrals+fca*fcb*m);
+            prim(posa, e, posb, f, integrals+fca*fcb*nops*m);
         }
     }
 }
@@ -129,9 +156,9 @@ void OneElectronIntegrals::prims(const vec3& posa, const vec3& posb,
 void OneElectronIntegrals::contr(const vec3& posa, const vec3& posb,
                                  double* integrals)
 {
-    vector<double> pintegrals(fca*fcb*na*nb);
+    vector<double> pintegrals(fca*fcb*na*nb*nops);
     prims(posa, posb, pintegrals.data());
-    prim2contr2r(fca*fcb, pintegrals.data(), integrals);
+    prim2contr2r(fca*fcb*nops, pintegrals.data(), integrals);
 }
 
 void OneElectronIntegrals::spher(const vec3& posa, const vec3& posb,
@@ -139,16 +166,25 @@ void OneElectronIntegrals::spher(const vec3& posa, const vec3& posb,
 {
     vector<double> cintegrals(fca*fcb*na*nb);
     contr(posa, posb, integrals);
-    cart2spher2r(ma*mb, integrals, cintegrals.data());
-    transpose(fsa*fsb, ma*mb, 1.0, cintegrals.data(), fsa*fsb,
-                              0.0,  integrals       ,   ma*mb);
+
+    /*
+     * Each operator is transformed separately; the spherical integrals of
+     * operator op are packed at op*fsa*fsb*ma*mb, which never overwrites the
+     * Cartesian integrals of a later operator
+     */
+    for (int op = 0;op < nops;op++)
+    {
+        cart2spher2r(ma*mb, integrals+op*fca*fcb*ma*mb, cintegrals.data());
+        transpose(fsa*fsb, ma*mb, 1.0, cintegrals.data()      , fsa*fsb,
+                                  0.0, integrals+op*fsa*fsb*ma*mb,   ma*mb);
+    }
 }
 
 void OneElectronIntegrals::so(double* integrals)
 {
     const PointGroup& group = ca.getPointGroup();
 
-    vector<double> aointegrals(fca*fcb*na*nb);
+    vector<double> aointegrals(fca*fcb*na*nb*nops);
 
     int lambdar;
     vector<int> dcrr = group.DCR(ca.getStabilizer(), cb.getStabilizer(), lambdar);
@@ -157,13 +193,19 @@ void OneElectronIntegrals::so(double* integrals)
     for (int r : dcrr)
     {
         spher(ca.getCenter(0), cb.getCenter(cb.getCenterAfterOp(r)), aointegrals.data());
-        scal(aointegrals.size(), coef, aointegrals.data(), 1);
-        ao2so2(ma*mb, r, aointegrals.data(), integrals);
+        scal(fsa*fsb*ma*mb*nops, coef, aointegrals.data(), 1);
+
+        for (int op = 0;op < nops;op++)
+        {
+            ao2so2(ma*mb, r, op, aointegrals.data()+op*fsa*fsb*ma*mb, integrals+opstart[op]);
+        }
     }
 }
 
-void OneElectronIntegrals::ao2so2(size_t nother, int r, double* aointegrals, double* sointegrals)
+void OneElectronIntegrals::ao2so2(size_t nother, int r, int op, double* aointegrals, double* sointegrals)
 {
+    const Representation& g = group.getIrrep(opirrep[op]);
+
     for (int j = 0;j < fsb;j++)
     {
         for (int i = 0;i < fsa;i++)
@@ -175,7 +217,7 @@ void OneElectronIntegrals::ao2so2(size_t nother, int r, double* aointegrals, dou
                     int w = sa.getIrrepOfFunc(i,e);
                     int x = sb.getIrrepOfFunc(j,f);
 
-                    if (!(group.getIrrep(w)*group.getIrrep(x)).isTotallySymmetric()) continue;
+                    if (!(group.getIrrep(w)*group.getIrrep(x)*g).isTotallySymmetric()) continue;
 
                     double fac = sb.getParity(j,r)*group.character(x,r);
                     axpy(nother, fac, aointegrals, 1, sointegrals, 1);
@@ -303,4 +345,16 @@ void OneElectronIntegrals::prim2contr2l(size_t nother, double* buf1, double* buf
 }
 }
 
-REGISTER_TASK(aquarius::integrals::Ishida1eIntegralsTask,"1eints");
+static const char* spec = R"!(
+
+multipole?
+    int 0,
+nai_order?
+    int 8,
+# 0 sums over all charges exactly, without the multipole expansion
+nai_cutoff?
+    double 1e-10
+
+)!";
+
+REGISTER_TASK(aquarius::integrals::OSMultipole1eIntegralsTask,"1eints",spec);
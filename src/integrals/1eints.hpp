@@ -30,6 +30,8 @@ namespace integrals
 class IshidaOVI;
 class IshidaKEI;
 class IshidaNAI;
+class MultipoleNAI;
+class OSMoments;
 
 class OneElectronIntegrals
 {
@@ -47,21 +49,44 @@ class OneElectronIntegrals
         int fsa, fsb;
         const vector<double>& za;
         const vector<double>& zb;
+        /*
+         * Several operators may be computed in one pass; the primitive
+         * integrals of each operator are stored consecutively, and opirrep
+         * gives the irrep of each operator
+         */
+        int nops;
+        vector<int> opirrep;
+        vector<size_t> opstart;
         vector<double> ints;
-        size_t num_processed;
+        vector<size_t> num_processed;
 
     public:
         OneElectronIntegrals(const Shell& a, const Shell& b);
 
+        OneElectronIntegrals(const Shell& a, const Shell& b, const vector<int>& opirrep);
+
         virtual ~OneElectronIntegrals() {}
 
         void run();
 
+        int getNumOperators() const { return nops; }
+
+        int getOperatorIrrep(int op) const { return opirrep[op]; }
+
         const vector<double>& getIntegrals() const { return ints; }
 
         size_t process(const Context& ctx, const vector<int>& idxa, const vector<int>& idxb,
                        size_t nprocess, double* integrals, idx2_t* indices, double cutoff = -1);
 
+        size_t process(int op, const Context& ctx, const vector<int>& idxa, const vector<int>& idxb,
+                       size_t nprocess, double* integrals, idx2_t* indices, double cutoff = -1);
+
+        /*
+         * The AO integrals with the shells placed at posa and posb instead of
+         * at their own centers, as [ma*mb][fsa*fsb] for each operator in turn
+         */
+        vector<double> ao(const vec3& posa, const vec3& posb);
+
     protected:
         virtual void prim(const vec3& posa, int e,
                           const vec3& posb, int f, double* integrals);
@@ -77,7 +102,7 @@ class OneElectronIntegrals
 
         virtual void so(double* integrals);
 
-        void ao2so2(size_t nother, int r, double* aointegrals, double* sointegrals);
+        void ao2so2(size_t nother, int r, int op, double* aointegrals, double* sointegrals);
 
         void cart2spher2r(size_t nother, double* buf1, double* buf2);
 
@@ -98,6 +123,11 @@ class OneElectronIntegral : public tensor::SymmetryBlockedTensor<double>
                             const symmetry::PointGroup& group, const vector<int>& norb)
         : tensor::SymmetryBlockedTensor<double>(name, arena, group, 2, {norb,norb}, {NS,NS}, true),
           name(name) {}
+
+        OneElectronIntegral(const Arena& arena, const string& name, const symmetry::PointGroup& group,
+                            const symmetry::Representation& rep, const vector<int>& norb)
+        : tensor::SymmetryBlockedTensor<double>(name, arena, group, rep, 2, {norb,norb}, {NS,NS}, true),
+          name(name) {}
 };
 
 struct OVI : public OneElectronIntegral
@@ -124,12 +154,70 @@ struct OneElectronHamiltonian : public OneElectronIntegral
     : OneElectronIntegral(arena, "H", group, norb) {}
 };
 
-template <typename OVIType, typename KEIType, typename NAIType>
+/*
+ * STType computes S, T, and the Cartesian multipoles up to order Lmax about
+ * the origin together (see OSMoments). NAIType computes the attraction to
+ * the nuclei and any external point charges of the molecule, given as a
+ * PointChargeTree (see MultipoleNAI).
+ */
+template <typename STType, typename NAIType>
 class OneElectronIntegralsTask : public task::Task
 {
+    protected:
+        int Lmax;
+        int nai_order;
+        double nai_cutoff;
+
+        void scatter(const symmetry::PointGroup& group, int g, const vector<int>& irrep,
+                     const vector<uint16_t>& start, const vector<int>& N, size_t nproc,
+                     const double* ints, const idx2_t* idxs,
+                     vector<vector<tkv_pair<double>>>& pairs)
+        {
+            int n = group.getNumIrreps();
+
+            for (size_t k = 0;k < nproc;k++)
+            {
+                int irri = irrep[idxs[k].i];
+                int irrj = irrep[idxs[k].j];
+                assert((group.getIrrep(irri)*group.getIrrep(irrj)*
+                        group.getIrrep(g)).isTotallySymmetric());
+
+                uint16_t i = idxs[k].i-start[irri];
+                uint16_t j = idxs[k].j-start[irrj];
+
+                                               pairs[irri*n+irrj].push_back(tkv_pair<double>(i+j*N[irri], ints[k]));
+                if (irri != irrj || i != j) pairs[irrj*n+irri].push_back(tkv_pair<double>(j+i*N[irrj], ints[k]));
+            }
+        }
+
+        void write(const symmetry::PointGroup& group, int g, OneElectronIntegral& ints,
+                   vector<vector<tkv_pair<double>>>& pairs, bool add = false)
+        {
+            int n = group.getNumIrreps();
+
+            for (int i = 0;i < n;i++)
+            {
+                for (int j = 0;j < n;j++)
+                {
+                    if (!(group.getIrrep(i)*group.getIrrep(j)*
+                          group.getIrrep(g)).isTotallySymmetric()) continue;
+
+                    if (add)
+                    {
+                        ints.writeRemoteData({i,j}, 1.0, 1.0, pairs[i*n+j]);
+                    }
+                    else
+                    {
+                        ints.writeRemoteData({i,j}, pairs[i*n+j]);
+                    }
+                }
+            }
+        }
+
     public:
         OneElectronIntegralsTask(const string& name, input::Config& config)
-        : task::Task(name, config)
+        : task::Task(name, config), Lmax(config.get<int>("multipole")),
+          nai_order(config.get<int>("nai_order")), nai_cutoff(config.get<double>("nai_cutoff"))
         {
             vector<task::Requirement> reqs;
             reqs.push_back(task::Requirement("molecule", "molecule"));
@@ -137,16 +225,18 @@ class OneElectronIntegralsTask : public task::Task
             addProduct(task::Product("kei", "T", reqs));
             addProduct(task::Product("nai", "G", reqs));
             addProduct(task::Product("1ehamiltonian", "H", reqs));
+            if (Lmax > 0) addProduct(task::Product("aomultipole", "multipole", reqs));
         }
 
         bool run(task::TaskDAG& dag, const Arena& arena)
         {
             const input::Molecule& molecule = get<input::Molecule>("molecule");
+            const symmetry::PointGroup& group = molecule.getGroup();
 
             Context ctx(Context::ISCF);
 
             const vector<int>& N = molecule.getNumOrbitals();
-            int n = molecule.getGroup().getNumIrreps();
+            int n = group.getNumIrreps();
 
             vector<int> irrep;
             for (int i = 0;i < n;i++) irrep += vector<int>(N[i],i);
@@ -156,7 +246,6 @@ class OneElectronIntegralsTask : public task::Task
 
             vector<vector<int>> idx = Shell::setupIndices(ctx, molecule);
             vector<Shell> shells(molecule.getShellsBegin(), molecule.getShellsEnd());
-            vector<vector<tkv_pair<double>>> ovi_pairs(n), nai_pairs(n), kei_pairs(n);
             vector<Center> centers;
 
             for (auto& atom : molecule.getAtoms())
@@ -164,6 +253,20 @@ class OneElectronIntegralsTask : public task::Task
                 centers.push_back(atom.getCenter());
             }
 
+            vector<PointCharge> charges = NAIType::nuclearCharges(centers);
+            charges += molecule.getPointCharges();
+            typename NAIType::Tree tree(charges, nai_order, nai_cutoff);
+
+            /*
+             * One set of pairs per operator and block of irreps; the first
+             * operators are S and T, and the last is G
+             */
+            vector<int> opirrep = STType::operatorIrreps(group, Lmax);
+            int nops = opirrep.size()+1;
+            opirrep.push_back(0);
+
+            vector<vector<vector<tkv_pair<double>>>> pairs(nops, vector<vector<tkv_pair<double>>>(n*n));
+
             int block = 0;
             for (int a = 0;a < shells.size();++a)
             {
@@ -171,88 +274,73 @@ class OneElectronIntegralsTask : public task::Task
                 {
                     if (block%arena.size == arena.rank)
                     {
-                        OVIType s(shells[a], shells[b]);
-                        KEIType t(shells[a], shells[b]);
-                        NAIType g(shells[a], shells[b], centers);
+                        STType st(shells[a], shells[b], Lmax);
+                        NAIType g(shells[a], shells[b], tree);
 
-                        s.run();
-                        t.run();
+                        st.run();
                         g.run();
 
-                        size_t nint = s.getIntegrals().size();
+                        size_t nint = max(st.getIntegrals().size(), g.getIntegrals().size());
                         vector<double> ints(nint);
                         vector<idx2_t> idxs(nint);
                         size_t nproc;
 
-                        nproc = s.process(ctx, idx[a], idx[b], nint, ints.data(), idxs.data());
-                        for (int k = 0;k < nproc;k++)
+                        for (int op = 0;op < nops-1;op++)
                         {
-                            int irr = irrep[idxs[k].i];
-                            assert(irr == irrep[idxs[k].j]);
-
-                            uint16_t i = idxs[k].i-start[irr];
-                            uint16_t j = idxs[k].j-start[irr];
-
-                                        ovi_pairs[irr].push_back(tkv_pair<double>(i*N[irr]+j, ints[k]));
-                            if (i != j) ovi_pairs[irr].push_back(tkv_pair<double>(j*N[irr]+i, ints[k]));
-                        }
-
-                        nproc = t.process(ctx, idx[a], idx[b], nint, ints.data(), idxs.data());
-                        for (int k = 0;k < nproc;k++)
-                        {
-                            int irr = irrep[idxs[k].i];
-                            assert(irr == irrep[idxs[k].j]);
-
-                            uint16_t i = idxs[k].i-start[irr];
-                            uint16_t j = idxs[k].j-start[irr];
-
-                                        kei_pairs[irr].push_back(tkv_pair<double>(i*N[irr]+j, ints[k]));
-                            if (i != j) kei_pairs[irr].push_back(tkv_pair<double>(j*N[irr]+i, ints[k]));
+                            nproc = st.process(op, ctx, idx[a], idx[b], nint, ints.data(), idxs.data());
+                            scatter(group, opirrep[op], irrep, start, N, nproc, ints.data(), idxs.data(), pairs[op]);
                         }
 
                         nproc = g.process(ctx, idx[a], idx[b], nint, ints.data(), idxs.data());
-                        for (int k = 0;k < nproc;k++)
-                        {
-                            int irr = irrep[idxs[k].i];
-                            assert(irr == irrep[idxs[k].j]);
-
-                            uint16_t i = idxs[k].i-start[irr];
-                            uint16_t j = idxs[k].j-start[irr];
-
-                                        nai_pairs[irr].push_back(tkv_pair<double>(i*N[irr]+j, ints[k]));
-                            if (i != j) nai_pairs[irr].push_back(tkv_pair<double>(j*N[irr]+i, ints[k]));
-                        }
+                        scatter(group, 0, irrep, start, N, nproc, ints.data(), idxs.data(), pairs[nops-1]);
                     }
 
                     block++;
                 }
             }
 
-            OVI *ovi = new OVI(arena, molecule.getGroup(), N);
-            KEI *kei = new KEI(arena, molecule.getGroup(), N);
-            NAI *nai = new NAI(arena, molecule.getGroup(), N);
-            OneElectronHamiltonian *oeh = new OneElectronHamiltonian(arena, molecule.getGroup(), N);
+            OVI *ovi = new OVI(arena, group, N);
+            KEI *kei = new KEI(arena, group, N);
+            NAI *nai = new NAI(arena, group, N);
+            OneElectronHamiltonian *oeh = new OneElectronHamiltonian(arena, group, N);
 
-            for (int i = 0;i < n;i++)
-            {
-                vector<int> irreps(2,i);
-                (*ovi).writeRemoteData(irreps, ovi_pairs[i]);
-                (*kei).writeRemoteData(irreps, kei_pairs[i]);
-                (*nai).writeRemoteData(irreps, nai_pairs[i]);
-                (*oeh).writeRemoteData(irreps, kei_pairs[i]);
-                (*oeh).writeRemoteData(irreps, 1.0, 1.0, nai_pairs[i]);
-            }
+            write(group, 0, *ovi, pairs[0]);
+            write(group, 0, *kei, pairs[1]);
+            write(group, 0, *nai, pairs[nops-1]);
+            write(group, 0, *oeh, pairs[1]);
+            write(group, 0, *oeh, pairs[nops-1], true);
 
             put("S", ovi);
             put("T", kei);
             put("G", nai);
             put("H", oeh);
 
+            if (Lmax > 0)
+            {
+                auto& multipole = put("multipole", new unique_vector<OneElectronIntegral>());
+
+                for (int L = 1;L <= Lmax;L++)
+                {
+                    for (int x = L;x >= 0;x--)
+                    {
+                        for (int y = L-x;y >= 0;y--)
+                        {
+                            int z = L-x-y;
+                            int op = STType::operatorIndex(x,y,z);
+
+                            multipole.emplace_back(arena, "M" + string(x,'x') + string(y,'y') + string(z,'z'),
+                                                   group, group.getIrrep(opirrep[op]), N);
+                            write(group, opirrep[op], multipole.back(), pairs[op]);
+                        }
+                    }
+                }
+            }
+
             return true;
         }
 };
 
-using Ishida1eIntegralsTask = OneElectronIntegralsTask<IshidaOVI, IshidaKEI, IshidaNAI>;
+using OSMultipole1eIntegralsTask = OneElectronIntegralsTask<OSMoments, MultipoleNAI>;
 
 }
 }
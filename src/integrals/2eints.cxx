@@ -69,14 +69,65 @@ void TwoElectronIntegrals::run()
 size_t TwoElectronIntegrals::process(const Context& ctx, const vector<int>& idxa, const vector<int>& idxb,
                                      const vector<int>& idxc, const vector<int>& idxd,
                                      size_t nprocess, double* integrals, idx4_t* indices, double cutoff)
+{
+    if (num_processed == 0 && entries.empty()) buildEntries();
+
+    /*
+     * Index of each (function, degeneracy, contraction) of a shell, at
+     * position (func*degen+r)*ncontr+e
+     */
+    auto table = [&ctx](const Shell& sh, const vector<int>& idx)
+    {
+        int nf = sh.getNFunc();
+        int nd = sh.getDegeneracy();
+        int nm = sh.getNContr();
+
+        vector<uint16_t> tab(nf*nd*nm);
+        for (int i = 0;i < nf;i++)
+            for (int r = 0;r < nd;r++)
+                for (int e = 0;e < nm;e++)
+                    tab[(i*nd+r)*nm+e] = sh.getIndex(ctx, idx, i, e, r);
+
+        return tab;
+    };
+
+    vector<uint16_t> taba = table(sa, idxa);
+    vector<uint16_t> tabb = table(sb, idxb);
+    vector<uint16_t> tabc = table(sc, idxc);
+    vector<uint16_t> tabd = table(sd, idxd);
+
+    /*
+     * Pick up where the last call left off, so that each integral is only
+     * visited once however many times the buffer is refilled
+     */
+    size_t n = 0;
+    for (;num_processed < entries.size() && n < nprocess;num_processed++)
+    {
+        const Entry& x = entries[num_processed];
+
+        if (aquarius::abs(ints[x.m]) > cutoff)
+        {
+            indices[n].i = taba[x.a];
+            indices[n].j = tabb[x.b];
+            indices[n].k = tabc[x.c];
+            indices[n].l = tabd[x.d];
+            integrals[n++] = ints[x.m];
+        }
+    }
+
+    return n;
+}
+
+void TwoElectronIntegrals::buildEntries()
 {
     Representation z = group.getIrrep(0);
     Representation yz = group.getIrrep(0);
     Representation xyz = group.getIrrep(0);
     Representation wxyz = group.getIrrep(0);
 
+    entries.clear();
+
     size_t m = 0;
-    size_t n = 0;
     for (int l = 0;l < fsd;l++)
     {
         for (int k = 0;k < fsc;k++)
@@ -111,12 +162,6 @@ size_t TwoElectronIntegrals::process(const Context& ctx, const vector<int>& idxa
                                             {
                                                 for (int e = 0;e < ma;e++)
                                                 {
-                                                    if (num_processed > m)
-                                                    {
-                                                        m++;
-                                                        continue;
-                                                    }
-
                                                     bool bad = false;
 
                                                     if (&sa == &sb && !IDX_GE(i,r,e,j,s,f)) bad = true;
@@ -124,19 +169,18 @@ size_t TwoElectronIntegrals::process(const Context& ctx, const vector<int>& idxa
                                                     if (&sa == &sc && &sb == &sd && !(IDX_GT(i,r,e,k,t,g) ||
                                                         (IDX_EQ(i,r,e,k,t,g) && IDX_GE(j,s,f,l,u,h)))) bad = true;
 
-                                                    if (!bad && aquarius::abs(ints[m]) > cutoff)
+                                                    if (!bad)
                                                     {
-                                                        indices[n].i = sa.getIndex(ctx, idxa, i, e, r);
-                                                        indices[n].j = sb.getIndex(ctx, idxb, j, f, s);
-                                                        indices[n].k = sc.getIndex(ctx, idxc, k, g, t);
-                                                        indices[n].l = sd.getIndex(ctx, idxd, l, h, u);
-                                                        integrals[n++] = ints[m];
+                                                        Entry x;
+                                                        x.m = m;
+                                                        x.a = (i*da+r)*ma+e;
+                                                        x.b = (j*db+s)*mb+f;
+                                                        x.c = (k*dc+t)*mc+g;
+                                                        x.d = (l*dd+u)*md+h;
+                                                        entries.push_back(x);
                                                     }
 
-                                                    num_processed++;
                                                     m++;
-
-                                                    if (n >= nprocess) return n;
                                                 }
                                             }
                                         }
@@ -150,7 +194,7 @@ size_t TwoElectronIntegrals::process(const Context& ctx, const vector<int>& idxa
         }
     }
 
-    return n;
+    assert(m == ints.size());
 }
 
 void TwoElectronIntegrals::prim(const vec3& posa, int e, const vec3& posb, int f,
@@ -234,8 +278,19 @@ void TwoElectronIntegrals::spher(const vec3& posa, const vec3& posb, const vec3&
                                             0.0,  integrals       ,     ma*mb*mc*md);
 }
 
+vector<double> TwoElectronIntegrals::ao(const vec3& posa, const vec3& posb, const vec3& posc, const vec3& posd)
+{
+    vector<double> aointegrals(fca*fcb*fcc*fcd*na*nb*nc*nd);
+    spher(posa, posb, posc, posd, aointegrals.data());
+    aointegrals.resize(fsa*fsb*fsc*fsd*ma*mb*mc*md);
+    return aointegrals;
+}
+
 void TwoElectronIntegrals::so(double* integrals)
 {
+    size_t nother = ma*mb*mc*md;
+    size_t nao = fsa*fsb*fsc*fsd*nother;
+
     vector<double> aointegrals(fca*fcb*fcc*fcd*na*nb*nc*nd);
 
     int lambdar, lambdas, lambdat;
@@ -245,6 +300,14 @@ void TwoElectronIntegrals::so(double* integrals)
                                  intersection(cc.getStabilizer(), cd.getStabilizer()), lambdat);
     double coef = (double)group.getOrder()/(double)lambdat;
 
+    /*
+     * Compute the AO integrals for every double coset representative, and
+     * store them side by side as [x,ijkl,rst]
+     */
+    vector<int> ops_r, ops_t, ops_st;
+    vector<double> aoblocks;
+    aoblocks.reserve(dcrr.size()*dcrs.size()*dcrt.size()*nao);
+
     for (int r : dcrr)
     {
         for (int s : dcrs)
@@ -258,19 +321,50 @@ void TwoElectronIntegrals::so(double* integrals)
                       cc.getCenter(cc.getCenterAfterOp(t)),
                       cd.getCenter(cd.getCenterAfterOp(st)),
                       aointegrals.data());
-                scal(aointegrals.size(), coef, aointegrals.data(), 1);
-                ao2so4(ma*mb*mc*md, r, t, st, aointegrals.data(), ints.data());
+                aoblocks.insert(aoblocks.end(), aointegrals.begin(), aointegrals.begin()+nao);
+
+                ops_r.push_back(r);
+                ops_t.push_back(t);
+                ops_st.push_back(st);
             }
         }
     }
+
+    ao2so4(nother, ops_r, ops_t, ops_st, coef, aoblocks.data(), integrals);
 }
 
-void TwoElectronIntegrals::ao2so4(size_t nother, int r, int t, int st, double* aointegrals, double* sointegrals)
+void TwoElectronIntegrals::ao2so4(size_t nother, const vector<int>& r, const vector<int>& t, const vector<int>& st,
+                                  double coef, const double* aointegrals, double* sointegrals)
 {
+    int ndcr = r.size();
+    size_t nao = fsa*fsb*fsc*fsd*nother;
+
+    /*
+     * Phases of the SO functions of b, c, and d under each operation
+     */
+    vector<const vector<double>*> pb(ndcr), pc(ndcr), pd(ndcr);
+    for (int o = 0;o < ndcr;o++)
+    {
+        pb[o] = &sb.getPhases(r[o]);
+        pc[o] = &sc.getPhases(t[o]);
+        pd[o] = &sd.getPhases(st[o]);
+    }
+
     Representation yz = group.getIrrep(0);
     Representation xyz = group.getIrrep(0);
     Representation wxyz = group.getIrrep(0);
 
+    vector<double> phase(ndcr*da*db*dc*dd);
+
+    /*
+     * For each AO quartet ijkl, the totally-symmetric SO quartets are
+     *
+     *   SO[x,efgh] = AO[x,rst] Phase[rst,efgh]
+     *
+     * where the phase is the product of those of b, c, and d (a is never
+     * moved), so that the whole transformation is one small GEMM per AO
+     * quartet
+     */
     for (int l = 0;l < fsd;l++)
     {
         for (int k = 0;k < fsc;k++)
@@ -279,6 +373,8 @@ void TwoElectronIntegrals::ao2so4(size_t nother, int r, int t, int st, double* a
             {
                 for (int i = 0;i < fsa;i++)
                 {
+                    int nso = 0;
+
                     for (int h = 0;h < dd;h++)
                     {
                         int z = sd.getIrrepOfFunc(l,h);
@@ -300,17 +396,26 @@ void TwoElectronIntegrals::ao2so4(size_t nother, int r, int t, int st, double* a
 
                                     if (!wxyz.isTotallySymmetric()) continue;
 
-                                    double fac = sb.getParity(j,r) *group.character(x,r)*
-                                                 sc.getParity(k,t) *group.character(y,t)*
-                                                 sd.getParity(l,st)*group.character(z,st);
-                                    axpy(nother, fac, aointegrals, 1, sointegrals, 1);
+                                    for (int o = 0;o < ndcr;o++)
+                                    {
+                                        phase[o+nso*ndcr] = coef*(*pb[o])[j*db+f]*
+                                                                 (*pc[o])[k*dc+g]*
+                                                                 (*pd[o])[l*dd+h];
+                                    }
 
-                                    sointegrals += nother;
+                                    nso++;
                                 }
                             }
                         }
                     }
-                    aointegrals += nother;
+
+                    if (nso > 0)
+                    {
+                        size_t ijkl = i+fsa*(j+fsb*(k+fsc*l));
+                        gemm('N', 'N', nother, nso, ndcr, 1.0, aointegrals+ijkl*nother, nao,
+                             phase.data(), ndcr, 0.0, sointegrals, nother);
+                        sointegrals += nso*nother;
+                    }
                 }
             }
         }
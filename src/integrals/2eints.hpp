@@ -58,6 +58,16 @@ class TwoElectronIntegrals
         const vector<double>& zc;
         const vector<double>& zd;
         vector<double> ints;
+        /*
+         * Position in ints and in the per-shell index tables (see process)
+         * of each unique, symmetry-allowed integral
+         */
+        struct Entry
+        {
+            uint32_t m;
+            uint16_t a, b, c, d;
+        };
+        vector<Entry> entries;
         size_t num_processed;
         double accuracy_;
 
@@ -74,11 +84,19 @@ class TwoElectronIntegrals
                        const vector<int>& idxc, const vector<int>& idxd,
                        size_t nprocess, double* integrals, idx4_t* indices, double cutoff = -1);
 
+        /*
+         * The AO integrals with the shells placed at posa, posb, posc, and
+         * posd instead of at their own centers, as [ma*mb*mc*md][fsa*fsb*fsc*fsd]
+         */
+        vector<double> ao(const vec3& posa, const vec3& posb, const vec3& posc, const vec3& posd);
+
         double accuracy() const { return accuracy_; }
 
         void accuracy(double val) { accuracy_ = val; }
 
     protected:
+        void buildEntries();
+
         virtual void prim(const vec3& posa, int e, const vec3& posb, int f,
                           const vec3& posc, int g, const vec3& posd, int h, double* integrals);
 
@@ -93,7 +111,8 @@ class TwoElectronIntegrals
 
         virtual void so(double* integrals);
 
-        void ao2so4(size_t nother, int r, int t, int st, double* aointegrals, double* sointegrals);
+        void ao2so4(size_t nother, const vector<int>& r, const vector<int>& t, const vector<int>& st,
+                    double coef, const double* aointegrals, double* sointegrals);
 
         void cart2spher4r(size_t nother, double* buf1, double* buf2);
 
@@ -107,9 +126,25 @@ class TwoElectronIntegrals
 class ERI : public task::Destructible, public Distributed
 {
     public:
+        /*
+         * A contiguous range of ints/idxs which came from the same shell
+         * quartet, along with the largest magnitude integral in it. Can
+         * be used to screen whole quartets at a time.
+         */
+        struct Block
+        {
+            uint16_t a, b, c, d;
+            size_t start, size;
+            double max;
+
+            Block(uint16_t a, uint16_t b, uint16_t c, uint16_t d, size_t start, size_t size, double max)
+            : a(a), b(b), c(c), d(d), start(start), size(size), max(max) {}
+        };
+
         const symmetry::PointGroup& group;
         deque<double> ints;
         deque<idx4_t> idxs;
+        vector<Block> blocks;
 
         ERI(const Arena& arena, const symmetry::PointGroup& group) : Distributed(arena), group(group) {}
 
@@ -161,12 +196,21 @@ class TwoElectronIntegralsTask : public task::Task
                                 ERIType block(shells[a], shells[b], shells[c], shells[d]);
                                 block.run();
 
+                                size_t start = eri->ints.size();
+                                double max = 0;
+
                                 size_t n;
                                 while ((n = block.process(ctx, idx[a], idx[b], idx[c], idx[d],
                                                           TMP_BUFSIZE, tmpval.data(), tmpidx.data(), INTEGRAL_CUTOFF)) != 0)
                                 {
                                     eri->ints.insert(eri->ints.end(), tmpval.data(), tmpval.data()+n);
                                     eri->idxs.insert(eri->idxs.end(), tmpidx.data(), tmpidx.data()+n);
+                                    for (size_t i = 0;i < n;i++) max = std::max(max, aquarius::abs(tmpval[i]));
+                                }
+
+                                if (eri->ints.size() > start)
+                                {
+                                    eri->blocks.emplace_back(a, b, c, d, start, eri->ints.size()-start, max);
                                 }
                             }
                             abcd++;
@@ -12,6 +12,20 @@ namespace aquarius
 namespace integrals
 {
 
+/*
+ * An external (e.g. MM) point charge; unlike a Center, every charge is listed
+ * explicitly rather than only the symmetry-unique ones
+ */
+struct PointCharge
+{
+    double charge;
+    vec3 pos;
+
+    PointCharge() : charge(0) {}
+
+    PointCharge(double charge, const vec3& pos) : charge(charge), pos(pos) {}
+};
+
 class Center
 {
     protected:
@@ -1,5 +1,7 @@
 #include "cholesky.hpp"
 
+#include "os.hpp"
+
 using namespace aquarius::tensor;
 using namespace aquarius::input;
 using namespace aquarius::task;
@@ -55,7 +57,7 @@ void CholeskyIntegrals<T>::test()
                     int nk = shells[k].getNFunc()*shells[k].getNContr();
                     int nl = shells[l].getNFunc()*shells[l].getNContr();
 
-                    DenseTensor<T> local_ints("tmp", 4, {ni,nj,nk,nl});
+                    LocalTensor<T> local_ints("tmp", 4, {ni,nj,nk,nl});
 
                     vector<tkv_pair<T>> pairs(ni*nj*nk*nl);
 
@@ -155,7 +157,7 @@ void CholeskyIntegrals<T>::decompose()
         fill(block_data[block], block_data[block]+block_size[block]*ndiag, 0.0);
     }
 
-    arena.Allreduce(&max_block_size, 1, MPI_MAX);
+    arena.comm().Allreduce(&max_block_size, 1, MPI_MAX);
 
     //for (l = 0;l < ndiag;l++)
     //{
@@ -185,11 +187,12 @@ void CholeskyIntegrals<T>::decompose()
         //printf("max block: %d\n", max_block);
         //printf("max elem: %e\n", local_max);
 
-        arena.Allreduce(&converged, 1, MPI_BAND);
+        arena.comm().Allreduce(&converged, 1, MPI_BAND);
         if (converged) break;
 
         vector<T> maxes(arena.size);
-        arena.Allgather(&local_max, maxes);
+        maxes[arena.rank] = local_max;
+        arena.comm().Allgather(maxes);
 
         int pmax = 0;
         T global_max = 0;
@@ -215,13 +218,13 @@ void CholeskyIntegrals<T>::decompose()
                                         tmp_block_data, tmp_diag);
         }
 
-        arena.Bcast(&nvec, 1, pmax);
+        arena.comm().Bcast(&nvec, 1, pmax);
         if (nvec == old_rank) continue;
 
-        arena.Bcast(&nactive, 1, pmax);
-        arena.Bcast(tmp_block_data, nactive*ndiag, pmax);
-        arena.Bcast(tmp_diag, nactive*sizeof(diag_elem_t), pmax, MPI_BYTE);
-        arena.Bcast(D+old_rank, nvec-old_rank, pmax);
+        arena.comm().Bcast(&nactive, 1, pmax);
+        arena.comm().Bcast(tmp_block_data, nactive*ndiag, pmax);
+        arena.comm().Bcast((char*)tmp_diag, nactive*sizeof(diag_elem_t), pmax);
+        arena.comm().Bcast(D+old_rank, nvec-old_rank, pmax);
 
         for (int next_block = 0;next_block < nblock_local;next_block++)
         {
@@ -244,8 +247,8 @@ void CholeskyIntegrals<T>::decompose()
 
     const PointGroup& group = molecule.getGroup();
 
-    this->D = new SymmetryBlockedTensor<T>("D", this->arena, group, 1, {{nvec}}, {NS}, false);
-    this->L = new SymmetryBlockedTensor<T>("L", this->arena, group, 3, {{nfunc},{nfunc},{nvec}}, {SY,NS,NS}, false);
+    this->D.reset(new SymmetryBlockedTensor<T>("D", this->arena, group, 1, {{nvec}}, {NS}, false));
+    this->L.reset(new SymmetryBlockedTensor<T>("L", this->arena, group, 3, {{nfunc},{nfunc},{nvec}}, {SY,NS,NS}, false));
 
     if (arena.rank == 0)
     {
@@ -288,15 +291,15 @@ void CholeskyIntegrals<T>::decompose()
 
                         int o = shells[i].getIndex(ctx, idx[i], e, m, 0);
                         int p = shells[j].getIndex(ctx, idx[j], f, n, 0);
-                        //key idx = max(o,p)*(max(o,p)+1)/2 + min(o,p);
-                        key idx = max(o,p)*nfunc + min(o,p);
+                        //int64_t k = max(o,p)*(max(o,p)+1)/2 + min(o,p);
+                        int64_t k = max(o,p)*nfunc + min(o,p);
                         //printf("%d %d %d %d\n", i, j, shells[i].getIdx()[0], shells[j].getIdx()[0]);
                         for (int r = 0;r < nvec;r++)
                         {
                             //printf("%d %d %d %d %d %d %d %d %d %d\n", rank, idx, o, p, i, j, m, n, r, block);
-                            pairs.push_back(tkv_pair<T>(idx, block_data[block][elem*nvec+r]));
-                            //idx += ndiag;
-                            idx += nfunc*nfunc;
+                            pairs.push_back(tkv_pair<T>(k, block_data[block][elem*nvec+r]));
+                            //k += ndiag;
+                            k += nfunc*nfunc;
                         }
 
                         elem++;
@@ -328,10 +331,10 @@ void CholeskyIntegrals<T>::resortBlock(const int block_size, T* L, diag_elem_t*
 {
     for (int elem = 0;elem < block_size;elem++)
     {
-        dcopy(nvec, L+elem*ndiag, 1, tmp+diag[elem].idx*nvec, 1);
+        copy(nvec, L+elem*ndiag, 1, tmp+diag[elem].idx*nvec, 1);
     }
 
-    dcopy(nvec*block_size, tmp, 1, L, 1);
+    copy(nvec*block_size, tmp, 1, L, 1);
 }
 
 template <typename T>
@@ -347,7 +350,7 @@ int CholeskyIntegrals<T>::collectActiveRows(const int block_size, const T* L, di
             //printf("finishing row: %d\n", elem);
             diag[elem].status = DONE;
             diag_active[cur] = diag[elem];
-            dcopy(nvec, L+elem*ndiag, 1, L_active+cur*ndiag, 1);
+            copy(nvec, L+elem*ndiag, 1, L_active+cur*ndiag, 1);
             cur++;
         }
     }
@@ -420,7 +423,6 @@ void CholeskyIntegrals<T>::getShellOffsets(
     size_t ncab = a.getNContr()*b.getNContr();
     size_t nccd = c.getNContr()*d.getNContr();
     size_t nfab = a.getNFunc()*b.getNFunc();
-    size_t nfcd = c.getNFunc()*d.getNFunc();
 
     /*
     if (&context.getA() == &a || &context.getA() == &b)
@@ -494,11 +496,20 @@ void CholeskyIntegrals<T>::getShellOffsets(
     */
 }
 
+template <typename T>
+vector<T> CholeskyIntegrals<T>::aoBlock(const Shell& a, const Shell& b, const Shell& c, const Shell& d)
+{
+    OSERI eri(a, b, c, d);
+    vector<double> ints = eri.ao(a.getCenter().getCenter(0), b.getCenter().getCenter(0),
+                                 c.getCenter().getCenter(0), d.getCenter().getCenter(0));
+    return vector<T>(ints.begin(), ints.end());
+}
+
 template <typename T>
 int CholeskyIntegrals<T>::getDiagonalBlock(const Shell& a, const Shell& b, diag_elem_t* diag)
 {
-    TwoElectronIntegrals eri(a, b, a, b, ERIEvaluator());
-    const T* intbuf = eri.getIntegrals();
+    vector<T> ints = aoBlock(a, b, a, b);
+    const T* intbuf = ints.data();
 
     size_t controffi;
     size_t funcoffi;
@@ -561,9 +572,9 @@ void CholeskyIntegrals<T>::decomposeBlock(int block_size, T* L_, T* D, diag_elem
 
     if (!found) return;
 
-    TwoElectronIntegrals eri(shells[diag[0].shelli], shells[diag[0].shellj],
-                             shells[diag[0].shelli], shells[diag[0].shellj], ERIEvaluator());
-    const T* intbuf = eri.getIntegrals();
+    vector<T> ints = aoBlock(shells[diag[0].shelli], shells[diag[0].shellj],
+                             shells[diag[0].shelli], shells[diag[0].shellj]);
+    const T* intbuf = ints.data();
 
     size_t controffi;
     size_t funcoffi;
@@ -627,9 +638,9 @@ void CholeskyIntegrals<T>::updateBlock(int old_rank, int block_size_i, T* L_i_,
 
     //printf("subblock: %d %d\n", l, diag[l].nblock);
 
-    TwoElectronIntegrals eri(shells[diag_j[0].shelli], shells[diag_j[0].shellj],
-                             shells[diag_i[0].shelli], shells[diag_i[0].shellj], ERIEvaluator());
-    const T* intbuf = eri.getIntegrals();
+    vector<T> ints = aoBlock(shells[diag_j[0].shelli], shells[diag_j[0].shellj],
+                             shells[diag_i[0].shelli], shells[diag_i[0].shellj]);
+    const T* intbuf = ints.data();
 
     size_t controffii;
     size_t funcoffii;
@@ -669,15 +680,12 @@ void CholeskyIntegrals<T>::updateBlock(int old_rank, int block_size_i, T* L_i_,
 }
 
 template <typename T>
-T CholeskyIntegrals<T>::testBlock(const DenseTensor<T>& block, const Shell& a, const Shell& b, const Shell& c, const Shell& d)
+T CholeskyIntegrals<T>::testBlock(const LocalTensor<T>& block, const Shell& a, const Shell& b, const Shell& c, const Shell& d)
 {
-    DenseTensor<T> packed("tmp", 4, block.getLengths(), false);
-    const T* ints = packed.getData();
-
-    packed = block;
+    const T* ints = block.getData();
 
-    TwoElectronIntegrals eri(a, b, c, d, ERIEvaluator());
-    const T* intbuf = eri.getIntegrals();
+    vector<T> aoints = aoBlock(a, b, c, d);
+    const T* intbuf = aoints.data();
 
     size_t controffa;
     size_t funcoffa;
@@ -750,7 +758,44 @@ T CholeskyIntegrals<T>::testBlock(const DenseTensor<T>& block, const Shell& a, c
     return err;
 }
 
+template <typename T>
+CholeskyIntegralsTask<T>::CholeskyIntegralsTask(const string& name, Config& config)
+: Task(name, config)
+{
+    vector<Requirement> reqs;
+    reqs.push_back(Requirement("molecule", "molecule"));
+    addProduct(Product("cholesky", "cholesky", reqs));
+}
+
+template <typename T>
+bool CholeskyIntegralsTask<T>::run(TaskDAG& dag, const Arena& arena)
+{
+    const auto& molecule = this->template get<Molecule>("molecule");
+
+    if (molecule.getGroup().getOrder() != 1)
+    {
+        error(arena) << "Cholesky integrals are only implemented without symmetry" << endl;
+        return false;
+    }
+
+    this->put("cholesky", new CholeskyIntegrals<T>(arena, Context(), this->getConfig(), molecule));
+
+    return true;
+}
+
 INSTANTIATE_SPECIALIZATIONS(CholeskyIntegrals);
+INSTANTIATE_SPECIALIZATIONS(CholeskyIntegralsTask);
 
 }
 }
+
+static const char* spec = R"(
+
+delta?
+    double 1e-8,
+cond_max?
+    double 1e8
+
+)";
+
+REGISTER_TASK(aquarius::integrals::CholeskyIntegralsTask<double>,"cholesky",spec);
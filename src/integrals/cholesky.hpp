@@ -4,7 +4,7 @@
 #include "util/global.hpp"
 
 #include "tensor/symblocked_tensor.hpp"
-#include "tensor/dense_tensor.hpp"
+#include "tensor/local_tensor.hpp"
 #include "input/molecule.hpp"
 #include "input/config.hpp"
 #include "task/task.hpp"
@@ -17,7 +17,7 @@ namespace integrals
 {
 
 template <typename T>
-class CholeskyIntegrals : public Distributed
+class CholeskyIntegrals : public task::Destructible, public Distributed
 {
     public:
         const input::Molecule& molecule;
@@ -42,7 +42,7 @@ class CholeskyIntegrals : public Distributed
             }
         };
 
-        const Context& ctx;
+        Context ctx;
         int nvec;
         vector<Shell> shells;
         T delta;
@@ -81,6 +81,12 @@ class CholeskyIntegrals : public Distributed
                              size_t& controffa, size_t& funcoffa, size_t& controffb, size_t& funcoffb,
                              size_t& controffc, size_t& funcoffc, size_t& controffd, size_t& funcoffd);
 
+        /*
+         * AO integrals of a shell quartet, with the contractions running
+         * fastest and then the functions (see getShellOffsets)
+         */
+        vector<T> aoBlock(const Shell& a, const Shell& b, const Shell& c, const Shell& d);
+
         int getDiagonalBlock(const Shell& a, const Shell& b, diag_elem_t* diag);
 
         /*
@@ -115,10 +121,24 @@ class CholeskyIntegrals : public Distributed
         void updateBlock(int old_rank, int block_size_i, T* L_i_, diag_elem_t* diag_i,
                          int block_size_j, T* L_j_, diag_elem_t* diag_j, T* D);
 
-        T testBlock(const tensor::DenseTensor<T>& block, const Shell& a, const Shell& b,
+        T testBlock(const tensor::LocalTensor<T>& block, const Shell& a, const Shell& b,
                                                          const Shell& c, const Shell& d);
 };
 
+/*
+ * Decompose the AO two-electron integrals as (pq|rs) = L[pqJ] D[J] L[rsJ]
+ * for the Cholesky-based SCF (localcholeskyscf) and MO integrals
+ * (choleskymoints). The decomposition is done without symmetry.
+ */
+template <typename T>
+class CholeskyIntegralsTask : public task::Task
+{
+    public:
+        CholeskyIntegralsTask(const string& name, input::Config& config);
+
+        bool run(task::TaskDAG& dag, const Arena& arena);
+};
+
 }
 }
 
@@ -1,154 +1,190 @@
 #include "moments.hpp"
 
+using namespace aquarius::symmetry;
+
 namespace aquarius
 {
 namespace integrals
 {
 
-/*
- * Calculate moment integrals with the algorithm of Obara and Saika
- *  S. Obara; A. Saika, J. Chem. Phys. 84, 3963 (1986)
- */
-void OSMoments::prim(const vec3& posa, int e,
-                     const vec3& posb, int f, double* integrals)
+vector<int> OSMoments::operatorIrreps(const PointGroup& group, int Lmax)
 {
-    constexpr double PI_32 = 5.5683279968317078452848179821188;
-
-    double zp = za[e] + zb[f];
-    double A0 = PI_32*exp(-za[e]*zb[f]*norm2(posa-posb)/zp)/pow(zp, 1.5);
-
-    vec3 posp = (posa*za[e] + posb*zb[f])/zp;
-
-    vec3 afac = posp - posa;
-    vec3 bfac = posp - posb;
-    vec3 cfac = posp - posc;
-    double sfac = 1.0/(2*zp);
-
-    marray<double,3> table(la+1, lb+1, lc+1);
-    table[0][0][0] = A0;
-
-    marray_view<double,3> integral((la+1)*(la+2)/2, (lb+1)*(lb+2)/2, (lc+1)*(lc+2)/2, integrals);
+    vector<int> irreps(operatorIndex(Lmax+1,0,0), 0);
 
-    // fill table with x
-    filltable(afac[0], bfac[0], cfac[0], sfac, table);
-
-    // loop over all possible distributions of x momenta
-    for (int cx = lc;cx >= 0;cx--)
+    for (int L = 1;L <= Lmax;L++)
     {
-        for (int bx = lb;bx >= 0;bx--)
+        for (int x = L;x >= 0;x--)
         {
-            for (int ax = la;ax >= 0;ax--)
+            for (int y = L-x;y >= 0;y--)
             {
-                // and fill remainder with y from that point
-                filltable(afac[1], bfac[1], cfac[1], sfac,
-                          table[range(ax,la+1)][range(bx,lb+1)][range(cx,lc+1)]);
+                int z = L-x-y;
 
-                // loop over all possible distirubtions of y momenta given x
-                for (int cy = lc-cx;cy >= 0;cy--)
+                /*
+                 * The multipole transforms like the Cartesian function
+                 * x^x y^y z^z
+                 */
+                for (int irrep = 0;irrep < group.getNumIrreps();irrep++)
                 {
-                    for (int by = lb-bx;by >= 0;by--)
+                    bool match = true;
+                    for (int op = 0;op < group.getOrder();op++)
                     {
-                        for (int ay = la-ax;ay >= 0;ay--)
-                        {
-                            int az = la-ax-ay;
-                            int bz = lb-bx-by;
-                            int cz = lc-cx-cy;
-
-                            // and fill remainder with z from that point
-                            filltable(afac[2], bfac[2], cfac[2], sfac,
-                                      table[range(ax+ay,la+1)][range(bx+by,lb+1)][range(cx+cy,lc+1)]);
+                        if (group.character(irrep, op)*group.cartesianParity(x, y, z, op) < 0) match = false;
+                    }
 
-                            integral[XYZ(ax,ay,az)][XYZ(bx,by,bz)][XYZ(cx,cy,cz)] = table[la][lb][lc];
-                        }
+                    if (match)
+                    {
+                        irreps[operatorIndex(x,y,z)] = irrep;
+                        break;
                     }
                 }
             }
         }
     }
+
+    return irreps;
 }
 
-void OSMoments::filltable(double afac, double bfac, double cfac, double sfac,
-                          marray_view<double,3>&& table)
+void OSMoments::prim(const vec3& posa, int e,
+                     const vec3& posb, int f, double* restrict integrals)
 {
-    int la = table.length(0)-1;
-    int lb = table.length(1)-1;
-    int lc = table.length(2)-1;
+    constexpr double PI_32 = 5.5683279968317078452848179821188; // pi^(3/2)
 
-    table[0][0][1] = cfac*table[0][0][0];
-    table[0][1][0] = bfac*table[0][0][0];
-    table[1][0][0] = afac*table[0][0][0];
+    /*
+     * The kinetic energy integrals need one extra quantum on each center and
+     * the multipole integrals need up to Lmax extra on b
+     */
+    int lbmax = lb+max(Lmax,1);
 
-    for (int c = 1;c < lc;c++)
-    {
-        table[0][0][c+1] =   cfac*table[0][0][  c] +
-                           c*sfac*table[0][0][c-1];
-    }
+    marray<double,3> stable(3, lbmax+1, la+2);
+    marray<double,3> ttable(3, lb+1, la+1);
+    marray<double,4> mtable(3, Lmax+1, lb+1, la+1);
 
-    for (int b = 1;b < lb;b++)
-    {
-        table[0][b+1][0] =   bfac*table[0][  b][0] +
-                           b*sfac*table[0][b-1][0];
-    }
+    double zp = za[e] + zb[f];
+    double A0 = PI_32*exp(-za[e]*zb[f]*norm2(posa-posb)/zp)/pow(zp,1.5);
 
-    for (int a = 1;a < la;a++)
-    {
-        table[a+1][0][0] =   afac*table[  a][0][0] +
-                           a*sfac*table[a-1][0][0];
-    }
+    vec3 posp = (posa*za[e]+posb*zb[f])/zp;
+    vec3 afac = posp-posa;
+    vec3 bfac = posp-posb;
+    vec3 cfac = posb-posc;
+    double gfac = 0.5/zp;
 
-    for (int b = 1;b <= lb;b++)
+    for (int xyz = 0;xyz < 3;xyz++)
     {
-        table[1][b][0] =   afac*table[0][  b][0] +
-                         b*sfac*table[0][b-1][0];
+        stable[xyz][0][0] = 1.0;
+        stable[xyz][0][1] = afac[xyz];
 
-        for (int a = 1;a < la;a++)
+        for (int a = 1;a <= la;a++)
         {
-            table[a+1][b][0] =   afac*table[  a][  b][0] +
-                               a*sfac*table[a-1][  b][0] +
-                               b*sfac*table[  a][b-1][0];
+            stable[xyz][0][a+1] =   afac[xyz]*stable[xyz][0][  a] +
+                                  a*gfac     *stable[xyz][0][a-1];
         }
-    }
 
-    for (int c = 1;c <= lc;c++)
-    {
-        table[0][1][c] =   bfac*table[0][0][  c] +
-                         c*sfac*table[0][0][c-1];
+        for (int b = 0;b < lbmax;b++)
+        {
+            stable[xyz][b+1][0] = bfac[xyz]*stable[xyz][b][0];
+            if (b > 0) stable[xyz][b+1][0] += b*gfac*stable[xyz][b-1][0];
+
+            for (int a = 1;a <= la+1;a++)
+            {
+                stable[xyz][b+1][a] =   bfac[xyz]*stable[xyz][b][  a] +
+                                      a*gfac     *stable[xyz][b][a-1];
+                if (b > 0) stable[xyz][b+1][a] += b*gfac*stable[xyz][b-1][a];
+            }
+        }
 
-        for (int b = 1;b < lb;b++)
+        for (int b = 0;b <= lb;b++)
         {
-            table[0][b+1][c] =   bfac*table[0][  b][  c] +
-                               b*sfac*table[0][b-1][  c] +
-                               c*sfac*table[0][  b][c-1];
+            for (int a = 0;a <= la;a++)
+            {
+                double t = 2*za[e]*zb[f]*stable[xyz][b+1][a+1];
+                if (a > 0)          t -=     a*zb[f]*stable[xyz][b+1][a-1];
+                if (b > 0)          t -= za[e]*    b*stable[xyz][b-1][a+1];
+                if (a > 0 && b > 0) t +=     a*    b*stable[xyz][b-1][a-1]/2;
+                ttable[xyz][b][a] = t;
+            }
+        }
+
+        /*
+         * (x-Cx)^c = sum_k binom(c,k) (Bx-Cx)^(c-k) (x-Bx)^k
+         */
+        for (int c = 0;c <= Lmax;c++)
+        {
+            for (int b = 0;b <= lb;b++)
+            {
+                for (int a = 0;a <= la;a++)
+                {
+                    double m = 0;
+                    double binom = 1;
+                    for (int k = 0;k <= c;k++)
+                    {
+                        m += binom*pow(cfac[xyz],c-k)*stable[xyz][b+k][a];
+                        binom = binom*(c-k)/(k+1);
+                    }
+                    mtable[xyz][c][b][a] = m;
+                }
+            }
         }
     }
 
-    for (int c = 1;c <= lc;c++)
+    for (int b = 0;b <= lb;b++)
     {
-        table[1][0][c] =   afac*table[0][0][  c] +
-                         c*sfac*table[0][0][c-1];
-
-        for (int a = 1;a < la;a++)
+        for (int a = 0;a <= la;a++)
         {
-            table[a+1][0][c] =   afac*table[  a][0][  c] +
-                               a*sfac*table[a-1][0][  c] +
-                               c*sfac*table[  a][0][c-1];
+            stable[0][b][a] *= A0;
+            ttable[0][b][a] *= A0;
+            for (int c = 0;c <= Lmax;c++) mtable[0][c][b][a] *= A0;
         }
     }
 
-    for (int c = 1;c <= lc;c++)
+    int nab = fca*fcb;
+
+    for (int bx = lb;bx >= 0;bx--)
     {
-        for (int b = 1;b <= lb;b++)
+        for (int by = lb-bx;by >= 0;by--)
         {
-            table[1][b][c] =   afac*table[0][  b][  c] +
-                             b*sfac*table[0][b-1][  c] +
-                             c*sfac*table[0][  b][c-1];
+            int bz = lb-bx-by;
+            for (int ax = la;ax >= 0;ax--)
+            {
+                for (int ay = la-ax;ay >= 0;ay--)
+                {
+                    int az = la-ax-ay;
+                    int ab = XYZ(bx,by,bz)*fca+XYZ(ax,ay,az);
 
-            for (int a = 1;a < la;a++)
+                    integrals[ab] = stable[0][bx][ax]*stable[1][by][ay]*stable[2][bz][az];
+
+                    integrals[nab+ab] = ttable[0][bx][ax]*stable[1][by][ay]*stable[2][bz][az] +
+                                        stable[0][bx][ax]*ttable[1][by][ay]*stable[2][bz][az] +
+                                        stable[0][bx][ax]*stable[1][by][ay]*ttable[2][bz][az];
+                }
+            }
+        }
+    }
+
+    for (int L = 1;L <= Lmax;L++)
+    {
+        for (int cx = L;cx >= 0;cx--)
+        {
+            for (int cy = L-cx;cy >= 0;cy--)
             {
-                table[a+1][b][c] =   afac*table[  a][  b][  c] +
-                                   a*sfac*table[a-1][  b][  c] +
-                                   b*sfac*table[  a][b-1][  c] +
-                                   c*sfac*table[  a][  b][c-1];
+                int cz = L-cx-cy;
+                double* restrict integral = integrals+operatorIndex(cx,cy,cz)*nab;
+
+                for (int bx = lb;bx >= 0;bx--)
+                {
+                    for (int by = lb-bx;by >= 0;by--)
+                    {
+                        int bz = lb-bx-by;
+                        for (int ax = la;ax >= 0;ax--)
+                        {
+                            for (int ay = la-ax;ay >= 0;ay--)
+                            {
+                                int az = la-ax-ay;
+                                integral[XYZ(bx,by,bz)*fca+XYZ(ax,ay,az)] =
+                                    mtable[0][cx][bx][ax]*mtable[1][cy][by][ay]*mtable[2][cz][bz][az];
+                            }
+                        }
+                    }
+                }
             }
         }
     }
@@ -3,30 +3,48 @@
 
 #include "util/global.hpp"
 
-#include "shell.hpp"
+#include "1eints.hpp"
 
 namespace aquarius
 {
 namespace integrals
 {
 
+/*
+ * Calculate overlap, kinetic energy, and Cartesian multipole integrals (up to
+ * order Lmax, about posc) together, from a single Obara-Saika overlap table
+ * per primitive pair
+ *  S. Obara; A. Saika, J. Chem. Phys. 84, 3963 (1986)
+ *
+ * The operators are S, T, and then the multipoles in order of increasing L,
+ * and within each L in the usual ordering of Cartesian functions. The
+ * origin posc must be invariant under the point group.
+ */
 class OSMoments : public OneElectronIntegrals
 {
     protected:
-        int lc;
+        int Lmax;
         vec3 posc;
 
-        void filltable(double afac, double bfac, double cfac, double sfac,
-                       marray_view<double,3>&& table);
-
     public:
-        /*
-         * Calculate moment integrals with the algorithm of Obara and Saika
-         *  S. Obara; A. Saika, J. Chem. Phys. 84, 3963 (1986)
-         */
+        OSMoments(const Shell& a, const Shell& b, int Lmax = 0, const vec3& posc = vec3())
+        : OneElectronIntegrals(a, b, operatorIrreps(a.getCenter().getPointGroup(), Lmax)),
+          Lmax(Lmax), posc(posc) {}
+
+        static int operatorIndex(int x, int y, int z)
+        {
+            int L = x+y+z;
+            if (L == 0) return 0;
+            return 1+L*(L+1)*(L+2)/6+XYZ(x,y,z);
+        }
+
+        static vector<int> operatorIrreps(const symmetry::PointGroup& group, int Lmax);
+
         void prim(const vec3& posa, int e,
                   const vec3& posb, int f, double* integrals);
 };
 
 }
 }
+
+#endif
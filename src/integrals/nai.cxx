@@ -16,63 +16,82 @@ void IshidaNAI::prim(const vec3& posa, int e,
                      const vec3& posb, int f, double* restrict integrals)
 {
     Fm fm;
+    marray<double,3> gtable(lb+1, la+1, la+lb+1);
 
+    for (auto& charge : charges)
+    {
+        attraction(posa, e, posb, f, charge, fm, gtable, integrals);
+    }
+}
+
+void IshidaNAI::attraction(const vec3& posa, int e,
+                           const vec3& posb, int f, const PointCharge& charge,
+                           Fm& fm, marray<double,3>& gtable, double* restrict integrals)
+{
     int vmax = la+lb;
 
     double zp = za[e] + zb[f];
     vec3 posp = (posa*za[e]+posb*zb[f])/zp;
 
-    marray<double,3> gtable(lb+1, la+1, vmax+1);
     matrix_view<double> integral((lb+1)*(lb+2)/2, (la+1)*(la+2)/2, integrals);
 
-    for (auto& center : centers)
-    {
-        double charge = center.getElement().getCharge();
+    vec3 afac = posp-posa;
+    vec3 bfac = posp-posb;
+    vec3 cfac = posp-charge.pos;
+    double sfac = 0.5/zp;
 
-        for (auto& posc : center.getCenters())
-        {
-            vec3 afac = posp-posa;
-            vec3 bfac = posp-posb;
-            vec3 cfac = posp-posc;
-            double sfac = 0.5/zp;
+    double A0 = -charge.charge*2*M_PI*exp(-za[e]*zb[f]*norm2(posa-posb)/zp)/zp;
+    double Z = norm2(posp-charge.pos)*zp;
 
-            double A0 = -charge*2*M_PI*exp(-za[e]*zb[f]*norm2(posa-posb)/zp)/zp;
-            double Z = norm2(posp-posc)*zp;
+    fm(Z, vmax, gtable[0][0].data());
+    for (int i = 0;i <= vmax;i++) gtable[0][0][i] *= A0;
 
-            fm(Z, vmax, gtable[0][0].data());
-            for (int i = 0;i <= vmax;i++) gtable[0][0][i] *= A0;
+    // fill table with x
+    filltable(afac[0], bfac[0], cfac[0], sfac, gtable);
 
-            // fill table with x
-            filltable(afac[0], bfac[0], cfac[0], sfac, gtable);
+    // loop over all possible distributions of x momenta
+    for (int bx = lb;bx >= 0;bx--)
+    {
+        for (int ax = la;ax >= 0;ax--)
+        {
+            // and fill remainder with y from that point
+            filltable(afac[1], bfac[1], cfac[1], sfac, gtable[range(bx,lb+1)][range(ax,la+1)]);
 
-            // loop over all possible distributions of x momenta
-            for (int bx = lb;bx >= 0;bx--)
+            // loop over all possible distributions of y momenta given x
+            for (int by = lb-bx;by >= 0;by--)
             {
-                for (int ax = la;ax >= 0;ax--)
+                for (int ay = la-ax;ay >= 0;ay--)
                 {
-                    // and fill remainder with y from that point
-                    filltable(afac[1], bfac[1], cfac[1], sfac, gtable[range(bx,lb+1)][range(ax,la+1)]);
+                    int az = la-ax-ay;
+                    int bz = lb-bx-by;
 
-                    // loop over all possible distributions of y momenta given x
-                    for (int by = lb-bx;by >= 0;by--)
-                    {
-                        for (int ay = la-ax;ay >= 0;ay--)
-                        {
-                            int az = la-ax-ay;
-                            int bz = lb-bx-by;
-
-                            // and fill remainder with z from that point
-                            filltable(afac[2], bfac[2], cfac[2], sfac, gtable[range(bx+by,lb+1)][range(ax+ay,la+1)]);
+                    // and fill remainder with z from that point
+                    filltable(afac[2], bfac[2], cfac[2], sfac, gtable[range(bx+by,lb+1)][range(ax+ay,la+1)]);
 
-                            integral[XYZ(bx,by,bz)][XYZ(ax,ay,az)] += gtable[lb][la][0];
-                        }
-                    }
+                    integral[XYZ(bx,by,bz)][XYZ(ax,ay,az)] += gtable[lb][la][0];
                 }
             }
         }
     }
 }
 
+vector<PointCharge> IshidaNAI::nuclearCharges(const vector<Center>& centers)
+{
+    vector<PointCharge> charges;
+
+    for (auto& center : centers)
+    {
+        double charge = center.getElement().getCharge();
+
+        for (auto& posc : center.getCenters())
+        {
+            charges.push_back(PointCharge(charge, posc));
+        }
+    }
+
+    return charges;
+}
+
 void IshidaNAI::filltable(double afac, double bfac, double cfac, double sfac, marray_view<double,3>& gtable)
 {
     int lb = gtable.length(0)-1;
@@ -147,5 +166,382 @@ void IshidaNAI::filltable(double afac, double bfac, double cfac, double sfac, ma
     }
 }
 
+PointChargeTree::PointChargeTree(const vector<PointCharge>& charges_, int order, double cutoff,
+                                 size_t leafsize)
+: order(order), cutoff(cutoff), charges(charges_)
+{
+    if (charges.empty()) return;
+
+    build(0, charges.size(), leafsize, 0);
+}
+
+int PointChargeTree::build(size_t begin, size_t end, size_t leafsize, int depth)
+{
+    int idx = nodes.size();
+    nodes.push_back(Node());
+
+    /*
+     * The box is the bounding box of the charges of this node (and not the
+     * octant of the parent), so that a node splits unless its charges all
+     * coincide
+     */
+    vec3 lo = charges[begin].pos;
+    vec3 hi = charges[begin].pos;
+
+    for (size_t i = begin;i < end;i++)
+    {
+        for (int xyz = 0;xyz < 3;xyz++)
+        {
+            lo[xyz] = min(lo[xyz], charges[i].pos[xyz]);
+            hi[xyz] = max(hi[xyz], charges[i].pos[xyz]);
+        }
+    }
+
+    vec3 center = (lo+hi)/2;
+    double radius = 0;
+
+    vector<double> moments(index(order,order,order)+1, 0.0);
+    vector<double> xn(order+1), yn(order+1), zn(order+1);
+
+    for (size_t i = begin;i < end;i++)
+    {
+        vec3 r = charges[i].pos-center;
+        radius = max(radius, norm(r));
+
+        xn[0] = yn[0] = zn[0] = 1;
+        for (int n = 1;n <= order;n++)
+        {
+            xn[n] = -xn[n-1]*r[0]/n;
+            yn[n] = -yn[n-1]*r[1]/n;
+            zn[n] = -zn[n-1]*r[2]/n;
+        }
+
+        for (int a = 0;a <= order;a++)
+        {
+            for (int b = 0;a+b <= order;b++)
+            {
+                for (int c = 0;a+b+c <= order;c++)
+                {
+                    moments[index(a,b,c)] += charges[i].charge*xn[a]*yn[b]*zn[c];
+                }
+            }
+        }
+    }
+
+    vector<int> children;
+
+    if (end-begin > leafsize && depth < 32)
+    {
+        /*
+         * Sort the charges by octant and build one child per non-empty octant
+         */
+        auto octant = [&center](const PointCharge& c)
+        {
+            return (c.pos[0] >= center[0] ? 1 : 0) +
+                   (c.pos[1] >= center[1] ? 2 : 0) +
+                   (c.pos[2] >= center[2] ? 4 : 0);
+        };
+
+        /*
+         * The charges are copied rather than sorted in place, since a vec3
+         * which has been moved from cannot be assigned to (which std::sort
+         * and std::stable_sort both do)
+         */
+        vector<PointCharge> sorted;
+        sorted.reserve(end-begin);
+        for (int oct = 0;oct < 8;oct++)
+        {
+            for (size_t i = begin;i < end;i++)
+            {
+                if (octant(charges[i]) == oct) sorted.push_back(charges[i]);
+            }
+        }
+        for (size_t i = begin;i < end;i++) charges[i] = sorted[i-begin];
+
+        size_t first = begin;
+        while (first < end)
+        {
+            int oct = octant(charges[first]);
+            size_t last = first;
+            while (last < end && octant(charges[last]) == oct) last++;
+
+            // all charges coincide, so this cannot be split further
+            if (first == begin && last == end) break;
+
+            children.push_back(build(first, last, leafsize, depth+1));
+            first = last;
+        }
+    }
+
+    Node& node = nodes[idx];
+    node.center = center;
+    node.radius = radius;
+    node.begin = begin;
+    node.end = end;
+    node.children = children;
+    node.moments = moments;
+
+    return idx;
+}
+
+void PointChargeTree::derivatives(const vec3& R, vector<double>& D) const
+{
+    int K = order;
+    int ncube = index(K,K,K)+1;
+
+    double R2 = norm2(R);
+    double Rinv = 1/sqrt(R2);
+
+    /*
+     * r[n*ncube+index(t,u,v)] = R^(n)_tuv, where
+     * R^(n)_000 = (1/R d/dR)^n 1/R = (-1)^n (2n-1)!! / R^(2n+1)
+     */
+    vector<double> r((K+1)*ncube);
+
+    double fac = Rinv;
+    for (int n = 0;n <= K;n++)
+    {
+        r[n*ncube] = fac;
+        fac *= -(2*n+1)*Rinv*Rinv;
+    }
+
+    for (int t = 0;t < K;t++)
+    {
+        for (int n = 0;n < K-t;n++)
+        {
+            r[n*ncube+index(t+1,0,0)] = R[0]*r[(n+1)*ncube+index(t,0,0)];
+            if (t > 0) r[n*ncube+index(t+1,0,0)] += t*r[(n+1)*ncube+index(t-1,0,0)];
+        }
+    }
+
+    for (int u = 0;u < K;u++)
+    {
+        for (int t = 0;t+u < K;t++)
+        {
+            for (int n = 0;n < K-t-u;n++)
+            {
+                r[n*ncube+index(t,u+1,0)] = R[1]*r[(n+1)*ncube+index(t,u,0)];
+                if (u > 0) r[n*ncube+index(t,u+1,0)] += u*r[(n+1)*ncube+index(t,u-1,0)];
+            }
+        }
+    }
+
+    for (int v = 0;v < K;v++)
+    {
+        for (int t = 0;t+v < K;t++)
+        {
+            for (int u = 0;t+u+v < K;u++)
+            {
+                for (int n = 0;n < K-t-u-v;n++)
+                {
+                    r[n*ncube+index(t,u,v+1)] = R[2]*r[(n+1)*ncube+index(t,u,v)];
+                    if (v > 0) r[n*ncube+index(t,u,v+1)] += v*r[(n+1)*ncube+index(t,u,v-1)];
+                }
+            }
+        }
+    }
+
+    D.assign(r.begin(), r.begin()+ncube);
+}
+
+/*
+ * Classify the charges for this shell pair: a charge or a node of the tree
+ * is far if it lies outside of the extent of every primitive distribution
+ * (so that there is no penetration) and the multipole series about the
+ * center of the pair has converged to within the cutoff. The potential
+ * derivatives of all far charges are accumulated in phi.
+ */
+void MultipoleNAI::prims(const vec3& posa, const vec3& posb, double* integrals)
+{
+    int K = tree.getOrder();
+    double cutoff = tree.getCutoff();
+    const vector<PointChargeTree::Node>& nodes = tree.getNodes();
+
+    double zmin = *min_element(za.begin(), za.end()) +
+                  *min_element(zb.begin(), zb.end());
+
+    posp0 = (posa+posb)/2;
+    double rab = norm(posa-posb)/2;
+    double rext = rab + sqrt(-log(cutoff)/zmin);
+    double rmp = rab + sqrt((la+lb+1)/(2*zmin));
+
+    auto isFar = [&](double d, double radius)
+    {
+        return d-radius > rext && pow((rmp+radius)/d, K+1) < cutoff;
+    };
+
+    near.clear();
+    phi.assign(tree.index(K,K,K)+1, 0.0);
+    hasfar = false;
+
+    vector<double> D;
+    vector<int> stack;
+    if (!nodes.empty()) stack.push_back(0);
+
+    while (!stack.empty())
+    {
+        const PointChargeTree::Node& node = nodes[stack.back()];
+        stack.pop_back();
+
+        vec3 R = posp0-node.center;
+
+        if (isFar(norm(R), node.radius))
+        {
+            /*
+             * phi_tuv += sum_abc (-1)^(a+b+c) Q_abc/(a!b!c!) D_(t+a)(u+b)(v+c)
+             */
+            tree.derivatives(R, D);
+            hasfar = true;
+
+            for (int t = 0;t <= K;t++)
+            for (int u = 0;t+u <= K;u++)
+            for (int v = 0;t+u+v <= K;v++)
+            {
+                double& p = phi[tree.index(t,u,v)];
+
+                for (int a = 0;t+u+v+a <= K;a++)
+                for (int b = 0;t+u+v+a+b <= K;b++)
+                for (int c = 0;t+u+v+a+b+c <= K;c++)
+                {
+                    p += node.moments[tree.index(a,b,c)]*D[tree.index(t+a,u+b,v+c)];
+                }
+            }
+        }
+        else if (!node.children.empty())
+        {
+            for (int child : node.children) stack.push_back(child);
+        }
+        else
+        {
+            for (size_t i = node.begin;i < node.end;i++)
+            {
+                vec3 R = posp0-charges[i].pos;
+
+                if (isFar(norm(R), 0))
+                {
+                    tree.derivatives(R, D);
+                    hasfar = true;
+
+                    for (size_t tuv = 0;tuv < phi.size();tuv++)
+                        phi[tuv] += charges[i].charge*D[tuv];
+                }
+                else
+                {
+                    near.push_back(i);
+                }
+            }
+        }
+    }
+
+    /*
+     * Fold in the 1/(t!u!v!) of the Taylor series
+     */
+    for (int t = 0, ft = 1;t <= K;ft *= ++t)
+    for (int u = 0, fu = 1;t+u <= K;fu *= ++u)
+    for (int v = 0, fv = 1;t+u+v <= K;fv *= ++v)
+    {
+        phi[tree.index(t,u,v)] /= double(ft)*fu*fv;
+    }
+
+    OneElectronIntegrals::prims(posa, posb, integrals);
+}
+
+void MultipoleNAI::prim(const vec3& posa, int e,
+                        const vec3& posb, int f, double* restrict integrals)
+{
+    Fm fm;
+    marray<double,3> gtable(lb+1, la+1, la+lb+1);
+
+    for (int i : near)
+    {
+        attraction(posa, e, posb, f, charges[i], fm, gtable, integrals);
+    }
+
+    if (!hasfar) return;
+
+    int K = tree.getOrder();
+
+    double zp = za[e] + zb[f];
+    vec3 posp = (posa*za[e]+posb*zb[f])/zp;
+    double sfac = 0.5/zp;
+
+    matrix_view<double> integral((lb+1)*(lb+2)/2, (la+1)*(la+2)/2, integrals);
+
+    /*
+     * One-dimensional overlap moments <a|(x-P0)^t|b> by the Obara-Saika
+     * recursion; the Gaussian prefactor is put into the x table only
+     */
+    marray<double,4> stable(3, la+1, lb+1, K+1);
+
+    for (int xyz = 0;xyz < 3;xyz++)
+    {
+        double afac = posp[xyz]-posa[xyz];
+        double bfac = posp[xyz]-posb[xyz];
+        double cfac = posp[xyz]-posp0[xyz];
+        double ab = posa[xyz]-posb[xyz];
+
+        marray_view<double,3> s = stable[xyz];
+
+        s[0][0][0] = sqrt(M_PI/zp)*exp(-za[e]*zb[f]*ab*ab/zp);
+
+        for (int k = 0;k < K;k++)
+        {
+            s[0][0][k+1] = cfac*s[0][0][k];
+            if (k > 0) s[0][0][k+1] += k*sfac*s[0][0][k-1];
+        }
+
+        for (int j = 0;j < lb;j++)
+        {
+            for (int k = 0;k <= K;k++)
+            {
+                s[0][j+1][k] = bfac*s[0][j][k];
+                if (j > 0) s[0][j+1][k] += j*sfac*s[0][j-1][k];
+                if (k > 0) s[0][j+1][k] += k*sfac*s[0][j][k-1];
+            }
+        }
+
+        for (int i = 0;i < la;i++)
+        {
+            for (int j = 0;j <= lb;j++)
+            {
+                for (int k = 0;k <= K;k++)
+                {
+                    s[i+1][j][k] = afac*s[i][j][k];
+                    if (i > 0) s[i+1][j][k] += i*sfac*s[i-1][j][k];
+                    if (j > 0) s[i+1][j][k] += j*sfac*s[i][j-1][k];
+                    if (k > 0) s[i+1][j][k] += k*sfac*s[i][j][k-1];
+                }
+            }
+        }
+    }
+
+    for (int bx = lb;bx >= 0;bx--)
+    {
+        for (int ax = la;ax >= 0;ax--)
+        {
+            for (int by = lb-bx;by >= 0;by--)
+            {
+                for (int ay = la-ax;ay >= 0;ay--)
+                {
+                    int az = la-ax-ay;
+                    int bz = lb-bx-by;
+
+                    double v = 0;
+                    for (int t = 0;t <= K;t++)
+                    for (int u = 0;t+u <= K;u++)
+                    for (int w = 0;t+u+w <= K;w++)
+                    {
+                        v += stable[0][ax][bx][t]*
+                             stable[1][ay][by][u]*
+                             stable[2][az][bz][w]*phi[tree.index(t,u,w)];
+                    }
+
+                    integral[XYZ(bx,by,bz)][XYZ(ax,ay,az)] -= v;
+                }
+            }
+        }
+    }
+}
+
 }
 }
@@ -4,6 +4,7 @@
 #include "util/global.hpp"
 
 #include "1eints.hpp"
+#include "fmgamma.hpp"
 
 namespace aquarius
 {
@@ -14,11 +15,14 @@ namespace integrals
  * Calculate NAIs with the Rys Polynomial algorithm of Ishida
  *  K. Ishida, J. Chem. Phys. 95, 5198-205 (1991)
  *  Ishida, K., J. Chem. Phys., 98, 2176 (1993)
+ *
+ * The nuclei (one entry per symmetry-equivalent center) and any external
+ * point charges are given together as a flat list of charges.
  */
 class IshidaNAI : public OneElectronIntegrals
 {
     protected:
-        vector<Center> centers;
+        const vector<PointCharge>& charges;
 
         void filltable(double afac, double bfac, double cfac, double sfac, marray_view<double,3>&& gtable)
         {
@@ -27,9 +31,98 @@ class IshidaNAI : public OneElectronIntegrals
 
         void filltable(double afac, double bfac, double cfac, double sfac, marray_view<double,3>& gtable);
 
+        /*
+         * Add the attraction to a single charge; gtable must be
+         * (lb+1) x (la+1) x (la+lb+1)
+         */
+        void attraction(const vec3& posa, int e,
+                        const vec3& posb, int f, const PointCharge& charge,
+                        Fm& fm, marray<double,3>& gtable, double* integrals);
+
+    public:
+        IshidaNAI(const Shell& a, const Shell& b, const vector<PointCharge>& charges)
+        : OneElectronIntegrals(a, b), charges(charges) {}
+
+        static vector<PointCharge> nuclearCharges(const vector<Center>& centers);
+
+        void prim(const vec3& posa, int e,
+                  const vec3& posb, int f, double* integrals);
+};
+
+/*
+ * An octree over a (possibly very large) set of point charges, where each
+ * node carries the Cartesian multipoles of its charges up to the given
+ * order about the center of the node
+ */
+class PointChargeTree
+{
+    public:
+        struct Node
+        {
+            vec3 center;
+            double radius;
+            size_t begin, end;
+            vector<int> children;
+            /*
+             * (-1)^(a+b+c) Q_abc/(a!b!c!), indexed by
+             * PointChargeTree::index(a,b,c)
+             */
+            vector<double> moments;
+        };
+
+    protected:
+        int order;
+        double cutoff;
+        vector<PointCharge> charges;
+        vector<Node> nodes;
+
+        int build(size_t begin, size_t end, size_t leafsize, int depth);
+
     public:
-        IshidaNAI(const Shell& a, const Shell& b, const vector<Center>& centers)
-        : OneElectronIntegrals(a, b), centers(centers) {}
+        PointChargeTree(const vector<PointCharge>& charges, int order, double cutoff,
+                        size_t leafsize = 32);
+
+        int getOrder() const { return order; }
+
+        double getCutoff() const { return cutoff; }
+
+        const vector<PointCharge>& getCharges() const { return charges; }
+
+        const vector<Node>& getNodes() const { return nodes; }
+
+        int index(int a, int b, int c) const { return (a*(order+1)+b)*(order+1)+c; }
+
+        /*
+         * Derivatives d^(t+u+v)/dx^t dy^u dz^v of 1/|R|, for t+u+v <= order,
+         * with the recursion of McMurchie and Davidson
+         *  L. E. McMurchie and E. R. Davidson, J. Comput. Phys. 26, 218 (1978)
+         */
+        void derivatives(const vec3& R, vector<double>& D) const;
+};
+
+/*
+ * Nuclear attraction and external point charge integrals, where charges
+ * close to the shell pair are treated exactly (IshidaNAI) and the potential
+ * of distant charges (or whole nodes of the charge tree) is expanded in a
+ * Taylor series about the center of the shell pair and contracted with the
+ * Cartesian multipoles of each primitive distribution
+ */
+class MultipoleNAI : public IshidaNAI
+{
+    protected:
+        const PointChargeTree& tree;
+        vec3 posp0;
+        vector<int> near;
+        vector<double> phi;
+        bool hasfar;
+
+        void prims(const vec3& posa, const vec3& posb, double* integrals);
+
+    public:
+        typedef PointChargeTree Tree;
+
+        MultipoleNAI(const Shell& a, const Shell& b, const PointChargeTree& tree)
+        : IshidaNAI(a, b, tree.getCharges()), tree(tree) {}
 
         void prim(const vec3& posa, int e,
                   const vec3& posb, int f, double* integrals);
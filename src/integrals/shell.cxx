@@ -111,6 +111,19 @@ Shell::Shell(const Center& pos, int L, int nprim, int ncontr, bool spherical, bo
         }
     }
 
+    phases.resize(order, vector<double>(nfunc*ndegen));
+
+    for (int op = 0;op < order;op++)
+    {
+        for (int func = 0;func < nfunc;func++)
+        {
+            for (int j = 0;j < ndegen;j++)
+            {
+                phases[op][func*ndegen+j] = parity[func][op]*group.character(irreps[func][j], op);
+            }
+        }
+    }
+
     /*
      * Normalize the shell
      */
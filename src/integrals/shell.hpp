@@ -55,6 +55,7 @@ class Shell
         vector<double> exponents;
         vector<double> coefficients;
         vector<vector<int>> parity;
+        vector<vector<double>> phases;
         vector<double> cart2spher;
 
     public:
@@ -97,6 +98,13 @@ class Shell
 
         int getParity(int func, int op) const { return parity[func][op]; }
 
+        /*
+         * Phase of each SO function (at func*degeneracy+degen) under
+         * operation op, i.e. the parity of the function times the character
+         * of its irrep
+         */
+        const vector<double>& getPhases(int op) const { return phases[op]; }
+
         const vector<double>& getCart2Spher() const { return cart2spher; }
 
     protected:
@@ -0,0 +1,123 @@
+#include "util/global.hpp"
+
+#include "autocc/codegen.hpp"
+
+using namespace aquarius;
+using namespace aquarius::autocc;
+
+/*
+ * Read a residual from a file of the form
+ *
+ *   # comment
+ *   Z(ab,ij)
+ *   1/2 V(ab,ef) T(ef,ij)
+ *   V(am,ei) T(eb,mj)
+ *   ...
+ *
+ * where the first line gives the result and each following line a term
+ * (see Schedule::parseTerm), and write the generated function to stdout.
+ */
+int main(int argc, char **argv)
+{
+    string name = "residual";
+    string type = "double";
+    vector<double> len = {100, 10};
+    double memory = -1;
+    CodeGenerator::Style style = CodeGenerator::SPINCASES;
+    string file;
+
+    for (int i = 1;i < argc;i++)
+    {
+        string arg = argv[i];
+
+        if (arg == "-n" && i+1 < argc)
+        {
+            name = argv[++i];
+        }
+        else if (arg == "-t" && i+1 < argc)
+        {
+            type = argv[++i];
+        }
+        else if (arg == "-l" && i+2 < argc)
+        {
+            len[0] = atof(argv[++i]);
+            len[1] = atof(argv[++i]);
+        }
+        else if (arg == "-m" && i+1 < argc)
+        {
+            memory = atof(argv[++i]);
+        }
+        else if (arg == "-s")
+        {
+            style = CodeGenerator::SPINORBITAL;
+        }
+        else if (file.empty() && arg[0] != '-')
+        {
+            file = arg;
+        }
+        else
+        {
+            file.clear();
+            break;
+        }
+    }
+
+    if (file.empty())
+    {
+        cerr << "Usage: " << argv[0] << " [-n name] [-t type] [-l nvrt nocc] [-m words] [-s] file" << endl;
+        cerr << endl;
+        cerr << "  -n  name of the generated function (default residual)" << endl;
+        cerr << "  -t  element type (default double)" << endl;
+        cerr << "  -l  lengths of the virtual and occupied spaces used to order" << endl;
+        cerr << "      the contractions (default 100 10)" << endl;
+        cerr << "  -m  largest intermediate to form, in words" << endl;
+        cerr << "  -s  write spin-orbital expressions instead of spin cases" << endl;
+        return 1;
+    }
+
+    ifstream ifs(file);
+    if (!ifs)
+    {
+        cerr << "Could not open " << file << endl;
+        return 1;
+    }
+
+    try
+    {
+        string line;
+        string result;
+        vector<Term> terms;
+
+        while (getline(ifs, line))
+        {
+            line = line.substr(0, line.find('#'));
+            if (line.find_first_not_of(" \t") == string::npos) continue;
+
+            if (result.empty())
+            {
+                line.erase(remove_if(line.begin(), line.end(), ::isspace), line.end());
+                result = line;
+            }
+            else
+            {
+                terms.push_back(Schedule::parseTerm(line));
+            }
+        }
+
+        if (result.empty())
+        {
+            cerr << "No result given in " << file << endl;
+            return 1;
+        }
+
+        Schedule schedule(Schedule::parseFragment(result), Diagram(Diagram::SPINORBITAL, terms), len, memory);
+        CodeGenerator(schedule, name, type).write(cout, style);
+    }
+    catch (exception& e)
+    {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
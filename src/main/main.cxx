@@ -3,6 +3,7 @@
 #include "tensor/symblocked_tensor.hpp"
 #include "time/time.hpp"
 #include "task/task.hpp"
+#include "task/batch.hpp"
 
 #ifdef HAVE_LIBINT2
 #include "libint2.h"
@@ -25,9 +26,19 @@ int main(int argc, char **argv)
     printf("sdflkjsdf\n");
     #endif
 
+    /*
+     * -l runs the contractions of a single process with threads, so by
+     * default it gets the whole node; otherwise the cores are left to CTF
+     */
+    bool local = false;
+    for (int i = 1;i < argc;i++)
+    {
+        if (string(argv[i]) == "-l" || string(argv[i]) == "-L") local = true;
+    }
+
     if (getenv("OMP_NUM_THREADS") == NULL)
     {
-        omp_set_num_threads(1);
+        omp_set_num_threads(local ? omp_get_num_procs() : 1);
     }
 
     int status = 0;
@@ -141,15 +152,51 @@ int main(int argc, char **argv)
                    (world().size > 1 ? " each" : ""));
         }
 
-        if (argc < 2)
+        /*
+         * -b n runs each section of the input as a separate job on a group
+         * of n processes (see BatchDAG), and -l uses the node-local backend
+         * on single-process arenas (see Arena). -L does the same but also
+         * repeats each node-local contraction with CTF, as a check.
+         */
+        int group_size = 0;
+        string file;
+
+        for (int i = 1;i < argc;i++)
+        {
+            string arg = argv[i];
+
+            if (arg == "-b" && i+1 < argc)
+            {
+                group_size = atoi(argv[++i]);
+            }
+            else if (arg == "-l")
+            {
+                world().setBackend(Arena::LOCAL);
+            }
+            else if (arg == "-L")
+            {
+                world().setBackend(Arena::LOCAL_CHECKED);
+            }
+            else
+            {
+                file = arg;
+            }
+        }
+
+        if (file.empty())
         {
             Logger::error() << "No input file specified." << endl << endl;
         }
+        else if (group_size > 0)
+        {
+            BatchDAG batch(file, group_size);
+            batch.execute(world());
+        }
         else
         {
             //try
             //{
-                TaskDAG dag(argv[1]);
+                TaskDAG dag(file);
                 dag.execute(world());
             //}
             //catch (const runtime_error& e)
@@ -159,6 +206,15 @@ int main(int argc, char **argv)
             //}
         }
 
+        const auto& check = tensor::CTFTensor<double>::localCheck();
+        if (check.nop > 0)
+        {
+            Logger::log(world()) << "Node-local contractions checked against CTF: " << check.nop << endl;
+            Logger::log(world()) << "Largest difference: " << scientific << setprecision(3) << check.maxdiff << endl;
+            Logger::log(world()) << "Time (node-local, CTF): " << fixed << setprecision(3) <<
+                check.local_time << " s, " << check.ctf_time << " s" << endl;
+        }
+
         Timer::printTimers(world());
     }
 
@@ -47,11 +47,16 @@ class OneElectronOperatorBase : public MOOperator,
                                 const tensor::SymmetryBlockedTensor<T>& aoa,
                                 const tensor::SymmetryBlockedTensor<T>& aob)
         : MOOperator(occ.arena, occ, vrt), tensor::CompositeTensor<Derived,tensor::SpinorbitalTensor<T>,T>(name),
-          ab(this->addTensor(new tensor::SpinorbitalTensor<T>(name, occ.arena, occ.group, {vrt, occ}, {1,0}, {1,0}))),
-          ij(this->addTensor(new tensor::SpinorbitalTensor<T>(name, occ.arena, occ.group, {vrt, occ}, {0,1}, {0,1}))),
-          ai(this->addTensor(new tensor::SpinorbitalTensor<T>(name, occ.arena, occ.group, {vrt, occ}, {1,0}, {0,1}))),
-          ia(this->addTensor(new tensor::SpinorbitalTensor<T>(name, occ.arena, occ.group, {vrt, occ}, {0,1}, {1,0})))
+          ab(this->addTensor(new tensor::SpinorbitalTensor<T>(name, occ.arena, occ.group, aoa.getRepresentation(), {vrt, occ}, {1,0}, {1,0}))),
+          ij(this->addTensor(new tensor::SpinorbitalTensor<T>(name, occ.arena, occ.group, aoa.getRepresentation(), {vrt, occ}, {0,1}, {0,1}))),
+          ai(this->addTensor(new tensor::SpinorbitalTensor<T>(name, occ.arena, occ.group, aoa.getRepresentation(), {vrt, occ}, {1,0}, {0,1}))),
+          ia(this->addTensor(new tensor::SpinorbitalTensor<T>(name, occ.arena, occ.group, aoa.getRepresentation(), {vrt, occ}, {0,1}, {1,0})))
         {
+            /*
+             * The operator need not be totally symmetric (e.g. multipoles)
+             */
+            const symmetry::Representation& rep = aoa.getRepresentation();
+
             const tensor::SymmetryBlockedTensor<T>& cA = vrt.Calpha;
             const tensor::SymmetryBlockedTensor<T>& ca = vrt.Cbeta;
             const tensor::SymmetryBlockedTensor<T>& cI = occ.Calpha;
@@ -76,10 +81,10 @@ class OneElectronOperatorBase : public MOOperator,
 
             vector<int> shapeNN = {NS, NS};
 
-            tensor::SymmetryBlockedTensor<T> Aq("Aq", this->arena, occ.group, 2, sizeAN, shapeNN, false);
-            tensor::SymmetryBlockedTensor<T> aq("aq", this->arena, occ.group, 2, sizeaN, shapeNN, false);
-            tensor::SymmetryBlockedTensor<T> Iq("Iq", this->arena, occ.group, 2, sizeIN, shapeNN, false);
-            tensor::SymmetryBlockedTensor<T> iq("iq", this->arena, occ.group, 2, sizeiN, shapeNN, false);
+            tensor::SymmetryBlockedTensor<T> Aq("Aq", this->arena, occ.group, rep, 2, sizeAN, shapeNN, false);
+            tensor::SymmetryBlockedTensor<T> aq("aq", this->arena, occ.group, rep, 2, sizeaN, shapeNN, false);
+            tensor::SymmetryBlockedTensor<T> Iq("Iq", this->arena, occ.group, rep, 2, sizeIN, shapeNN, false);
+            tensor::SymmetryBlockedTensor<T> iq("iq", this->arena, occ.group, rep, 2, sizeiN, shapeNN, false);
 
             Aq["Aq"] = cA["pA"]*aoa["pq"];
             aq["aq"] = ca["pa"]*aob["pq"];
@@ -16,7 +16,7 @@ namespace op
 
 template <typename T>
 pqrs_integrals<T>::pqrs_integrals(const vector<int>& norb, const ERI& aoints)
-: Distributed(aoints.arena), group(aoints.group)
+: Distributed(aoints.arena), group(aoints.group), cutoff(1e-12)
 {
     PROFILE_FUNCTION
 
@@ -65,7 +65,7 @@ pqrs_integrals<T>::pqrs_integrals(const vector<int>& norb, const ERI& aoints)
 
 template <typename T>
 pqrs_integrals<T>::pqrs_integrals(abrs_integrals<T>& abrs)
-: Distributed(abrs.arena), group(abrs.group)
+: Distributed(abrs.arena), group(abrs.group), cutoff(1e-12)
 {
     PROFILE_FUNCTION
 
@@ -316,11 +316,12 @@ pqrs_integrals<T> pqrs_integrals<T>::transform(Index index, const vector<int>& n
                                                const vector<vector<T>>& C, bool pleq)
 {
     pqrs_integrals out(arena, group);
+    out.cutoff = cutoff;
+    out.stats = stats;
 
     int n = group.getNumIrreps();
     int nptot = sum(np);
     int nqtot = sum(nq);
-    int nctot = sum(nc);
 
     vector<int> startc(n);
     for (int i = 1;i < n;i++) startc[i] = startc[i-1]+nc[i-1];
@@ -330,6 +331,11 @@ pqrs_integrals<T> pqrs_integrals<T>::transform(Index index, const vector<int>& n
     vector<int> startq(n);
     for (int i = 1;i < n;i++) startq[i] = startq[i-1]+nq[i-1];
 
+    vector<int> irrepr;
+    for (int i = 0;i < n;i++) irrepr += vector<int>(nr[i],i);
+    vector<int> irreps;
+    for (int i = 0;i < n;i++) irreps += vector<int>(ns[i],i);
+
     out.nr = nr;
     out.ns = ns;
 
@@ -344,6 +350,29 @@ pqrs_integrals<T> pqrs_integrals<T>::transform(Index index, const vector<int>& n
         out.nq = nc;
     }
 
+    /*
+     * k is the index being transformed (p for index = A and q for index = B),
+     * and m the one carried along
+     */
+    const vector<int>& nk = (index == A ? np : nq);
+    const vector<int>& nm = (index == A ? nq : np);
+    const vector<int>& startk = (index == A ? startp : startq);
+    const vector<int>& startm = (index == A ? startq : startp);
+
+    vector<vector<double>> rownorm(n);
+    for (int irrepc = 0;irrepc < n;irrepc++)
+    {
+        rownorm[irrepc].assign(nk[irrepc], 0.0);
+        for (int c = 0;c < nc[irrepc];c++)
+        {
+            for (int k = 0;k < nk[irrepc];k++)
+            {
+                double v = aquarius::abs(C[irrepc][k+c*nk[irrepc]]);
+                rownorm[irrepc][k] += v*v;
+            }
+        }
+    }
+
     int r = -1;
     int s = -1;
 
@@ -351,17 +380,16 @@ pqrs_integrals<T> pqrs_integrals<T>::transform(Index index, const vector<int>& n
     auto iend = idxs.end();
     auto iidx = ibegin;
     auto iint = ints.begin();
+    auto iblock = ibegin;
 
-    matrix<double> before(nptot, nqtot), after;
+    matrix<double> before(nptot, nqtot);
+    vector<char> psig(nptot, 0), qsig(nqtot, 0);
+    const vector<char>& ksig = (index == A ? psig : qsig);
+    const vector<char>& msig = (index == A ? qsig : psig);
 
-    if (index == A)
-    {
-        after.reset(nctot, nqtot);
-    }
-    else
-    {
-        after.reset(nptot, nctot);
-    }
+    vector<int> K, M, J;
+    vector<char> csig;
+    vector<double> X, CK, R;
 
     while (true)
     {
@@ -369,73 +397,144 @@ pqrs_integrals<T> pqrs_integrals<T>::transform(Index index, const vector<int>& n
         {
             if (iidx != ibegin)
             {
-                int irrepr = 0;
-                for (int r_ = r;r_ > nr[irrepr];r_ -= nr[irrepr], irrepr++);
-
-                int irreps = 0;
-                for (int s_ = s;s_ > ns[irreps];s_ -= ns[irreps], irreps++);
-
                 for (int irrepc = 0;irrepc < n;irrepc++)
                 {
-                    if (index == A)
+                    int irrepk = irrepc;
+                    Representation rkrs = group.getIrrep(irrepk)*
+                                          group.getIrrep(irrepr[r])*
+                                          group.getIrrep(irreps[s]);
+
+                    for (int irrepm = 0;irrepm < n;irrepm++)
                     {
-                        int irrepp = irrepc;
-                        Representation rprs = group.getIrrep(irrepp)*
-                                              group.getIrrep(irrepr)*
-                                              group.getIrrep(irreps);
+                        if (!(group.getIrrep(irrepm)*rkrs).isTotallySymmetric()) continue;
+
+                        K.clear();
+                        for (int k = startk[irrepk];k < startk[irrepk]+nk[irrepk];k++)
+                            if (ksig[k]) K.push_back(k);
 
-                        for (int irrepq = 0;irrepq < n;irrepq++)
+                        M.clear();
+                        for (int m = startm[irrepm];m < startm[irrepm]+nm[irrepm];m++)
+                            if (msig[m]) M.push_back(m);
+
+                        if (stats)
                         {
-                            if (!(group.getIrrep(irrepq)*rprs).isTotallySymmetric()) continue;
+                            stats->nblock++;
+                            stats->nrow += nk[irrepk];
+                            stats->nrow_kept += K.size();
+                            stats->ndense += (size_t)nm[irrepm]*nc[irrepc];
+                        }
+
+                        int nK = K.size();
+                        int nM = M.size();
 
-                            gemm('N', 'N', nq[irrepq], nc[irrepc], np[irrepp],
-                                 1.0, &before[startp[irrepp]][startq[irrepq]], before.stride(0),
-                                                             C[irrepc].data(),       np[irrepp],
-                                 0.0,  &after[startc[irrepc]][startq[irrepq]],  after.stride(0));
+                        if (nK == 0 || nM == 0 || nc[irrepc] == 0)
+                        {
+                            if (stats) stats->nskipped++;
+                            continue;
+                        }
 
-                            for (int c = startc[irrepc];c < startc[irrepc]+nc[irrepc];c++)
+                        double xnorm = 0.0;
+                        X.resize(nM*nK);
+                        for (int k = 0;k < nK;k++)
+                        {
+                            for (int m = 0;m < nM;m++)
                             {
-                                for (int q = startq[irrepq];q < startq[irrepq]+nq[irrepq];q++)
+                                double v = (index == A ? before[K[k]][M[m]] : before[M[m]][K[k]]);
+                                X[m+k*nM] = v;
+                                xnorm += v*v;
+                            }
+                        }
+
+                        /*
+                         * Columns of C which are non-zero in some row of K
+                         */
+                        double cnorm = 0.0;
+                        csig.assign(nc[irrepc], 0);
+                        for (int k = 0;k < nK;k++)
+                        {
+                            int k_ = K[k]-startk[irrepk];
+                            cnorm += rownorm[irrepc][k_];
+                            for (int c = 0;c < nc[irrepc];c++)
+                                if (C[irrepc][k_+c*nk[irrepk]] != (T)0) csig[c] = 1;
+                        }
+
+                        J.clear();
+                        for (int c = 0;c < nc[irrepc];c++)
+                            if (csig[c]) J.push_back(c);
+
+                        int nJ = J.size();
+
+                        if (nJ == 0 || sqrt(xnorm*cnorm) < cutoff)
+                        {
+                            if (stats) stats->nskipped++;
+                            continue;
+                        }
+
+                        CK.resize(nK*nJ);
+                        for (int j = 0;j < nJ;j++)
+                        {
+                            for (int k = 0;k < nK;k++)
+                            {
+                                CK[k+j*nK] = C[irrepc][(K[k]-startk[irrepk])+J[j]*nk[irrepk]];
+                            }
+                        }
+
+                        R.resize(nM*nJ);
+                        gemm('N', 'N', nM, nJ, nK,
+                             1.0,  X.data(), nM,
+                                  CK.data(), nK,
+                             0.0,  R.data(), nM);
+
+                        size_t nnz = out.ints.size();
+
+                        if (index == A)
+                        {
+                            for (int j = 0;j < nJ;j++)
+                            {
+                                for (int m = 0;m < nM;m++)
                                 {
-                                    double val = after[c][q];
-                                    if (aquarius::abs(val) > 1e-12)
+                                    double val = R[m+j*nM];
+                                    if (aquarius::abs(val) > cutoff)
                                     {
-                                        out.idxs.emplace_back(c, q, r, s);
+                                        out.idxs.emplace_back(startc[irrepc]+J[j], M[m], r, s);
                                         out.ints.push_back(val);
                                     }
                                 }
                             }
                         }
-                    }
-                    else
-                    {
-                        int irrepq = irrepc;
-                        Representation rqrs = group.getIrrep(irrepq)*
-                                              group.getIrrep(irrepr)*
-                                              group.getIrrep(irreps);
-
-                        for (int irrepp = 0;irrepp < n;irrepp++)
+                        else
                         {
-                            if (!(group.getIrrep(irrepp)*rqrs).isTotallySymmetric()) continue;
-
-                            gemm('T', 'N', nc[irrepc], np[irrepp], nq[irrepq],
-                                 1.0,                        C[irrepc].data(),       nq[irrepq],
-                                      &before[startp[irrepp]][startq[irrepq]], before.stride(0),
-                                 0.0,  &after[startp[irrepp]][startc[irrepc]],  after.stride(0));
-
-                            for (int p = startp[irrepp];p < startp[irrepp]+np[irrepp];p++)
+                            for (int m = 0;m < nM;m++)
                             {
-                                for (int c = startc[irrepc];c < startc[irrepc]+nc[irrepc];c++)
+                                for (int j = 0;j < nJ;j++)
                                 {
-                                    double val = after[p][c];
-                                    if (aquarius::abs(val) > 1e-12)
+                                    double val = R[m+j*nM];
+                                    if (aquarius::abs(val) > cutoff)
                                     {
-                                        out.idxs.emplace_back(p, c, r, s);
+                                        out.idxs.emplace_back(M[m], startc[irrepc]+J[j], r, s);
                                         out.ints.push_back(val);
                                     }
                                 }
                             }
                         }
+
+                        if (stats) stats->nnz += out.ints.size()-nnz;
+                    }
+                }
+
+                /*
+                 * Clear only what this (rs) pair filled in
+                 */
+                for (auto jidx = iblock;jidx != iidx;++jidx)
+                {
+                    before[jidx->i][jidx->j] = 0.0;
+                    psig[jidx->i] = 0;
+                    qsig[jidx->j] = 0;
+                    if (pleq)
+                    {
+                        before[jidx->j][jidx->i] = 0.0;
+                        psig[jidx->j] = 0;
+                        qsig[jidx->i] = 0;
                     }
                 }
             }
@@ -448,13 +547,19 @@ pqrs_integrals<T> pqrs_integrals<T>::transform(Index index, const vector<int>& n
             {
                 r = iidx->k;
                 s = iidx->l;
-                before = 0.0;
+                iblock = iidx;
             }
         }
 
         before[iidx->i][iidx->j] = *iint;
+        psig[iidx->i] = 1;
+        qsig[iidx->j] = 1;
         if (pleq && iidx->i != iidx->j)
+        {
             before[iidx->j][iidx->i] = *iint;
+            psig[iidx->j] = 1;
+            qsig[iidx->i] = 1;
+        }
 
         ++iidx;
         ++iint;
@@ -511,9 +616,19 @@ void pqrs_integrals<T>::collect(bool rles)
     vector<T> newints(nnewints);
     vector<idx4_t> newidxs(nnewints);
 
+    /*
+     * The integrals and their indices are exchanged at the same time
+     */
     PROFILE_SECTION(collect_comm)
+#if MPIWRAP_HAVE_MPI_ICOLLECTIVES
+    vector<Request> reqs;
+    reqs.push_back(this->arena.comm().Ialltoall(ints, sendcount, newints, recvcount));
+    reqs.push_back(this->arena.comm().Ialltoall(idxs, sendcount, newidxs, recvcount, IDX4_T_TYPE));
+    waitAll(reqs);
+#else
     this->arena.comm().Alltoall(ints, sendcount, newints, recvcount);
     this->arena.comm().Alltoall(idxs, sendcount, newidxs, recvcount, IDX4_T_TYPE);
+#endif
     PROFILE_STOP
 
     swap(ints, newints);
@@ -1020,7 +1135,7 @@ bool AOMOIntegrals<T>::run(TaskDAG& dag, const Arena& arena)
     CTF_Timer_epoch ep("AOMOIntegrals");
     ep.begin();
     const auto& occ = this->template get<MOSpace<T>>("occ");
-    const auto& vrt = this->template get<MOSpace<T>>("vrt");
+    const auto& vrt = this->virtuals(arena);
 
     const auto& ints = this->template get<ERI>("I");
 
@@ -1076,20 +1191,18 @@ bool AOMOIntegrals<T>::run(TaskDAG& dag, const Arena& arena)
     vector<vector<T>> cA(n), ca(n), cI(n), ci(n);
 
     /*
-     * Read transformation coefficients
+     * Start reading transformation coefficients; the broadcast overlaps
+     * with resorting the AO integrals
      */
-    for (int i = 0;i < n;i++)
-    {
-        vector<int> irreps = {i,i};
-        cA_.getAllData(irreps, cA[i]);
-        assert(cA[i].size() == N[i]*nA[i]);
-        ca_.getAllData(irreps, ca[i]);
-        assert(ca[i].size() == N[i]*na[i]);
-        cI_.getAllData(irreps, cI[i]);
-        assert(cI[i].size() == N[i]*nI[i]);
-        ci_.getAllData(irreps, ci[i]);
-        assert(ci[i].size() == N[i]*ni[i]);
-    }
+    vector<vector<int>> irreps;
+    for (int i = 0;i < n;i++) irreps.push_back({i,i});
+
+    DataFuture<T> coeffs(arena);
+    cA_.getAllDataAsync(irreps, cA, coeffs);
+    ca_.getAllDataAsync(irreps, ca, coeffs);
+    cI_.getAllDataAsync(irreps, cI, coeffs);
+    ci_.getAllDataAsync(irreps, ci, coeffs);
+    coeffs.start();
 
     #define SHOWIT(name) cout << #name ": " << absmax(name.ints) << endl;
 
@@ -1101,6 +1214,16 @@ bool AOMOIntegrals<T>::run(TaskDAG& dag, const Arena& arena)
     pqrs.collect(true);
     abrs_integrals<T> PQrs(pqrs, true);
 
+    coeffs.wait();
+
+    for (int i = 0;i < n;i++)
+    {
+        assert(cA[i].size() == N[i]*nA[i]);
+        assert(ca[i].size() == N[i]*na[i]);
+        assert(cI[i].size() == N[i]*nI[i]);
+        assert(ci[i].size() == N[i]*ni[i]);
+    }
+
     /*
      * First quarter-transformation
      */
@@ -1386,22 +1509,6 @@ bool AOMOIntegrals<T>::run(TaskDAG& dag, const Arena& arena)
     H.getIJAB()({0,1},{1,0})["IjAb"] = H.getABIJ()({1,0},{0,1})["AbIj"];
     H.getIJAB()({0,0},{0,0})["ijab"] = H.getABIJ()({0,0},{0,0})["abij"];
 
-    SpinorbitalTensor<double> D("D", arena, PointGroup::C1(), {vrt,occ}, {0,1}, {0,1});
-
-    if (arena.rank == 0)
-    {
-        vector<kv_pair> pairsa, pairsb;
-        for (int i = 0;i < 5;i++) pairsa.emplace_back(i+i*5, 1.0);
-        for (int i = 0;i < 5;i++) pairsb.emplace_back(i+i*5, 1.0);
-        D({0,1},{0,1})({0,0}).writeRemoteData(pairsa);
-        D({0,0},{0,0})({0,0}).writeRemoteData(pairsb);
-    }
-    else
-    {
-        D({0,1},{0,1})({0,0}).writeRemoteData();
-        D({0,0},{0,0})({0,0}).writeRemoteData();
-    }
-
     //this->log(arena) << "ABCD: " << setprecision(15) << H.getABCD()({2,0},{2,0}).norm(2) << endl;
     //this->log(arena) << "AbCd: " << setprecision(15) << H.getABCD()({1,0},{1,0}).norm(2) << endl;
     //this->log(arena) << "abcd: " << setprecision(15) << H.getABCD()({0,0},{0,0}).norm(2) << endl;
@@ -1449,10 +1556,95 @@ bool AOMOIntegrals<T>::run(TaskDAG& dag, const Arena& arena)
     return true;
 }
 
+template <typename T>
+void AOMOIntegrals<T>::transformABIJ(const Arena& arena, const MOSpace<T>& occ, const MOSpace<T>& vrt,
+                                     SymmetryBlockedTensor<T>& ABIJ,
+                                     SymmetryBlockedTensor<T>& AbIj,
+                                     SymmetryBlockedTensor<T>& abij)
+{
+    const auto& ints = this->template get<ERI>("I");
+
+    int n = ints.group.getNumIrreps();
+    const vector<int>& N = occ.nao;
+    const vector<int>& nI = occ.nalpha;
+    const vector<int>& ni = occ.nbeta;
+    const vector<int>& nA = vrt.nalpha;
+    const vector<int>& na = vrt.nbeta;
+
+    vector<vector<T>> cA(n), ca(n), cI(n), ci(n);
+
+    vector<vector<int>> irreps;
+    for (int i = 0;i < n;i++) irreps.push_back({i,i});
+
+    DataFuture<T> coeffs(arena);
+    vrt.Calpha.getAllDataAsync(irreps, cA, coeffs);
+    vrt.Cbeta.getAllDataAsync(irreps, ca, coeffs);
+    occ.Calpha.getAllDataAsync(irreps, cI, coeffs);
+    occ.Cbeta.getAllDataAsync(irreps, ci, coeffs);
+    coeffs.start();
+
+    /*
+     * Only the (AI|BJ)-type integrals are needed, so the occupied indices
+     * are transformed first and the virtual-virtual blocks never formed
+     */
+    pqrs_integrals<T> pqrs(N, ints);
+    pqrs.collect(true);
+    abrs_integrals<T> PQrs(pqrs, true);
+
+    coeffs.wait();
+
+    abrs_integrals<T> PIrs = PQrs.transform(B, nI, cI);
+    abrs_integrals<T> Pirs = PQrs.transform(B, ni, ci);
+    PQrs.free();
+
+    abrs_integrals<T> AIrs = PIrs.transform(A, nA, cA);
+    PIrs.free();
+    abrs_integrals<T> airs = Pirs.transform(A, na, ca);
+    Pirs.free();
+
+    /*
+     * Make <AB|IJ>
+     */
+    pqrs_integrals<T> rsAI(AIrs);
+    rsAI.collect(false);
+    AIrs.free();
+
+    abrs_integrals<T> RSAI(rsAI, true);
+    abrs_integrals<T> RJAI = RSAI.transform(B, nI, cI);
+    RSAI.free();
+
+    abrs_integrals<T> BJAI = RJAI.transform(A, nA, cA);
+    RJAI.free();
+    BJAI.transcribe(ABIJ, false, false, NONE);
+    BJAI.free();
+
+    /*
+     * Make <Ab|Ij> and <ab|ij>
+     */
+    pqrs_integrals<T> rsai(airs);
+    rsai.collect(false);
+    airs.free();
+
+    abrs_integrals<T> RSai(rsai, true);
+    abrs_integrals<T> RJai = RSai.transform(B, nI, cI);
+    abrs_integrals<T> Rjai = RSai.transform(B, ni, ci);
+    RSai.free();
+
+    abrs_integrals<T> BJai = RJai.transform(A, nA, cA);
+    RJai.free();
+    BJai.transcribe(AbIj, false, false, NONE);
+    BJai.free();
+
+    abrs_integrals<T> bjai = Rjai.transform(A, na, ca);
+    Rjai.free();
+    bjai.transcribe(abij, false, false, NONE);
+    bjai.free();
+}
+
 }
 }
 
 INSTANTIATE_SPECIALIZATIONS(aquarius::op::pqrs_integrals);
 INSTANTIATE_SPECIALIZATIONS(aquarius::op::abrs_integrals);
 INSTANTIATE_SPECIALIZATIONS(aquarius::op::AOMOIntegrals);
-REGISTER_TASK(aquarius::op::AOMOIntegrals<double>,"aomoints");
+REGISTER_TASK(aquarius::op::AOMOIntegrals<double>,"aomoints",aquarius::op::mointsSpec());
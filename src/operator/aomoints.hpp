@@ -22,6 +22,20 @@ struct pqrs_integrals;
 template <typename T>
 struct abrs_integrals;
 
+/*
+ * Screening statistics of pqrs_integrals::transform, counted over the
+ * symmetry blocks of each (rs) pair on this process
+ */
+struct transform_stats
+{
+    size_t nblock = 0;      // blocks considered
+    size_t nskipped = 0;    // blocks skipped by their norm bound
+    size_t nrow = 0;        // rows of the contracted index
+    size_t nrow_kept = 0;   // rows of the contracted index with a non-zero integral
+    size_t ndense = 0;      // transformed integrals if stored densely
+    size_t nnz = 0;         // transformed integrals actually kept
+};
+
 template <typename T>
 struct pqrs_integrals : Distributed
 {
@@ -29,8 +43,16 @@ struct pqrs_integrals : Distributed
     vector<int> np, nq, nr, ns;
     vector<T> ints;
     vector<idx4_t> idxs;
+    /*
+     * Transformed integrals below cutoff are dropped. If stats is set,
+     * each transform of these integrals, or of integrals derived from
+     * them, adds its screening counts to it.
+     */
+    double cutoff;
+    shared_ptr<transform_stats> stats;
 
-    pqrs_integrals(const Arena& arena, const symmetry::PointGroup& group) : Distributed(arena), group(group) {}
+    pqrs_integrals(const Arena& arena, const symmetry::PointGroup& group)
+    : Distributed(arena), group(group), cutoff(1e-12) {}
 
     /*
      * Read integrals in and break (pq|rs)=(rs|pq) symmetry
@@ -52,6 +74,12 @@ struct pqrs_integrals : Distributed
      * Transform (ab|rs) -> (cb|rs) (index = A) or (ab|rs) -> (ac|rs) (index = B)
      *
      * C is ldc*nc if trans = 'N' and ldc*[na|nb] if trans = 'T'
+     *
+     * Only the rows and columns of each (rs) block which hold a non-zero
+     * integral are transformed, so the screening of the AO integrals (and
+     * the cutoff of earlier transforms) carries through. Likewise, only the
+     * columns of C with a non-zero coefficient in one of those rows are
+     * formed. A block is skipped if ||(ab|rs)|| ||C|| bounds it below cutoff.
      */
     pqrs_integrals transform(Index index, const vector<int>& nc, const vector<vector<T>>& C, bool pleq);
 
@@ -101,6 +129,11 @@ class AOMOIntegrals : public MOIntegrals<T>
 
     protected:
         bool run(task::TaskDAG& dag, const Arena& arena);
+
+        void transformABIJ(const Arena& arena, const MOSpace<T>& occ, const MOSpace<T>& vrt,
+                           tensor::SymmetryBlockedTensor<T>& ABIJ,
+                           tensor::SymmetryBlockedTensor<T>& AbIj,
+                           tensor::SymmetryBlockedTensor<T>& abij);
 };
 
 }
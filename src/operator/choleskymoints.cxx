@@ -23,7 +23,7 @@ template <typename T>
 bool CholeskyMOIntegrals<T>::run(TaskDAG& dag, const Arena& arena)
 {
     const auto& occ = this->template get<MOSpace<T>>("occ");
-    const auto& vrt = this->template get<MOSpace<T>>("vrt");
+    const auto& vrt = this->virtuals(arena);
 
     const auto& Fa = this->template get<SymmetryBlockedTensor<T>>("Fa");
     const auto& Fb = this->template get<SymmetryBlockedTensor<T>>("Fb");
@@ -146,10 +146,63 @@ bool CholeskyMOIntegrals<T>::run(TaskDAG& dag, const Arena& arena)
     H.getABCD()({2,0},{2,0})["ABCD"] = 0.5*LDAB["ACR"]*LAB["BDR"];
     H.getABCD()({1,0},{1,0})["AbCd"] =     LDAB["ACR"]*Lab["bdR"];
     H.getABCD()({0,0},{0,0})["abcd"] = 0.5*LDab["acR"]*Lab["bdR"];
+
+    return true;
+}
+
+template <typename T>
+void CholeskyMOIntegrals<T>::transformABIJ(const Arena& arena, const MOSpace<T>& occ, const MOSpace<T>& vrt,
+                                           SymmetryBlockedTensor<T>& ABIJ,
+                                           SymmetryBlockedTensor<T>& AbIj,
+                                           SymmetryBlockedTensor<T>& abij)
+{
+    const auto& chol = this->template get<CholeskyIntegrals<T>>("cholesky");
+
+    const SymmetryBlockedTensor<T>& cA = vrt.Calpha;
+    const SymmetryBlockedTensor<T>& ca = vrt.Cbeta;
+    const SymmetryBlockedTensor<T>& cI = occ.Calpha;
+    const SymmetryBlockedTensor<T>& ci = occ.Cbeta;
+    const SymmetryBlockedTensor<T>& Lpq = chol.getL();
+    const SymmetryBlockedTensor<T>& D = chol.getD();
+
+    const PointGroup& group = occ.group;
+
+    const vector<int>& N = occ.nao;
+    const vector<int>& nI = occ.nalpha;
+    const vector<int>& ni = occ.nbeta;
+    const vector<int>& nA = vrt.nalpha;
+    const vector<int>& na = vrt.nbeta;
+    int R = chol.getRank();
+
+    vector<int> shapeNNN = {NS, NS, NS};
+
+    SymmetryBlockedTensor<T> LAI("LAI", arena, group, 3, {nA, nI, {R}}, shapeNNN, false);
+    SymmetryBlockedTensor<T> Lai("Lai", arena, group, 3, {na, ni, {R}}, shapeNNN, false);
+
+    {
+        SymmetryBlockedTensor<T> LpI("LpI", arena, group, 3, {N, nI, {R}}, shapeNNN, false);
+        SymmetryBlockedTensor<T> Lpi("Lpi", arena, group, 3, {N, ni, {R}}, shapeNNN, false);
+
+        LpI["pIR"] = Lpq["pqR"]*cI["qI"];
+        Lpi["piR"] = Lpq["pqR"]*ci["qi"];
+
+        LAI["AIR"] = LpI["pIR"]*cA["pA"];
+        Lai["aiR"] = Lpi["piR"]*ca["pa"];
+    }
+
+    SymmetryBlockedTensor<T> LDAI("LDAI", arena, group, 3, {nA, nI, {R}}, shapeNNN, false);
+    SymmetryBlockedTensor<T> LDai("LDai", arena, group, 3, {na, ni, {R}}, shapeNNN, false);
+
+    LDAI["AIR"] = D["R"]*LAI["AIR"];
+    LDai["aiR"] = D["R"]*Lai["aiR"];
+
+    ABIJ["ABIJ"] = LDAI["AIR"]*LAI["BJR"];
+    AbIj["AbIj"] = LDAI["AIR"]*Lai["bjR"];
+    abij["abij"] = LDai["aiR"]*Lai["bjR"];
 }
 
 }
 }
 
 INSTANTIATE_SPECIALIZATIONS(aquarius::op::CholeskyMOIntegrals);
-REGISTER_TASK(aquarius::op::CholeskyMOIntegrals<double>,"choleskymoints");
+REGISTER_TASK(aquarius::op::CholeskyMOIntegrals<double>,"choleskymoints",aquarius::op::mointsSpec());
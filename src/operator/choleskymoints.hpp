@@ -21,6 +21,11 @@ class CholeskyMOIntegrals : public MOIntegrals<T>
 
     protected:
         bool run(task::TaskDAG& dag, const Arena& arena);
+
+        void transformABIJ(const Arena& arena, const MOSpace<T>& occ, const MOSpace<T>& vrt,
+                           tensor::SymmetryBlockedTensor<T>& ABIJ,
+                           tensor::SymmetryBlockedTensor<T>& AbIj,
+                           tensor::SymmetryBlockedTensor<T>& abij);
 };
 
 }
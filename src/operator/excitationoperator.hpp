@@ -86,6 +86,74 @@ class ExcitationOperator
             return s;
         }
 
+        /*
+         * Write the amplitudes to a file (on rank 0), e.g. to seed a later
+         * calculation through load()
+         */
+        void save(const string& file) const
+        {
+            ofstream ofs;
+            if (arena.rank == 0)
+            {
+                ofs.open(file.c_str(), ofstream::binary|ofstream::trunc);
+                if (!ofs) throw runtime_error("could not open " + file);
+                int header[2] = {np, nh};
+                ofs.write((char*)header, sizeof(header));
+            }
+
+            for (int i = abs(np-nh);i <= max(np,nh);i++)
+            {
+                const tensor::SpinorbitalTensor<T>& t = (*this)(i);
+                for (int sc = 0;sc < t.getNumTensors();sc++) t(sc).write(ofs);
+            }
+        }
+
+        /*
+         * Read amplitudes written by save(). If the file does not exist, is
+         * truncated, or was written for different orbital spaces, false is
+         * returned on all ranks and the amplitudes are left as they are.
+         */
+        bool load(const string& file)
+        {
+            /*
+             * Everything is read and checked before any amplitudes are set
+             */
+            vector<vector<vector<T>>> vals;
+            int ok = 1;
+            if (arena.rank == 0)
+            {
+                ifstream ifs(file.c_str(), ifstream::binary);
+                int header[2] = {-1, -1};
+                ifs.read((char*)header, sizeof(header));
+                ok = (ifs && header[0] == np && header[1] == nh);
+
+                for (int i = abs(np-nh);ok && i <= max(np,nh);i++)
+                {
+                    const tensor::SpinorbitalTensor<T>& t = (*this)(i);
+                    for (int sc = 0;ok && sc < t.getNumTensors();sc++)
+                    {
+                        vals.emplace_back();
+                        ok = t(sc).readBlocks(ifs, vals.back());
+                    }
+                }
+            }
+
+            arena.comm().Bcast(&ok, 1, 0);
+            if (!ok) return false;
+
+            int k = 0;
+            for (int i = abs(np-nh);i <= max(np,nh);i++)
+            {
+                tensor::SpinorbitalTensor<T>& t = (*this)(i);
+                for (int sc = 0;sc < t.getNumTensors();sc++, k++)
+                {
+                    t(sc).setBlocks(arena.rank == 0 ? vals[k] : vector<vector<T>>());
+                }
+            }
+
+            return true;
+        }
+
         /*
          * Return the largest p-norm of the constituent operators
          */
@@ -1,17 +1,120 @@
 #include "moints.hpp"
 
+using namespace aquarius::tensor;
 using namespace aquarius::task;
 using namespace aquarius::input;
+using namespace aquarius::symmetry;
 
 namespace aquarius
 {
 namespace op
 {
 
+/*
+ * Rotate the virtuals C (with orbital energies E) into the eigenvectors of
+ * the virtual density D with occupations above thresh, and then
+ * semicanonicalize these within each irrep
+ */
+template <typename T>
+static SymmetryBlockedTensor<T> naturalOrbitals(const string& name, const SymmetryBlockedTensor<T>& C,
+                                                const SymmetryBlockedTensor<T>& D,
+                                                const vector<vector<T>>& E, double thresh,
+                                                vector<int>& nno)
+{
+    const PointGroup& group = C.getGroup();
+    int n = group.getNumIrreps();
+    const vector<int>& N = C.getLengths()[0];
+    const vector<int>& nv = C.getLengths()[1];
+
+    nno.assign(n, 0);
+    vector<vector<T>> X(n);
+
+    for (int i = 0;i < n;i++)
+    {
+        int m = nv[i];
+        if (m == 0) continue;
+
+        vector<T> U;
+        D.getAllData({i,i}, U);
+        assert(U.size() == m*m);
+
+        vector<real_type_t<T>> occ(m);
+        heev('V', 'U', m, U.data(), m, occ.data());
+
+        /*
+         * The occupations are in ascending order
+         */
+        int k;
+        for (k = 0;k < m && occ[m-1-k] > thresh;k++);
+        nno[i] = k;
+        if (k == 0) continue;
+
+        const T* Uk = &U[(m-k)*m];
+
+        vector<T> EU(m*k), F(k*k);
+        for (int c = 0;c < k;c++)
+            for (int r = 0;r < m;r++)
+                EU[r+c*m] = E[i][r]*Uk[r+c*m];
+
+        gemm('T', 'N', k, k, m, 1.0, Uk, m, EU.data(), m, 0.0, F.data(), k);
+
+        vector<real_type_t<T>> e(k);
+        heev('V', 'U', k, F.data(), k, e.data());
+
+        X[i].resize(m*k);
+        gemm('N', 'N', m, k, k, 1.0, Uk, m, F.data(), k, 0.0, X[i].data(), m);
+    }
+
+    SymmetryBlockedTensor<T> XAB("X", C.arena, group, 2, {nv,nno}, {NS,NS}, true);
+
+    for (int i = 0;i < n;i++)
+    {
+        if (C.arena.rank == 0)
+        {
+            vector<tkv_pair<T>> pairs;
+            for (int j = 0;j < X[i].size();j++) pairs.emplace_back(j, X[i][j]);
+            XAB.writeRemoteData({i,i}, pairs);
+        }
+        else
+        {
+            XAB.writeRemoteData({i,i});
+        }
+    }
+
+    SymmetryBlockedTensor<T> Cno(name, C.arena, group, 2, {N,nno}, {NS,NS}, false);
+    Cno["pB"] = C["pA"]*XAB["AB"];
+
+    return Cno;
+}
+
+string mointsSpec(const string& extra)
+{
+    string spec = R"!(
+
+frozen_virtuals?
+    int 0,
+frozen_virtual_irrep*
+    int,
+virtual_cutoff?
+    double,
+fno_threshold?
+    double 0.0
+)!";
+
+    return (extra.empty() ? spec : spec+","+extra);
+}
+
 template <typename T>
 MOIntegrals<T>::MOIntegrals(const string& name, Config& config)
-: Task(name, config)
+: Task(name, config), frozen_virtuals(config.get<int>("frozen_virtuals")),
+  virtual_cutoff(config.exists("virtual_cutoff") ? config.get<double>("virtual_cutoff")
+                                                 : numeric_limits<double>::max()),
+  fno_threshold(config.get<double>("fno_threshold"))
 {
+    vector<pair<string,int>> irreps = config.find<int>("frozen_virtual_irrep");
+    for (vector<pair<string,int>>::iterator i = irreps.begin();i != irreps.end();++i)
+        frozen_virtual_irreps.push_back(i->second);
+
     vector<Requirement> reqs;
     reqs += Requirement("occspace", "occ");
     reqs += Requirement("vrtspace", "vrt");
@@ -22,6 +125,136 @@ MOIntegrals<T>::MOIntegrals(const string& name, Config& config)
     addProduct("moints", "H", reqs);
 }
 
+template <typename T>
+const MOSpace<T>& MOIntegrals<T>::virtuals(const Arena& arena)
+{
+    const auto& occ = this->template get<MOSpace<T>>("occ");
+    const auto& vrt = this->template get<MOSpace<T>>("vrt");
+
+    const auto& Ea = this->template get<vector<vector<real_type_t<T>>>>("Ea");
+    const auto& Eb = this->template get<vector<vector<real_type_t<T>>>>("Eb");
+
+    const PointGroup& group = occ.group;
+    int n = group.getNumIrreps();
+
+    const vector<int>& N = occ.nao;
+    const vector<int>& nI = occ.nalpha;
+    const vector<int>& ni = occ.nbeta;
+    vector<int> nA = vrt.nalpha;
+    vector<int> na = vrt.nbeta;
+
+    if (!frozen_virtual_irreps.empty())
+    {
+        if (frozen_virtual_irreps.size() != n)
+            this->error(arena) << "frozen_virtual_irrep must be given once for each irrep" << endl;
+
+        for (int i = 0;i < n;i++)
+        {
+            nA[i] -= min(nA[i], frozen_virtual_irreps[i]);
+            na[i] -= min(na[i], frozen_virtual_irreps[i]);
+        }
+    }
+
+    /*
+     * The virtuals of each irrep are in order of increasing energy and
+     * follow the occupied orbitals in Ea and Eb
+     */
+    auto drop = [&](vector<int>& nv, const vector<int>& no, const vector<vector<real_type_t<T>>>& E)
+    {
+        vector<pair<real_type_t<T>,int>> E_vrt;
+        for (int i = 0;i < n;i++)
+        {
+            while (nv[i] > 0 && E[i][no[i]+nv[i]-1] > virtual_cutoff) nv[i]--;
+            for (int j = 0;j < nv[i];j++) E_vrt.push_back(make_pair(E[i][no[i]+j],i));
+        }
+
+        sort(E_vrt.begin(), E_vrt.end());
+
+        for (int j = 0;j < min(frozen_virtuals, (int)E_vrt.size());j++)
+            nv[E_vrt[E_vrt.size()-1-j].second]--;
+    };
+
+    drop(nA, nI, Ea);
+    drop(na, ni, Eb);
+
+    if (nA == vrt.nalpha && na == vrt.nbeta && fno_threshold <= 0) return vrt;
+
+    vector<int> nfrozen_alpha(n), nfrozen_beta(n);
+    for (int i = 0;i < n;i++)
+    {
+        nfrozen_alpha[i] = vrt.nalpha[i]-nA[i];
+        nfrozen_beta[i] = vrt.nbeta[i]-na[i];
+    }
+
+    this->log(arena) << "Dropping virtual MOs: " << nfrozen_alpha << ", " << nfrozen_beta << endl;
+
+    vector<int> zero(n, 0);
+    SymmetryBlockedTensor<T> CA("CA", vrt.Calpha, {zero,zero}, {N,nA});
+    SymmetryBlockedTensor<T> Ca("Ca", vrt.Cbeta, {zero,zero}, {N,na});
+
+    if (fno_threshold <= 0)
+        return this->puttmp("vrt", new MOSpace<T>(move(CA), move(Ca)));
+
+    /*
+     * Frozen natural orbitals from the MP2 virtual density,
+     *
+     * D(AB) = 1/2 T(AC,IJ) T(BC,IJ) + T(Ac,Ij) T(Bc,Ij)
+     * D(ab) = 1/2 T(ac,ij) T(bc,ij) + T(Ca,Ij) T(Cb,Ij)
+     */
+    vector<int> shapeNNNN = {NS,NS,NS,NS};
+    SymmetryBlockedTensor<T> ABIJ("<AB|IJ>", arena, group, 4, {nA,nA,nI,nI}, shapeNNNN, false);
+    SymmetryBlockedTensor<T> AbIj("<Ab|Ij>", arena, group, 4, {nA,na,nI,ni}, shapeNNNN, false);
+    SymmetryBlockedTensor<T> abij("<ab|ij>", arena, group, 4, {na,na,ni,ni}, shapeNNNN, false);
+
+    {
+        MOSpace<T> trunc(CA, Ca);
+        transformABIJ(arena, occ, trunc, ABIJ, AbIj, abij);
+    }
+
+    vector<vector<T>> EA(n), Ea_(n), EI(n), Ei(n);
+    for (int i = 0;i < n;i++)
+    {
+        for (int j = 0;j < nA[i];j++) EA[i].push_back(Ea[i][nI[i]+j]);
+        for (int j = 0;j < na[i];j++) Ea_[i].push_back(Eb[i][ni[i]+j]);
+        for (int j = 0;j < nI[i];j++) EI[i].push_back(-Ea[i][j]);
+        for (int j = 0;j < ni[i];j++) Ei[i].push_back(-Eb[i][j]);
+    }
+
+    SymmetryBlockedTensor<T> TAA("T(AB,IJ)", ABIJ);
+    SymmetryBlockedTensor<T> Taa("T(ab,ij)", abij);
+    TAA["ABIJ"] -= ABIJ["ABJI"];
+    Taa["abij"] -= abij["abji"];
+    TAA.weight({&EA,&EA,&EI,&EI});
+    AbIj.weight({&EA,&Ea_,&EI,&Ei});
+    Taa.weight({&Ea_,&Ea_,&Ei,&Ei});
+
+    vector<int> shapeNN = {NS,NS};
+    SymmetryBlockedTensor<T> DA("DA", arena, group, 2, {nA,nA}, shapeNN, true);
+    SymmetryBlockedTensor<T> Da("Da", arena, group, 2, {na,na}, shapeNN, true);
+
+    DA["AB"]  = 0.5*TAA["ACIJ"]*TAA["BCIJ"];
+    DA["AB"] +=    AbIj["AcIj"]*AbIj["BcIj"];
+    Da["ab"]  = 0.5*Taa["acij"]*Taa["bcij"];
+    Da["ab"] +=    AbIj["CaIj"]*AbIj["CbIj"];
+
+    vector<int> nno_alpha, nno_beta;
+    auto& active = this->puttmp("vrt", new MOSpace<T>(naturalOrbitals("CA", CA, DA, EA, fno_threshold, nno_alpha),
+                                                      naturalOrbitals("Ca", Ca, Da, Ea_, fno_threshold, nno_beta)));
+
+    this->log(arena) << "Frozen natural orbitals: " << nno_alpha << ", " << nno_beta << endl;
+
+    return active;
+}
+
+template <typename T>
+void MOIntegrals<T>::transformABIJ(const Arena& arena, const MOSpace<T>& occ, const MOSpace<T>& vrt,
+                                   SymmetryBlockedTensor<T>& ABIJ,
+                                   SymmetryBlockedTensor<T>& AbIj,
+                                   SymmetryBlockedTensor<T>& abij)
+{
+    this->error(arena) << "Frozen natural orbitals are not available in this transformation" << endl;
+}
+
 INSTANTIATE_SPECIALIZATIONS(MOIntegrals);
 
 }
@@ -12,11 +12,54 @@ namespace aquarius
 namespace op
 {
 
+/*
+ * Base class of the AO->MO transformations. The virtual space handed over
+ * by the SCF may be truncated before transforming (see virtuals()):
+ *
+ * frozen_virtuals        drop this many of the highest virtuals (of each
+ *                        spin), chosen by orbital energy over all irreps
+ * frozen_virtual_irrep*  alternatively, the number of highest virtuals to
+ *                        drop in each irrep, given once per irrep in order
+ * virtual_cutoff         drop virtuals with orbital energies above this
+ * fno_threshold          replace the remaining virtuals by the MP2 natural
+ *                        orbitals with occupations above this (frozen
+ *                        natural orbitals), which are then semicanonicalized
+ *
+ * mointsSpec gives the spec of these, followed by the entries in extra (if
+ * any), for the schemas of the derived tasks.
+ *
+ * Only the UHF (spin-orbital) transformations derive from this class
+ * (aomoints, sparseaomoints, and choleskymoints); rhfaomoints and
+ * sparserhfaomoints always transform the full virtual space.
+ */
+string mointsSpec(const string& extra = "");
+
 template <typename T>
 class MOIntegrals : public task::Task
 {
     protected:
+        int frozen_virtuals;
+        vector<int> frozen_virtual_irreps;
+        double virtual_cutoff;
+        double fno_threshold;
+
         MOIntegrals(const string& name, input::Config& config);
+
+        /*
+         * The virtual space to transform into, which is the "vrt" space
+         * itself if no truncation was requested
+         */
+        const MOSpace<T>& virtuals(const Arena& arena);
+
+        /*
+         * Compute the (not antisymmetrized) integrals <AB|IJ>, <Ab|Ij>, and
+         * <ab|ij> between the given spaces, for the MP2 density from which
+         * the frozen natural orbitals are formed
+         */
+        virtual void transformABIJ(const Arena& arena, const MOSpace<T>& occ, const MOSpace<T>& vrt,
+                                   tensor::SymmetryBlockedTensor<T>& ABIJ,
+                                   tensor::SymmetryBlockedTensor<T>& AbIj,
+                                   tensor::SymmetryBlockedTensor<T>& abij);
 };
 
 }
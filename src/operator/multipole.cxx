@@ -2,8 +2,6 @@
 
 using namespace aquarius::tensor;
 using namespace aquarius::integrals;
-using namespace aquarius::scf;
-using namespace aquarius::input;
 
 namespace aquarius
 {
@@ -11,46 +9,24 @@ namespace op
 {
 
 template <typename T>
-Multipole<T>::Multipole(const string& name, const UHF<T>& uhf, int Lmin_, int Lmax_)
-: MOOperator<T>(uhf), CompositeTensor<Multipole<T>,
+Multipole<T>::Multipole(const string& name, const MOSpace<T>& occ, const MOSpace<T>& vrt,
+                        const unique_vector<OneElectronIntegral>& ao, int Lmin_, int Lmax_)
+: MOOperator(occ.arena, occ, vrt), CompositeTensor<Multipole<T>,
   OneElectronOperator<T>,T>(name, Lmax_ == -1 ? (Lmin_+1)*(Lmin_+2)/2 :
           (Lmax_+1)*(Lmax_+2)*(Lmax_+3)/6-Lmin_*(Lmin_+1)*(Lmin_+2)/6),
   Lmin(Lmin_), Lmax(Lmax_ == -1 ? Lmin_ : Lmax_)
 {
-    Context context;
-    const Molecule& m = uhf.getMolecule();
-    vector<int> N = m.getNumOrbitals();
-
-    SymmetryBlockedTensor<T> ao(uhf.arena, m.getGroup(), 2, {N,N}, {NS,NS}, false);
+    assert(Lmin >= 1);
+    assert(ao.size() >= (Lmax+1)*(Lmax+2)*(Lmax+3)/6-1);
 
     int xyztot = 0;
     for (int L = Lmin;L <= Lmax;L++)
     {
-        vector<vector<tkv_pair<T>>> pairs;
-
-        int ij = 0;
-        for (Molecule::const_shell_iterator i = m.getShellsBegin();i != m.getShellsEnd();++i)
-        {
-            for (Molecule::const_shell_iterator j = i;j != m.getShellsEnd();++j)
-            {
-                if (i < j) continue;
-
-                if (ij%this->arena.nproc == this->arena.rank)
-                {
-                    //calc integrals
-
-                    //put into pairs
-                }
-
-                ij++;
-            }
-        }
-
         for (int xyz = 0;xyz < (L+1)*(L+2)/2;xyz++)
         {
-            ao = (T)0;
-            //ao.writeRemoteData(pairs[xyz]);
-            this->tensors[xyztot++].tensor = new OneElectronOperator<T>(name, uhf, ao);
+            const OneElectronIntegral& ints = ao[L*(L+1)*(L+2)/6-1+xyz];
+            tensors[xyztot].isAlloced = true;
+            tensors[xyztot++].tensor = new OneElectronOperator<T>(name, occ, vrt, ints, ints);
         }
     }
 }
@@ -68,6 +44,11 @@ const OneElectronOperator<T>& Multipole<T>::operator()(int x, int y, int z) cons
 {
     int L = x+y+z;
     assert(L >= Lmin && L <= Lmax);
-    int xyz = z+(L+1-x)*(L+2-x)/2;
+    int xyz = (L-x)*(L-x+1)/2+z;
     return (*this)(L, xyz);
 }
+
+}
+}
+
+INSTANTIATE_SPECIALIZATIONS(aquarius::op::Multipole);
@@ -1,24 +1,33 @@
 #ifndef _AQUARIUS_OPERATOR_MULTIPOLE_HPP_
 #define _AQUARIUS_OPERATOR_MULTIPOLE_HPP_
 
-#include "../scf/uhf.hpp"
 #include "util/global.hpp"
 
+#include "integrals/1eints.hpp"
+
 #include "1eoperator.hpp"
+#include "space.hpp"
 
 namespace aquarius
 {
 namespace op
 {
 
+/*
+ * The MO Cartesian multipole operators of order Lmin through Lmax, from the
+ * AO integrals of the 1eints task (which start at L = 1)
+ */
 template <typename T>
-class Multipole : public MOOperator<T>, public tensor::CompositeTensor<Multipole<T>,OneElectronOperator<T>,T>
+class Multipole : public MOOperator, public tensor::CompositeTensor<Multipole<T>,OneElectronOperator<T>,T>
 {
+    INHERIT_FROM_COMPOSITE_TENSOR(Multipole<T>,OneElectronOperator<T>,T)
+
     protected:
         int Lmin, Lmax;
 
     public:
-        Multipole(const string& name, const scf::UHF<T>& uhf, int Lmin, int Lmax=-1);
+        Multipole(const string& name, const MOSpace<T>& occ, const MOSpace<T>& vrt,
+                  const unique_vector<integrals::OneElectronIntegral>& ao, int Lmin, int Lmax=-1);
 
         const OneElectronOperator<T>& operator()(int L, int xyz) const;
 
@@ -21,9 +21,34 @@ T absmax(const vector<T>& c)
     return nrm2(c.size(), c.data(), 1);
 }
 
+/*
+ * Zero the coefficients below cutoff and return how many there were
+ */
+template <typename T>
+size_t prune(vector<vector<T>>& C, double cutoff)
+{
+    size_t npruned = 0;
+
+    for (auto& Ci : C)
+    {
+        for (auto& c : Ci)
+        {
+            if (c != (T)0 && aquarius::abs(c) < cutoff)
+            {
+                c = (T)0;
+                npruned++;
+            }
+        }
+    }
+
+    return npruned;
+}
+
 template <typename T>
 SparseAOMOIntegrals<T>::SparseAOMOIntegrals(const string& name, Config& config)
-: MOIntegrals<T>(name, config)
+: MOIntegrals<T>(name, config),
+  integral_cutoff(config.get<double>("integral_cutoff")),
+  coefficient_cutoff(config.get<double>("coefficient_cutoff"))
 {
     this->getProduct("H").addRequirement("eri", "I");
 }
@@ -34,7 +59,7 @@ bool SparseAOMOIntegrals<T>::run(TaskDAG& dag, const Arena& arena)
     CTF_Timer_epoch ep("SparseAOMOIntegrals");
     ep.begin();
     const auto& occ = this->template get<MOSpace<T>>("occ");
-    const auto& vrt = this->template get<MOSpace<T>>("vrt");
+    const auto& vrt = this->virtuals(arena);
 
     const auto& ints = this->template get<ERI>("I");
 
@@ -90,29 +115,57 @@ bool SparseAOMOIntegrals<T>::run(TaskDAG& dag, const Arena& arena)
     vector<vector<T>> cA(n), ca(n), cI(n), ci(n);
 
     /*
-     * Read transformation coefficients
+     * Start reading transformation coefficients; the broadcast overlaps
+     * with resorting the AO integrals
+     */
+    vector<vector<int>> irreps;
+    for (int i = 0;i < n;i++) irreps.push_back({i,i});
+
+    DataFuture<T> coeffs(arena);
+    cA_.getAllDataAsync(irreps, cA, coeffs);
+    ca_.getAllDataAsync(irreps, ca, coeffs);
+    cI_.getAllDataAsync(irreps, cI, coeffs);
+    ci_.getAllDataAsync(irreps, ci, coeffs);
+    coeffs.start();
+
+    #define SHOWIT(name) cout << #name ": " << absmax(name.ints) << endl;
+
+    /*
+     * Resort integrals so that each node has (pq|r_k s_l) where pq
+     * are sparse blocks for each sparse rs pair
      */
+    pqrs_integrals<T> pqrs(N, ints);
+    pqrs.cutoff = integral_cutoff;
+    pqrs.stats.reset(new transform_stats());
+    pqrs.collect(true);
+
+    coeffs.wait();
+
     for (int i = 0;i < n;i++)
     {
-        vector<int> irreps = {i,i};
-        cA_.getAllData(irreps, cA[i]);
         assert(cA[i].size() == N[i]*nA[i]);
-        ca_.getAllData(irreps, ca[i]);
         assert(ca[i].size() == N[i]*na[i]);
-        cI_.getAllData(irreps, cI[i]);
         assert(cI[i].size() == N[i]*nI[i]);
-        ci_.getAllData(irreps, ci[i]);
         assert(ci[i].size() == N[i]*ni[i]);
     }
 
-    #define SHOWIT(name) cout << #name ": " << absmax(name.ints) << endl;
-
     /*
-     * Resort integrals so that each node has (pq|r_k s_l) where pq
-     * are sparse blocks for each sparse rs pair
+     * Small coefficients (e.g. the tails of localized orbitals) are
+     * dropped, so that each AO row only feeds the MOs it contributes to
      */
-    pqrs_integrals<T> pqrs(N, ints);
-    pqrs.collect(true);
+    size_t ncoeff = 0;
+    for (int i = 0;i < n;i++)
+        ncoeff += cA[i].size()+ca[i].size()+cI[i].size()+ci[i].size();
+    size_t npruned = 0;
+    if (coefficient_cutoff > 0)
+    {
+        npruned += prune(cA, coefficient_cutoff);
+        npruned += prune(ca, coefficient_cutoff);
+        npruned += prune(cI, coefficient_cutoff);
+        npruned += prune(ci, coefficient_cutoff);
+    }
+
+    auto stats = pqrs.stats;
 
     /*
      * First quarter-transformation
@@ -392,6 +445,17 @@ bool SparseAOMOIntegrals<T>::run(TaskDAG& dag, const Arena& arena)
     H.getIJAB()({0,1},{1,0})["IjAb"] = H.getABIJ()({1,0},{0,1})["AbIj"];
     H.getIJAB()({0,0},{0,0})["ijab"] = H.getABIJ()({0,0},{0,0})["abij"];
 
+    vector<size_t> counts = {stats->nblock, stats->nskipped,
+                             stats->nrow, stats->nrow_kept,
+                             stats->ndense, stats->nnz};
+    arena.comm().Allreduce(counts, MPI_SUM);
+
+    this->log(arena) << "Pruned " << npruned << " of " << ncoeff << " MO coefficients" << endl;
+    this->log(arena) << "Skipped " << counts[1] << " of " << counts[0] << " (rs) blocks by norm bound" << endl;
+    this->log(arena) << "Transformed " << fixed << setprecision(1) <<
+                        100.0*counts[3]/max(counts[2], (size_t)1) << "% of rows, keeping " <<
+                        100.0*counts[5]/max(counts[4], (size_t)1) << "% of integrals" << endl;
+
     //this->log(arena) << "ABCD: " << setprecision(15) << H.getABCD()({2,0},{2,0}).norm(2) << endl;
     //this->log(arena) << "AbCd: " << setprecision(15) << H.getABCD()({1,0},{1,0}).norm(2) << endl;
     //this->log(arena) << "abcd: " << setprecision(15) << H.getABCD()({0,0},{0,0}).norm(2) << endl;
@@ -434,5 +498,14 @@ bool SparseAOMOIntegrals<T>::run(TaskDAG& dag, const Arena& arena)
 }
 }
 
+static const char* spec = R"!(
+
+integral_cutoff?
+    double 1e-12,
+coefficient_cutoff?
+    double 0.0
+
+)!";
+
 INSTANTIATE_SPECIALIZATIONS(aquarius::op::SparseAOMOIntegrals);
-REGISTER_TASK(aquarius::op::SparseAOMOIntegrals<double>,"sparseaomoints");
+REGISTER_TASK(aquarius::op::SparseAOMOIntegrals<double>,"sparseaomoints",aquarius::op::mointsSpec(spec));
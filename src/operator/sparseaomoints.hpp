@@ -17,6 +17,14 @@ namespace op
 template <typename T>
 class SparseAOMOIntegrals : public MOIntegrals<T>
 {
+    protected:
+        /*
+         * Transformed integrals below integral_cutoff are dropped, and MO
+         * coefficients below coefficient_cutoff are taken as zero
+         */
+        double integral_cutoff;
+        double coefficient_cutoff;
+
     public:
         SparseAOMOIntegrals(const string& name, input::Config& config);
 
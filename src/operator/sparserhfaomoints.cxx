@@ -67,16 +67,16 @@ bool SparseRHFAOMOIntegrals<T>::run(TaskDAG& dag, const Arena& arena)
     vector<vector<T>> cA(n), cI(n);
 
     /*
-     * Read transformation coefficients
+     * Start reading transformation coefficients; the broadcast overlaps
+     * with resorting the AO integrals
      */
-    for (int i = 0;i < n;i++)
-    {
-        vector<int> irreps = {i,i};
-        cA_.getAllData(irreps, cA[i]);
-        assert(cA[i].size() == N[i]*nA[i]);
-        cI_.getAllData(irreps, cI[i]);
-        assert(cI[i].size() == N[i]*nI[i]);
-    }
+    vector<vector<int>> irreps;
+    for (int i = 0;i < n;i++) irreps.push_back({i,i});
+
+    DataFuture<T> coeffs(arena);
+    cA_.getAllDataAsync(irreps, cA, coeffs);
+    cI_.getAllDataAsync(irreps, cI, coeffs);
+    coeffs.start();
 
     /*
      * Resort integrals so that each node has (pq|r_k s_l) where pq
@@ -85,6 +85,14 @@ bool SparseRHFAOMOIntegrals<T>::run(TaskDAG& dag, const Arena& arena)
     pqrs_integrals<T> pqrs(N, ints);
     pqrs.collect(true);
 
+    coeffs.wait();
+
+    for (int i = 0;i < n;i++)
+    {
+        assert(cA[i].size() == N[i]*nA[i]);
+        assert(cI[i].size() == N[i]*nI[i]);
+    }
+
     /*
      * First quarter-transformation
      */
@@ -22,6 +22,16 @@ namespace op
 template <typename U>
 class STTwoElectronOperator : public TwoElectronOperator<U>
 {
+    protected:
+        /*
+         * If the (ab,ef) block is not formed, abcd refers to the bare
+         * integrals of X and the remaining terms are applied on the fly
+         * using T1 and Tau by leftContractABCD() and
+         * rightContractABCD()
+         */
+        bool abcd_formed = true;
+        unique_ptr<tensor::SpinorbitalTensor<U>> T1, Tau;
+
     public:
         template <int N>
         STTwoElectronOperator(const string& name, const OneElectronOperator<U>& X, const ExcitationOperator<U,N>& T)
@@ -50,15 +60,30 @@ class STTwoElectronOperator : public TwoElectronOperator<U>
             }
         }
 
+        /*
+         * Only the blocks in formed (see TwoElectronOperator) are guaranteed
+         * to be stored; currently only ABCD may be left out, in which case it
+         * must be accessed through leftContractABCD() or
+         * rightContractABCD(), and X must outlive this operator
+         */
         template <int N>
-        STTwoElectronOperator(const string& name, const TwoElectronOperator<U>& X, const ExcitationOperator<U,N>& T, bool isHbar=false)
-        : TwoElectronOperator<U>(name, X)
+        STTwoElectronOperator(const string& name, const TwoElectronOperator<U>& X, const ExcitationOperator<U,N>& T,
+                              bool isHbar=false, int formed=TwoElectronOperator<U>::ALL)
+        : TwoElectronOperator<U>(name, const_cast<TwoElectronOperator<U>&>(X),
+                                 formed|~TwoElectronOperator<U>::ABCD),
+          abcd_formed(formed&TwoElectronOperator<U>::ABCD)
         {
             assert(N >= 2 && N <= 4);
 
             tensor::SpinorbitalTensor<U> Tau(T(2));
             Tau["abij"] += 0.5*T(1)["ai"]*T(1)["bj"];
 
+            if (!abcd_formed)
+            {
+                this->T1.reset(new tensor::SpinorbitalTensor<U>("T1", T(1)));
+                this->Tau.reset(new tensor::SpinorbitalTensor<U>("Tau", Tau));
+            }
+
             this->ia["me"] = this->ijab["mnef"]*T(1)["fn"];
 
             this->ij["mi"] += 0.5*this->ijab["nmef"]*T(2)["efni"];
@@ -125,8 +150,11 @@ class STTwoElectronOperator : public TwoElectronOperator<U>
 
             this->aibj["amei"] -= 0.5*this->ijak["nmei"]*T(1)["an"];
 
-            this->abcd["abef"] += 0.5*this->ijab["mnef"]*Tau["abmn"];
-            this->abcd["abef"] -= this->aibc["amef"]*T(1)["bm"];
+            if (abcd_formed)
+            {
+                this->abcd["abef"] += 0.5*this->ijab["mnef"]*Tau["abmn"];
+                this->abcd["abef"] -= this->aibc["amef"]*T(1)["bm"];
+            }
 
             this->aibc["amef"] -= this->ijab["nmef"]*T(1)["an"];
 
@@ -151,6 +179,67 @@ class STTwoElectronOperator : public TwoElectronOperator<U>
                 this->abij["abij"] += 0.25*this->ijab["mnef"]*T(4)["abefijmn"];
             }
         }
+
+        bool isFormed(int block) const
+        {
+            return (block&TwoElectronOperator<U>::ABCD) == 0 || abcd_formed;
+        }
+
+        /*
+         * Z["ijab"] += alpha*W["efab"]*L["ijef"], where W is the
+         * transformed (ab,ef) block, whether or not it has been formed
+         */
+        void leftContractABCD(U alpha, const tensor::SpinorbitalTensor<U>& L,
+                          tensor::SpinorbitalTensor<U>& Z) const
+        {
+            Z["ijab"] += alpha*this->abcd["efab"]*L["ijef"];
+
+            if (abcd_formed) return;
+
+            const Space& occ = this->occ;
+            const Space& vrt = this->vrt;
+            const symmetry::Representation& rep = L(0).getRepresentation();
+
+            tensor::SpinorbitalTensor<U> X("X(ij,mn)", this->arena, occ.group, rep, {vrt,occ}, {0,2}, {0,2});
+            tensor::SpinorbitalTensor<U> Y("Y(ij,em)", this->arena, occ.group, rep, {vrt,occ}, {0,2}, {1,1});
+
+            /*
+             * The bare (am,ef) integrals are recovered from the transformed
+             * ones through the T1*<mn||ef> term
+             */
+            Y["ijem"]  =     L["ijef"]*(*T1)["fm"];
+            X["ijmn"]  = 0.5*L["ijef"]*(*Tau)["efmn"];
+            X["ijmn"] +=     Y["ijem"]*(*T1)["en"];
+
+            Z["ijab"] +=   alpha*X["ijmn"]*this->ijab["mnab"];
+            Z["ijab"] -= 2*alpha*Y["ijem"]*this->aibc["emab"];
+        }
+
+        /*
+         * Z["abij"] += alpha*W["abef"]*R["efij"], where W is the
+         * transformed (ab,ef) block, whether or not it has been formed
+         */
+        void rightContractABCD(U alpha, tensor::SpinorbitalTensor<U>& Z,
+                          const tensor::SpinorbitalTensor<U>& R) const
+        {
+            Z["abij"] += alpha*this->abcd["abef"]*R["efij"];
+
+            if (abcd_formed) return;
+
+            const Space& occ = this->occ;
+            const Space& vrt = this->vrt;
+            const symmetry::Representation& rep = R(0).getRepresentation();
+
+            tensor::SpinorbitalTensor<U> X("X(mn,ij)", this->arena, occ.group, rep, {vrt,occ}, {0,2}, {0,2});
+            tensor::SpinorbitalTensor<U> Y("Y(am,ij)", this->arena, occ.group, rep, {vrt,occ}, {1,1}, {0,2});
+
+            X["mnij"]  = 0.5*this->ijab["mnef"]*R["efij"];
+            Y["amij"]  =     this->aibc["amef"]*R["efij"];
+            Y["amij"] +=   2*(*T1)["an"]*X["nmij"];
+
+            Z["abij"] +=   alpha*(*Tau)["abmn"]*X["mnij"];
+            Z["abij"] -=   alpha*Y["amij"]*(*T1)["bm"];
+        }
 };
 
 }
@@ -12,7 +12,7 @@ namespace scf
 
 template <typename T, template <typename T_> class WhichUHF>
 AOUHF<T,WhichUHF>::AOUHF(const string& name, Config& config)
-: WhichUHF<T>(name, config)
+: WhichUHF<T>(name, config), fock_cutoff(config.get<double>("fock_cutoff"))
 {
     for (vector<Product>::iterator i = this->products.begin();i != this->products.end();++i)
     {
@@ -35,6 +35,17 @@ void AOUHF<T,WhichUHF>::buildFock()
     vector<int> start(nirrep,0);
     for (int i = 1;i < nirrep;i++) start[i] = start[i-1]+norb[i-1];
 
+    /*
+     * All per-irrep matrices are stored back-to-back, so that element
+     * (p,q) of irrep i is at off[i]+p+q*norb[i]
+     */
+    vector<int64_t> off(nirrep+1, 0);
+    for (int i = 0;i < nirrep;i++) off[i+1] = off[i]+norb[i]*norb[i];
+    int64_t nfock = off[nirrep];
+
+    vector<int> local(irrep.size());
+    for (int p = 0;p < irrep.size();p++) local[p] = p-start[irrep[p]];
+
     auto& H  = this->template get<SymmetryBlockedTensor<T>>("H");
     auto& Da = this->template get<SymmetryBlockedTensor<T>>("Da");
     auto& Db = this->template get<SymmetryBlockedTensor<T>>("Db");
@@ -43,219 +54,291 @@ void AOUHF<T,WhichUHF>::buildFock()
 
     Arena& arena = H.arena;
 
-    vector<vector<T>> focka(nirrep), fockb(nirrep);
     vector<vector<T>> densa(nirrep), densb(nirrep);
-    vector<vector<T>> densab(nirrep);
+
+    /*
+     * Start the (non-blocking) gather of both densities for all irreps at
+     * once, and read the core Hamiltonian while it is in flight
+     */
+    vector<vector<int>> irreps;
+    for (int i = 0;i < nirrep;i++) irreps.push_back({i,i});
+
+    DataFuture<T> dens(arena);
+    Da.getAllDataAsync(irreps, densa, dens);
+    Db.getAllDataAsync(irreps, densb, dens);
+    dens.start();
+
+    vector<T> fock(2*nfock, (T)0);
 
     for (int i = 0;i < nirrep;i++)
     {
-        vector<int> irreps(2,i);
-
         if (arena.rank == 0)
         {
-            H.getAllData(irreps, focka[i], 0);
-            assert(focka[i].size() == norb[i]*norb[i]);
-            fockb[i] = focka[i];
+            vector<T> h;
+            H.getAllData(irreps[i], h, 0);
+            assert(h.size() == norb[i]*norb[i]);
+            copy(h.begin(), h.end(), fock.begin()+off[i]);
+            copy(h.begin(), h.end(), fock.begin()+off[i]+nfock);
         }
         else
         {
-            H.getAllData(irreps, 0);
-            focka[i].resize(norb[i]*norb[i], (T)0);
-            fockb[i].resize(norb[i]*norb[i], (T)0);
+            H.getAllData(irreps[i], 0);
         }
+    }
 
-        Da.getAllData(irreps, densa[i]);
-        assert(densa[i].size() == norb[i]*norb[i]);
-        Db.getAllData(irreps, densb[i]);
+    /*
+     * Map each shell to the (irrep-local) range of functions it spans in
+     * each irrep, for the shell-pair density bounds below
+     */
+    vector<Shell> shells(molecule.getShellsBegin(), molecule.getShellsEnd());
+    vector<vector<int>> shell_idx = Shell::setupIndices(Context(), molecule);
+    int nshell = shells.size();
+
+    dens.wait();
+
+    vector<T> dsa(nfock), dsb(nfock), dst(nfock);
+
+    for (int i = 0;i < nirrep;i++)
+    {
         assert(densa[i].size() == norb[i]*norb[i]);
+        assert(densb[i].size() == norb[i]*norb[i]);
 
-        densab[i] = densa[i];
-        //PROFILE_FLOPS(norb[i]*norb[i]);
-        axpy(norb[i]*norb[i], 1.0, densb[i].data(), 1, densab[i].data(), 1);
+        copy(densa[i].begin(), densa[i].end(), dsa.begin()+off[i]);
+        copy(densb[i].begin(), densb[i].end(), dsb.begin()+off[i]);
+    }
+
+    //PROFILE_FLOPS(nfock);
+    for (int64_t p = 0;p < nfock;p++) dst[p] = dsa[p]+dsb[p];
 
-        if (Da.norm(2) > 1e-10)
+    /*
+     * dmax(a,b) = max |Da(pq)|+|Db(pq)| for p in shell a, q in shell b
+     */
+    vector<T> dmax(nshell*nshell, (T)0);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int a = 0;a < nshell;a++)
+    {
+        for (int b = 0;b < nshell;b++)
         {
-            //fill(focka[i].begin(), focka[i].end(), 0.0);
-            //fill(fockb[i].begin(), fockb[i].end(), 0.0);
+            T& m = dmax[a+b*nshell];
+
+            for (int i = 0;i < nirrep;i++)
+            {
+                int na = shells[a].getNFuncInIrrep(i)*shells[a].getNContr();
+                int nb = shells[b].getNFuncInIrrep(i)*shells[b].getNContr();
+                int p0 = shell_idx[a][i]-start[i];
+                int q0 = shell_idx[b][i]-start[i];
+
+                for (int q = q0;q < q0+nb;q++)
+                {
+                    for (int p = p0;p < p0+na;p++)
+                    {
+                        int64_t pq = off[i]+p+q*norb[i];
+                        m = max(m, aquarius::abs(dsa[pq])+aquarius::abs(dsb[pq]));
+                    }
+                }
+            }
         }
     }
 
+    /*
+     * Integrals from other sources may not carry shell quartet information,
+     * in which case the list is just split up evenly and not screened
+     */
     auto& eris = ints.ints;
     auto& idxs = ints.idxs;
     size_t neris = eris.size();
     assert(eris.size() == idxs.size());
 
+    bool screen = !ints.blocks.empty();
+    vector<ERI::Block> chunks;
+    if (!screen)
+    {
+        for (size_t n0 = 0;n0 < neris;n0 += TMP_BUFSIZE)
+            chunks.emplace_back(0, 0, 0, 0, n0, min((size_t)TMP_BUFSIZE, neris-n0), 0.0);
+    }
+    const vector<ERI::Block>& blocks = (screen ? ints.blocks : chunks);
+    int64_t nblock = blocks.size();
+
+    int nt_max = omp_get_max_threads();
+    vector<T> fock_local(2*nfock*nt_max);
+
     int64_t flops = 0;
     #pragma omp parallel reduction(+:flops)
     {
         int nt = omp_get_num_threads();
         int tid = omp_get_thread_num();
-        size_t n0 = (neris*tid)/nt;
-        size_t n1 = (neris*(tid+1))/nt;
-
-        vector<vector<T>> focka_local(nirrep);
-        vector<vector<T>> fockb_local(nirrep);
 
-        for (int i = 0;i < nirrep;i++)
-        {
-            focka_local[i].resize(norb[i]*norb[i], (T)0);
-            fockb_local[i].resize(norb[i]*norb[i], (T)0);
-        }
+        T* focka_local = fock_local.data()+2*nfock*tid;
+        T* fockb_local = focka_local+nfock;
 
-        auto iidx = idxs.begin()+n0;
-        auto iend = idxs.begin()+n1;
-        auto iint = eris.begin()+n0;
-        for (;iidx != iend;++iidx, ++iint)
+        #pragma omp for schedule(dynamic)
+        for (int64_t blk = 0;blk < nblock;blk++)
         {
-            int irri = irrep[iidx->i];
-            int irrj = irrep[iidx->j];
-            int irrk = irrep[iidx->k];
-            int irrl = irrep[iidx->l];
+            const ERI::Block& block = blocks[blk];
 
-            if (irri != irrj && irri != irrk && irri != irrl) continue;
+            if (screen)
+            {
+                int a = block.a, b = block.b, c = block.c, d = block.d;
 
-            int i = iidx->i-start[irri];
-            int j = iidx->j-start[irrj];
-            int k = iidx->k-start[irrk];
-            int l = iidx->l-start[irrl];
+                T bound = max(max(max(dmax[a+b*nshell], dmax[c+d*nshell]),
+                                  max(dmax[a+c*nshell], dmax[a+d*nshell])),
+                                  max(dmax[b+c*nshell], dmax[b+d*nshell]));
 
-            /*
-            if (i < j)
-            {
-                swap(i, j);
-            }
-            if (k < l)
-            {
-                swap(k, l);
+                if (2*block.max*bound < fock_cutoff) continue;
             }
-            if (i < k || (i == k && j < l))
+
+            auto iidx = idxs.begin()+block.start;
+            auto iint = eris.begin()+block.start;
+            for (size_t n = 0;n < block.size;++n, ++iidx, ++iint)
             {
-                swap(i, k);
-                swap(j, l);
-            }
-            printf("%d %d %d %d %25.15e\n", i+1, j+1, k+1, l+1, eris[n].value);
-            */
+                int irri = irrep[iidx->i];
+                int irrj = irrep[iidx->j];
+                int irrk = irrep[iidx->k];
+                int irrl = irrep[iidx->l];
 
-            bool ieqj = i == j && irri == irrj;
-            bool keql = k == l && irrk == irrl;
-            bool ijeqkl = i == k && irri == irrk && j == l && irrj == irrl;
+                if (irri != irrj && irri != irrk && irri != irrl) continue;
 
-            //cout << irri << " " << irrj << " " << irrk << " " << irrl << " "
-            //        << i << " " << j << " " << k << " " << l << endl;
+                int i = local[iidx->i];
+                int j = local[iidx->j];
+                int k = local[iidx->k];
+                int l = local[iidx->l];
 
-            /*
-             * Exchange contribution: Fa(ac) -= Da(bd)*(ab|cd)
-             */
+                bool ieqj = i == j && irri == irrj;
+                bool keql = k == l && irrk == irrl;
+                bool ijeqkl = i == k && irri == irrk && j == l && irrj == irrl;
 
-            T e = 2.0*(*iint)*(ijeqkl ? 0.5 : 1.0);
+                /*
+                 * Exchange contribution: Fa(ac) -= Da(bd)*(ab|cd)
+                 */
 
-            if (irri == irrk && irrj == irrl)
-            {
-                flops += 4;;
-                focka_local[irri][i+k*norb[irri]] -= densa[irrj][j+l*norb[irrj]]*e;
-                fockb_local[irri][i+k*norb[irri]] -= densb[irrj][j+l*norb[irrj]]*e;
-            }
-            if (!keql && irri == irrl && irrj == irrk)
-            {
-                flops += 4;;
-                focka_local[irri][i+l*norb[irri]] -= densa[irrj][j+k*norb[irrj]]*e;
-                fockb_local[irri][i+l*norb[irri]] -= densb[irrj][j+k*norb[irrj]]*e;
-            }
-            if (!ieqj)
-            {
-                if (irri == irrl && irrj == irrk)
+                T e = 2.0*(*iint)*(ijeqkl ? 0.5 : 1.0);
+
+                if (irri == irrk && irrj == irrl)
                 {
-                    flops += 4;;
-                    focka_local[irrj][j+k*norb[irrj]] -= densa[irri][i+l*norb[irri]]*e;
-                    fockb_local[irrj][j+k*norb[irrj]] -= densb[irri][i+l*norb[irri]]*e;
+                    int64_t ik = off[irri]+i+k*norb[irri];
+                    int64_t jl = off[irrj]+j+l*norb[irrj];
+                    flops += 4;
+                    focka_local[ik] -= dsa[jl]*e;
+                    fockb_local[ik] -= dsb[jl]*e;
+
+                    if (!ieqj && !keql)
+                    {
+                        flops += 4;
+                        focka_local[jl] -= dsa[ik]*e;
+                        fockb_local[jl] -= dsb[ik]*e;
+                    }
                 }
-                if (!keql && irri == irrk && irrj == irrl)
+                if (irri == irrl && irrj == irrk)
                 {
-                    flops += 4;;
-                    focka_local[irrj][j+l*norb[irrj]] -= densa[irri][i+k*norb[irri]]*e;
-                    fockb_local[irrj][j+l*norb[irrj]] -= densb[irri][i+k*norb[irri]]*e;
+                    int64_t il = off[irri]+i+l*norb[irri];
+                    int64_t jk = off[irrj]+j+k*norb[irrj];
+
+                    if (!keql)
+                    {
+                        flops += 4;
+                        focka_local[il] -= dsa[jk]*e;
+                        fockb_local[il] -= dsb[jk]*e;
+                    }
+                    if (!ieqj)
+                    {
+                        flops += 4;
+                        focka_local[jk] -= dsa[il]*e;
+                        fockb_local[jk] -= dsb[il]*e;
+                    }
                 }
-            }
 
-            /*
-             * Coulomb contribution: Fa(ab) += [Da(cd)+Db(cd)]*(ab|cd)
-             */
+                /*
+                 * Coulomb contribution: Fa(ab) += [Da(cd)+Db(cd)]*(ab|cd)
+                 */
 
-            e = 2.0*e*(keql ? 0.5 : 1.0)*(ieqj ? 0.5 : 1.0);
+                e = 2.0*e*(keql ? 0.5 : 1.0)*(ieqj ? 0.5 : 1.0);
 
-            if (irri == irrj && irrk == irrl)
-            {
-                flops += 6;;
-                focka_local[irri][i+j*norb[irri]] += densab[irrk][k+l*norb[irrk]]*e;
-                fockb_local[irri][i+j*norb[irri]] += densab[irrk][k+l*norb[irrk]]*e;
-                focka_local[irrk][k+l*norb[irrk]] += densab[irri][i+j*norb[irri]]*e;
-                fockb_local[irrk][k+l*norb[irrk]] += densab[irri][i+j*norb[irri]]*e;
+                if (irri == irrj && irrk == irrl)
+                {
+                    int64_t ij = off[irri]+i+j*norb[irri];
+                    int64_t kl = off[irrk]+k+l*norb[irrk];
+                    flops += 6;
+                    focka_local[ij] += dst[kl]*e;
+                    fockb_local[ij] += dst[kl]*e;
+                    focka_local[kl] += dst[ij]*e;
+                    fockb_local[kl] += dst[ij]*e;
+                }
             }
         }
 
-        #pragma omp critical
+        /*
+         * Sum the thread-private contributions (the implicit barrier
+         * above guarantees that they are complete)
+         */
+        #pragma omp for
+        for (int64_t p = 0;p < 2*nfock;p++)
         {
-            for (int irr = 0;irr < nirrep;irr++)
-            {
-                flops += 2*norb[irr]*norb[irr];
-                axpy(norb[irr]*norb[irr], (T)1, focka_local[irr].data(), 1, focka[irr].data(), 1);
-                axpy(norb[irr]*norb[irr], (T)1, fockb_local[irr].data(), 1, fockb[irr].data(), 1);
-            }
+            T sum = 0;
+            for (int t = 0;t < nt;t++) sum += fock_local[p+2*nfock*t];
+            fock[p] += sum;
+            flops += nt;
         }
     }
     //PROFILE_FLOPS(flops);
 
     for (int irr = 0;irr < nirrep;irr++)
     {
-        //PROFILE_FLOPS(2*norb[irr]*(norb[irr]-1));
-        for (int i = 0;i < norb[irr];i++)
+        //PROFILE_FLOPS(4*norb[irr]*(norb[irr]-1));
+        for (int s = 0;s < 2;s++)
         {
-            for (int j = 0;j < i;j++)
+            T* f = fock.data()+off[irr]+s*nfock;
+
+            for (int i = 0;i < norb[irr];i++)
             {
-                focka[irr][i+j*norb[irr]] = 0.5*(focka[irr][i+j*norb[irr]]+focka[irr][j+i*norb[irr]]);
-                focka[irr][j+i*norb[irr]] = focka[irr][i+j*norb[irr]];
-                fockb[irr][i+j*norb[irr]] = 0.5*(fockb[irr][i+j*norb[irr]]+fockb[irr][j+i*norb[irr]]);
-                fockb[irr][j+i*norb[irr]] = fockb[irr][i+j*norb[irr]];
+                for (int j = 0;j < i;j++)
+                {
+                    f[i+j*norb[irr]] = 0.5*(f[i+j*norb[irr]]+f[j+i*norb[irr]]);
+                    f[j+i*norb[irr]] = f[i+j*norb[irr]];
+                }
             }
         }
     }
 
-    for (int i = 0;i < nirrep;i++)
+    /*
+     * Reduce all irreps of both spin cases in one collective
+     */
+    //PROFILE_FLOPS(2*nfock);
+    if (arena.rank == 0)
+    {
+        arena.comm().Reduce(fock, MPI_SUM);
+    }
+    else
     {
-        vector<int> irreps(2,i);
+        arena.comm().Reduce(fock, MPI_SUM, 0);
+    }
 
+    for (int i = 0;i < nirrep;i++)
+    {
         if (arena.rank == 0)
         {
-            //PROFILE_FLOPS(2*norb[i]*norb[i]);
-            arena.comm().Reduce(focka[i], MPI_SUM);
-            arena.comm().Reduce(fockb[i], MPI_SUM);
-
             vector<tkv_pair<T>> pairs(norb[i]*norb[i]);
 
             for (int p = 0;p < norb[i]*norb[i];p++)
             {
-                pairs[p].d = focka[i][p];
+                pairs[p].d = fock[off[i]+p];
                 pairs[p].k = p;
             }
 
-            Fa.writeRemoteData(irreps, pairs);
+            Fa.writeRemoteData(irreps[i], pairs);
 
             for (int p = 0;p < norb[i]*norb[i];p++)
             {
-                pairs[p].d = fockb[i][p];
+                pairs[p].d = fock[off[i]+nfock+p];
                 pairs[p].k = p;
             }
 
-            Fb.writeRemoteData(irreps, pairs);
+            Fb.writeRemoteData(irreps[i], pairs);
         }
         else
         {
-            //PROFILE_FLOPS(2*norb[i]*norb[i]);
-            arena.comm().Reduce(focka[i], MPI_SUM, 0);
-            arena.comm().Reduce(fockb[i], MPI_SUM, 0);
-
-            Fa.writeRemoteData(irreps);
-            Fb.writeRemoteData(irreps);
+            Fa.writeRemoteData(irreps[i]);
+            Fb.writeRemoteData(irreps[i]);
         }
     }
 }
@@ -267,12 +350,30 @@ static const char* spec = R"(
 
     frozen_core?
         bool false,
+    fock_cutoff?
+        double 1e-14,
     convergence?
         double 1e-12,
     max_iterations?
         int 150,
     conv_type?
         enum { MAXE, RMSE, MAE },
+    level_shift?
+    {
+        shift?
+            double 0.0,
+        end?
+            double 1e-2
+    },
+    soscf?
+    {
+        start?
+            double 0.0,
+        order?
+            int 8,
+        max_step?
+            double 0.5
+    },
     diis?
     {
         damping?
@@ -282,7 +383,13 @@ static const char* spec = R"(
         order?
             int 6,
         jacobi?
-            bool false
+            bool false,
+        ediis?
+            enum { NONE, EDIIS, ADIIS },
+        ediis_start?
+            double 1e-1,
+        ediis_end?
+            double 1e-4
     }
 
 )";
@@ -17,6 +17,8 @@ template <typename T, template <typename T_> class WhichUHF>
 class AOUHF : public WhichUHF<T>
 {
     protected:
+        double fock_cutoff;
+
         void buildFock();
 
     public:
@@ -13,52 +13,24 @@ namespace scf
 
 template <typename T, template <typename T_> class WhichUHF>
 CholeskyUHF<T,WhichUHF>::CholeskyUHF(const string& name, Config& config)
-: WhichUHF<T>(name, config)
+: WhichUHF<T>(name, config), batch_size(config.get<int>("batch_size"))
 {
-    for (Product& p : products)
+    for (vector<Product>::iterator i = this->products.begin();i != this->products.end();++i)
     {
-        p.addRequirement(Requirement("cholesky", "cholesky"));
+        i->addRequirement(Requirement("cholesky", "cholesky"));
     }
 }
 
 template <typename T, template <typename T_> class WhichUHF>
-bool CholeskyUHF<T,WhichUHF>::run(TaskDAG& dag, const Arena& arena)
+void CholeskyUHF<T,WhichUHF>::buildFock()
 {
-    const auto& molecule = this->template get<Molecule>("molecule");
+    const Molecule& molecule = this->template get<Molecule>("molecule");
     const auto& chol = this->template get<CholeskyIntegrals<T>>("cholesky");
 
     const PointGroup& group = molecule.getGroup();
-
     const vector<int>& norb = molecule.getNumOrbitals();
-    int nalpha = molecule.getNumAlphaElectrons();
-    int nbeta = molecule.getNumAlphaElectrons();
-
-    vector<int> shapeN{NS};
-    vector<int> shapeNNN{NS,NS,NS};
-    vector<vector<int>> sizer{{chol.getRank()}};
-    vector<vector<int>> sizenOr{norb,{nalpha},{chol.getRank()}};
-    vector<vector<int>> sizenor{norb,{nbeta},{chol.getRank()}};
-
-    this->puttmp("J",       new SymmetryBlockedTensor<T>("J",    arena, group, 1, sizer,   shapeN,   false));
-    this->puttmp("JD",      new SymmetryBlockedTensor<T>("JD",   arena, group, 1, sizer,   shapeN,   false));
-    this->puttmp("La_occ",  new SymmetryBlockedTensor<T>("LpI",  arena, group, 3, sizenOr, shapeNNN, false));
-    this->puttmp("Lb_occ",  new SymmetryBlockedTensor<T>("Lpi",  arena, group, 3, sizenor, shapeNNN, false));
-    this->puttmp("LDa_occ", new SymmetryBlockedTensor<T>("LDpI", arena, group, 3, sizenOr, shapeNNN, false));
-    this->puttmp("LDb_occ", new SymmetryBlockedTensor<T>("LDpi", arena, group, 3, sizenor, shapeNNN, false));
-
-    return UHF<T>::run(dag, arena);
-}
-
-template <typename T, template <typename T_> class WhichUHF>
-void CholeskyUHF<T,WhichUHF>::buildFock()
-{
-    const auto& molecule = this->template get<Molecule>("molecule");
-
-    const vector<int>& norb = molecule.getNumOrbitals();
-    int nalpha = molecule.getNumAlphaElectrons();
-    int nbeta = molecule.getNumAlphaElectrons();
-
-    const auto& chol = this->template get<CholeskyIntegrals<T>>("cholesky");
+    int nirrep = group.getNumIrreps();
+    int R = chol.getRank();
 
     auto& H  = this->template get<SymmetryBlockedTensor<T>>("H");
     auto& Da = this->template get<SymmetryBlockedTensor<T>>("Da");
@@ -66,69 +38,141 @@ void CholeskyUHF<T,WhichUHF>::buildFock()
     auto& Fa = this->template get<SymmetryBlockedTensor<T>>("Fa");
     auto& Fb = this->template get<SymmetryBlockedTensor<T>>("Fb");
 
+    Arena& arena = H.arena;
+
+    vector<int> zero(nirrep, 0);
+    vector<int> shapeN{NS};
+    vector<int> shapeNN{NS,NS};
+    vector<int> shapeNNN{NS,NS,NS};
+
     SymmetryBlockedTensor<T> Ca_occ("CI", this->template gettmp<SymmetryBlockedTensor<T>>("Ca"),
-                                    {{0},{0}}, {norb,{nalpha}});
+                                    {zero,zero}, {norb,this->occ_alpha}, true);
     SymmetryBlockedTensor<T> Cb_occ("Ci", this->template gettmp<SymmetryBlockedTensor<T>>("Cb"),
-                                    {{0},{0}}, {norb,{nbeta}});
-
-    auto& J       = this->template gettmp<SymmetryBlockedTensor<T>>("J");
-    auto& JD      = this->template gettmp<SymmetryBlockedTensor<T>>("JD");
-    auto& La_occ  = this->template gettmp<SymmetryBlockedTensor<T>>("La_occ");
-    auto& Lb_occ  = this->template gettmp<SymmetryBlockedTensor<T>>("Lb_occ");
-    auto& LDa_occ = this->template gettmp<SymmetryBlockedTensor<T>>("LDa_occ");
-    auto& LDb_occ = this->template gettmp<SymmetryBlockedTensor<T>>("LDb_occ");
+                                    {zero,zero}, {norb,this->occ_beta}, true);
 
-    /*
-     * Coulomb contribution:
-     *
-     * F[ab] = (Da[cd]+Db[cd])*(ab|cd)
-     *
-     *       = (Da[cd]+Db[cd])*L[abJ]*D[J]*L[cdJ]
-     *
-     *       = L(abJ)*{D[J]*{(Da[cd]+Db[cd])*L[cdJ]}}
-     *
-     *       = L(abJ)*{D[J]*J[J]}
-     */
-    Da += Db;
-    J["J"] = chol.getL()["cdJ"]*Da["cd"];
-    JD["J"] = chol.getD()["J"]*J["J"];
-    Da -= Db;
-    Fa["ab"] = JD["J"]*chol.getL()["abJ"];
+    SymmetryBlockedTensor<T> Dab("D", Da);
+    Dab += Db;
 
     /*
-     * Core contribution:
-     *
-     * F += H
-     *
-     * Up though this point, Fa = Fb
+     * Core contribution
      */
-    Fa += H;
-    Fb  = Fa;
+    Fa = H;
+    Fb = H;
 
     /*
-     * Exchange contribution:
-     *
-     * Fa[ab] -= Da[cd]*(ac|bd)
-     *
-     *         = C[ci]*C[di]*L[acJ]*D[J]*L[bdJ]
-     *
-     *         = {C[ci]*L[acJ]}*{D[J]*{C[di]*L[bdJ]}}
-     *
-     *         = L[aiJ]*{D[J]*L[biJ]}
+     * The Cholesky vectors are processed in batches of at most batch_size,
+     * so that only batch_size*N^2 of L is held at once besides L itself
      */
-    La_occ["aiJ"] = chol.getL()["acJ"]*Ca_occ["ci"];
-    LDa_occ["aiJ"] = chol.getD()["J"]*La_occ["aiJ"];
-    Fa["ab"] -= LDa_occ["aiJ"]*La_occ["biJ"];
+    int nbatch = (batch_size > 0 ? batch_size : R);
 
-    Lb_occ["aiJ"] = chol.getL()["acJ"]*Cb_occ["ci"];
-    LDb_occ["aiJ"] = chol.getD()["J"]*Lb_occ["aiJ"];
-    Fb["ab"] -= LDb_occ["aiJ"]*Lb_occ["biJ"];
+    for (int P0 = 0;P0 < R;P0 += nbatch)
+    {
+        int nP = min(nbatch, R-P0);
+
+        SymmetryBlockedTensor<T> L("L", chol.getL(), {zero,zero,{P0}}, {norb,norb,{nP}}, true);
+        SymmetryBlockedTensor<T> D("D", chol.getD(), {{P0}}, {{nP}}, true);
+
+        /*
+         * Coulomb contribution:
+         *
+         * F[ab] += (Da[cd]+Db[cd])*(ab|cd)
+         *
+         *        = L[abP]*{D[P]*{L[cdP]*(Da[cd]+Db[cd])}}
+         */
+        SymmetryBlockedTensor<T> J("J", arena, group, 1, {{nP}}, shapeN, false);
+        SymmetryBlockedTensor<T> JD("JD", arena, group, 1, {{nP}}, shapeN, false);
+        SymmetryBlockedTensor<T> Jab("Jab", arena, group, 2, {norb,norb}, shapeNN, false);
+
+        J["P"] = L["cdP"]*Dab["cd"];
+        JD["P"] = D["P"]*J["P"];
+        Jab["ab"] = JD["P"]*L["abP"];
+
+        Fa += Jab;
+        Fb += Jab;
+
+        /*
+         * Exchange contribution, through the occupied orbitals:
+         *
+         * F[ab] -= C[ci]*C[di]*(ac|bd)
+         *
+         *        = {C[ci]*L[acP]}*{D[P]*{C[di]*L[bdP]}}
+         *
+         *        = L[aiP]*{D[P]*L[biP]}
+         *
+         * which is O(N^2 o P) rather than O(N^3 P) for the density-based
+         * algorithm
+         */
+        for (int spin = 0;spin < 2;spin++)
+        {
+            const vector<int>& nocc = (spin == 0 ? this->occ_alpha : this->occ_beta);
+            const SymmetryBlockedTensor<T>& C_occ = (spin == 0 ? Ca_occ : Cb_occ);
+            SymmetryBlockedTensor<T>& F = (spin == 0 ? Fa : Fb);
+
+            SymmetryBlockedTensor<T>  L_occ( "LpI", arena, group, 3, {norb,nocc,{nP}}, shapeNNN, false);
+            SymmetryBlockedTensor<T> LD_occ("LDpI", arena, group, 3, {norb,nocc,{nP}}, shapeNNN, false);
+
+            L_occ["aiP"] = L["acP"]*C_occ["ci"];
+            LD_occ["aiP"] = D["P"]*L_occ["aiP"];
+            F["ab"] -= LD_occ["aiP"]*L_occ["biP"];
+        }
+    }
 }
 
 }
 }
 
+static const char* spec = R"(
+
+    frozen_core?
+        bool false,
+    batch_size?
+        int 512,
+    convergence?
+        double 1e-12,
+    max_iterations?
+        int 150,
+    conv_type?
+        enum { MAXE, RMSE, MAE },
+    level_shift?
+    {
+        shift?
+            double 0.0,
+        end?
+            double 1e-2
+    },
+    soscf?
+    {
+        start?
+            double 0.0,
+        order?
+            int 8,
+        max_step?
+            double 0.5
+    },
+    diis?
+    {
+        damping?
+            double 0.0,
+        start?
+            int 8,
+        order?
+            int 6,
+        jacobi?
+            bool false,
+        ediis?
+            enum { NONE, EDIIS, ADIIS },
+        ediis_start?
+            double 1e-1,
+        ediis_end?
+            double 1e-4
+    }
+
+)";
+
 INSTANTIATE_SPECIALIZATIONS_2(aquarius::scf::CholeskyUHF, aquarius::scf::LocalUHF);
+REGISTER_TASK(CONCAT(aquarius::scf::CholeskyUHF<double,aquarius::scf::LocalUHF>), "localcholeskyscf",spec);
+
+#if HAVE_ELEMENTAL
 INSTANTIATE_SPECIALIZATIONS_2(aquarius::scf::CholeskyUHF, aquarius::scf::ElementalUHF);
-REGISTER_TASK(aquarius::scf::CholeskyUHF<double,LocalUHF>, "localcholeskyuhf");
-REGISTER_TASK(aquarius::scf::CholeskyUHF<double,ElementalUHF>, "elementalcholeskyuhf");
+REGISTER_TASK(CONCAT(aquarius::scf::CholeskyUHF<double,aquarius::scf::ElementalUHF>), "elementalcholeskyscf",spec);
+#endif
@@ -5,7 +5,8 @@
 
 #include "integrals/cholesky.hpp"
 
-#include "uhf.hpp"
+#include "uhf_local.hpp"
+#include "uhf_elemental.hpp"
 
 namespace aquarius
 {
@@ -15,13 +16,13 @@ namespace scf
 template <typename T, template <typename T_> class WhichUHF>
 class CholeskyUHF : public WhichUHF<T>
 {
-    public:
-        CholeskyUHF(const string& name, input::Config& config);
-
-        bool run(task::TaskDAG& dag, const Arena& arena);
-
     protected:
+        int batch_size;
+
         void buildFock();
+
+    public:
+        CholeskyUHF(const string& name, input::Config& config);
 };
 
 }
@@ -0,0 +1,424 @@
+#include "fdgradient.hpp"
+
+#include "integrals/ovi.hpp"
+#include "integrals/kei.hpp"
+#include "integrals/nai.hpp"
+#include "integrals/os.hpp"
+
+using namespace aquarius::input;
+using namespace aquarius::integrals;
+using namespace aquarius::symmetry;
+using namespace aquarius::task;
+using namespace aquarius::tensor;
+
+namespace aquarius
+{
+namespace scf
+{
+
+FDGradient::FDGradient(const string& name, Config& config)
+: Task(name, config), step(config.get<double>("step")), cutoff(config.get<double>("cutoff"))
+{
+    vector<Requirement> reqs;
+    reqs += Requirement("molecule", "molecule");
+    reqs += Requirement("Da", "Da");
+    reqs += Requirement("Db", "Db");
+    reqs += Requirement("Fa", "Fa");
+    reqs += Requirement("Fb", "Fb");
+    addProduct(Product("gradient", "gradient", reqs));
+    addProduct(Product("double", "norm", reqs));
+}
+
+array<vector<double>,3> FDGradient::derivative(const vec3& pos,
+    const std::function<vector<double>(const vec3&)>& ints) const
+{
+    array<vector<double>,3> deriv;
+
+    for (int x = 0;x < 3;x++)
+    {
+        vec3 plus(pos), minus(pos);
+        plus[x] += step;
+        minus[x] -= step;
+
+        vector<double> ip = ints(plus);
+        vector<double> im = ints(minus);
+
+        deriv[x].resize(ip.size());
+        for (size_t k = 0;k < ip.size();k++) deriv[x][k] = (ip[k]-im[k])/(2*step);
+    }
+
+    return deriv;
+}
+
+static double dot(const vector<double>& a, const vector<double>& b)
+{
+    assert(a.size() == b.size());
+    double sum = 0;
+    for (size_t k = 0;k < a.size();k++) sum += a[k]*b[k];
+    return sum;
+}
+
+bool FDGradient::run(TaskDAG& dag, const Arena& arena)
+{
+    const auto& molecule = get<Molecule>("molecule");
+    const PointGroup& group = molecule.getGroup();
+
+    if (group.getOrder() != 1)
+    {
+        error(arena) << "Finite-difference SCF gradients are only implemented without symmetry" << endl;
+        return false;
+    }
+
+    auto& Da = get<SymmetryBlockedTensor<double>>("Da");
+    auto& Db = get<SymmetryBlockedTensor<double>>("Db");
+    auto& Fa = get<SymmetryBlockedTensor<double>>("Fa");
+    auto& Fb = get<SymmetryBlockedTensor<double>>("Fb");
+
+    int n = molecule.getNumOrbitals()[0];
+
+    /*
+     * Energy-weighted density W = Da Fa Da + Db Fb Db
+     */
+    SymmetryBlockedTensor<double> W("W", Da);
+    SymmetryBlockedTensor<double> X("X", Da);
+    X["ab"]  = Fa["ac"]*Da["cb"];
+    W["ab"]  = Da["ac"]* X["cb"];
+    X["ab"]  = Fb["ac"]*Db["cb"];
+    W["ab"] += Db["ac"]* X["cb"];
+
+    vector<double> da, db, dt(n*n), w;
+    Da.getAllData({0,0}, da);
+    Db.getAllData({0,0}, db);
+    W.getAllData({0,0}, w);
+    assert(da.size() == n*n && db.size() == n*n && w.size() == n*n);
+    for (int pq = 0;pq < n*n;pq++) dt[pq] = da[pq]+db[pq];
+
+    Context ctx(Context::ISCF);
+    vector<vector<int>> idx = Shell::setupIndices(ctx, molecule);
+    vector<Shell> shells(molecule.getShellsBegin(), molecule.getShellsEnd());
+    int nshell = shells.size();
+
+    /*
+     * The atom on which each shell sits, and the nuclear charge of each atom
+     * alone (for the derivatives with respect to the nuclei)
+     */
+    vector<int> atom_of;
+    vector<vec3> pos;
+    vector<vector<PointCharge>> nuclei;
+    const vector<PointCharge>& external = molecule.getPointCharges();
+
+    for (auto& atom : molecule.getAtoms())
+    {
+        for (auto s = atom.getShellsBegin();s != atom.getShellsEnd();++s) atom_of.push_back(pos.size());
+        pos.push_back(atom.getCenter().getCenter(0));
+        nuclei.push_back(IshidaNAI::nuclearCharges({atom.getCenter()}));
+    }
+
+    int natom = pos.size();
+
+    /*
+     * AO index of function i, contraction e of each shell at [e+m*i]
+     */
+    vector<vector<int>> ao(nshell);
+    for (int a = 0;a < nshell;a++)
+    {
+        int m = shells[a].getNContr();
+        int f = shells[a].getNFunc();
+
+        ao[a].resize(m*f);
+        for (int i = 0;i < f;i++)
+        {
+            for (int e = 0;e < m;e++)
+            {
+                ao[a][e+m*i] = shells[a].getIndex(ctx, idx[a], i, e, 0);
+            }
+        }
+    }
+
+    vector<double> grad(3*natom, 0.0);
+
+    /*
+     * Nuclear repulsion, including the external point charges
+     */
+    if (arena.rank == 0)
+    {
+        for (int i = 0;i < natom;i++)
+        {
+            double zi = molecule.getAtoms()[i].getCenter().getElement().getCharge();
+
+            for (int j = 0;j < natom;j++)
+            {
+                if (i == j) continue;
+                double zj = molecule.getAtoms()[j].getCenter().getElement().getCharge();
+                vec3 r = pos[i]-pos[j];
+                double r3 = pow(norm(r), 3);
+                for (int x = 0;x < 3;x++) grad[3*i+x] -= zi*zj*r[x]/r3;
+            }
+
+            for (auto& q : external)
+            {
+                vec3 r = pos[i]-q.pos;
+                double r3 = pow(norm(r), 3);
+                for (int x = 0;x < 3;x++) grad[3*i+x] -= zi*q.charge*r[x]/r3;
+            }
+        }
+    }
+
+    /*
+     * One-electron part: Dt.(T+V)^x - W.S^x
+     */
+    int ab = 0;
+    for (int a = 0;a < nshell;a++)
+    {
+        for (int b = 0;b <= a;b++)
+        {
+            bool mine = ab%arena.size == arena.rank;
+            ab++;
+            if (!mine) continue;
+
+            const Shell& sa = shells[a];
+            const Shell& sb = shells[b];
+            int ma = sa.getNContr(), fa = sa.getNFunc();
+            int mb = sb.getNContr(), fb = sb.getNFunc();
+            double fac = (a == b ? 1 : 2);
+
+            /*
+             * Densities in the order of the integrals, [e+ma*f][i+fa*j]
+             */
+            vector<double> dab(ma*mb*fa*fb), wab(ma*mb*fa*fb);
+            for (int j = 0;j < fb;j++)
+            {
+                for (int i = 0;i < fa;i++)
+                {
+                    for (int f = 0;f < mb;f++)
+                    {
+                        for (int e = 0;e < ma;e++)
+                        {
+                            int p = ao[a][e+ma*i];
+                            int q = ao[b][f+mb*j];
+                            int k = e+ma*(f+mb*(i+fa*j));
+                            dab[k] = fac*dt[p+q*n];
+                            wab[k] = fac* w[p+q*n];
+                        }
+                    }
+                }
+            }
+
+            const vec3& A = sa.getCenter().getCenter(0);
+            const vec3& B = sb.getCenter().getCenter(0);
+
+            IshidaOVI s(sa, sb);
+            IshidaKEI t(sa, sb);
+
+            auto dS = derivative(A, [&](const vec3& p) { return s.ao(p, B); });
+            auto dT = derivative(A, [&](const vec3& p) { return t.ao(p, B); });
+
+            for (int x = 0;x < 3;x++)
+            {
+                double g = dot(dab, dT[x])-dot(wab, dS[x]);
+                grad[3*atom_of[a]+x] += g;
+                grad[3*atom_of[b]+x] -= g;
+            }
+
+            /*
+             * Each nucleus separately, then all external charges together
+             */
+            for (int c = 0;c <= natom;c++)
+            {
+                const vector<PointCharge>& charges = (c < natom ? nuclei[c] : external);
+                if (charges.empty()) continue;
+
+                IshidaNAI v(sa, sb, charges);
+
+                auto dVA = derivative(A, [&](const vec3& p) { return v.ao(p, B); });
+                auto dVB = derivative(B, [&](const vec3& p) { return v.ao(A, p); });
+
+                for (int x = 0;x < 3;x++)
+                {
+                    double ga = dot(dab, dVA[x]);
+                    double gb = dot(dab, dVB[x]);
+                    grad[3*atom_of[a]+x] += ga;
+                    grad[3*atom_of[b]+x] += gb;
+                    if (c < natom) grad[3*c+x] -= ga+gb;
+                }
+            }
+        }
+    }
+
+    /*
+     * Schwarz bounds q(a,b) = max |(ab|ab)|^1/2 and density bounds
+     * d(a,b) = max(|Da+Db|,|Da|,|Db|) over each shell pair
+     */
+    vector<double> schwarz(nshell*nshell, 0.0);
+    vector<double> dmax(nshell*nshell, 0.0);
+
+    ab = 0;
+    for (int a = 0;a < nshell;a++)
+    {
+        for (int b = 0;b <= a;b++)
+        {
+            bool mine = ab%arena.size == arena.rank;
+            ab++;
+
+            for (int q : ao[b])
+            {
+                for (int p : ao[a])
+                {
+                    dmax[a+b*nshell] = max(dmax[a+b*nshell], max(aquarius::abs(dt[p+q*n]),
+                                           max(aquarius::abs(da[p+q*n]), aquarius::abs(db[p+q*n]))));
+                }
+            }
+            dmax[b+a*nshell] = dmax[a+b*nshell];
+
+            if (!mine) continue;
+
+            const vec3& A = shells[a].getCenter().getCenter(0);
+            const vec3& B = shells[b].getCenter().getCenter(0);
+
+            OSERI eri(shells[a], shells[b], shells[a], shells[b]);
+            double m = 0;
+            for (double v : eri.ao(A, B, A, B)) m = max(m, aquarius::abs(v));
+            schwarz[a+b*nshell] = schwarz[b+a*nshell] = sqrt(m);
+        }
+    }
+
+    arena.comm().Allreduce(schwarz.data(), nshell*nshell, MPI_SUM);
+
+    /*
+     * Two-electron part: G.(ab|cd)^x, with the separable two-particle density
+     *
+     * G(pq|rs) = 1/2 Dt(pq) Dt(rs) - 1/4 sum_s [Ds(pr) Ds(qs) + Ds(ps) Ds(qr)]
+     *
+     * which has the full permutational symmetry of the integrals, so that
+     * only unique quartets are visited
+     */
+    int abcd = 0;
+    for (int a = 0;a < nshell;a++)
+    {
+        for (int b = 0;b <= a;b++)
+        {
+            for (int c = 0;c <= a;c++)
+            {
+                int dlast = (a == c ? b : c);
+                for (int d = 0;d <= dlast;d++)
+                {
+                    bool mine = abcd%arena.size == arena.rank;
+                    abcd++;
+                    if (!mine) continue;
+
+                    double bound = schwarz[a+b*nshell]*schwarz[c+d*nshell]*
+                                   max(dmax[a+b*nshell]*dmax[c+d*nshell],
+                                   max(dmax[a+c*nshell]*dmax[b+d*nshell],
+                                       dmax[a+d*nshell]*dmax[b+c*nshell]));
+                    if (bound < cutoff) continue;
+
+                    const Shell& sa = shells[a];
+                    const Shell& sb = shells[b];
+                    const Shell& sc = shells[c];
+                    const Shell& sd = shells[d];
+                    int ma = sa.getNContr(), fa = sa.getNFunc();
+                    int mb = sb.getNContr(), fb = sb.getNFunc();
+                    int mc = sc.getNContr(), fc = sc.getNFunc();
+                    int md = sd.getNContr(), fd = sd.getNFunc();
+                    int nother = ma*mb*mc*md;
+
+                    double fac = (a == b ? 1 : 2)*(c == d ? 1 : 2)*(a == c && b == d ? 1 : 2);
+
+                    /*
+                     * G in the order of the integrals, [e+ma*(f+mb*(g+mc*h))][i+fa*(j+fb*(k+fc*l))]
+                     */
+                    vector<double> gabcd(nother*fa*fb*fc*fd);
+                    int ijkl = 0;
+                    for (int l = 0;l < fd;l++)
+                    {
+                        for (int k = 0;k < fc;k++)
+                        {
+                            for (int j = 0;j < fb;j++)
+                            {
+                                for (int i = 0;i < fa;i++, ijkl++)
+                                {
+                                    int efgh = 0;
+                                    for (int h = 0;h < md;h++)
+                                    {
+                                        for (int g = 0;g < mc;g++)
+                                        {
+                                            for (int f = 0;f < mb;f++)
+                                            {
+                                                for (int e = 0;e < ma;e++, efgh++)
+                                                {
+                                                    int p = ao[a][e+ma*i];
+                                                    int q = ao[b][f+mb*j];
+                                                    int r = ao[c][g+mc*k];
+                                                    int s = ao[d][h+md*l];
+
+                                                    gabcd[efgh+nother*ijkl] =
+                                                        fac*(0.5*dt[p+q*n]*dt[r+s*n]-
+                                                             0.25*(da[p+r*n]*da[q+s*n]+da[p+s*n]*da[q+r*n]+
+                                                                   db[p+r*n]*db[q+s*n]+db[p+s*n]*db[q+r*n]));
+                                                }
+                                            }
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+
+                    const vec3& A = sa.getCenter().getCenter(0);
+                    const vec3& B = sb.getCenter().getCenter(0);
+                    const vec3& C = sc.getCenter().getCenter(0);
+                    const vec3& D = sd.getCenter().getCenter(0);
+
+                    OSERI eri(sa, sb, sc, sd);
+
+                    auto dA = derivative(A, [&](const vec3& p) { return eri.ao(p, B, C, D); });
+                    auto dB = derivative(B, [&](const vec3& p) { return eri.ao(A, p, C, D); });
+                    auto dC = derivative(C, [&](const vec3& p) { return eri.ao(A, B, p, D); });
+
+                    for (int x = 0;x < 3;x++)
+                    {
+                        double ga = dot(gabcd, dA[x]);
+                        double gb = dot(gabcd, dB[x]);
+                        double gc = dot(gabcd, dC[x]);
+                        grad[3*atom_of[a]+x] += ga;
+                        grad[3*atom_of[b]+x] += gb;
+                        grad[3*atom_of[c]+x] += gc;
+                        grad[3*atom_of[d]+x] -= ga+gb+gc;
+                    }
+                }
+            }
+        }
+    }
+
+    arena.comm().Allreduce(grad.data(), 3*natom, MPI_SUM);
+
+    auto& gradient = put("gradient", new vector<vec3>(natom));
+
+    Logger::log(arena) << "Finite-difference gradient:" << endl;
+    for (int i = 0;i < natom;i++)
+    {
+        gradient[i] = vec3(grad[3*i], grad[3*i+1], grad[3*i+2]);
+        Logger::log(arena) << printos("%-3s % 18.12f % 18.12f % 18.12f",
+                                      molecule.getAtoms()[i].getCenter().getElement().getSymbol(),
+                                      grad[3*i], grad[3*i+1], grad[3*i+2]) << endl;
+    }
+
+    double& gnorm = put("norm", new double(sqrt(dot(grad, grad))));
+    Logger::log(arena) << printos("Finite-difference gradient norm: %18.12f", gnorm) << endl;
+
+    return true;
+}
+
+}
+}
+
+static const char* spec = R"(
+
+step?
+    double 1e-4,
+cutoff?
+    double 1e-12
+
+)";
+
+REGISTER_TASK(aquarius::scf::FDGradient,"fdscfgrad",spec);
@@ -0,0 +1,60 @@
+#ifndef _AQUARIUS_SCF_FDGRADIENT_HPP_
+#define _AQUARIUS_SCF_FDGRADIENT_HPP_
+
+#include "util/global.hpp"
+
+#include "task/task.hpp"
+#include "tensor/symblocked_tensor.hpp"
+#include "input/molecule.hpp"
+#include "input/config.hpp"
+#include "integrals/shell.hpp"
+
+namespace aquarius
+{
+namespace scf
+{
+
+/*
+ * Finite-difference check of the nuclear gradient of the UHF energy,
+ * computed in-process from the converged AO densities and Fock matrices.
+ * This is not an analytic gradient: the integral engines have no derivative
+ * integrals, so those are taken by finite differences, which costs several
+ * integral evaluations per shell block and is only accurate to about the
+ * square of the step size.
+ *
+ * The densities are contracted on the fly, shell block by shell block, with
+ * the derivative integrals, where the blocks are distributed round-robin
+ * over the arena and Schwarz-screened. The derivatives of the integrals
+ * with respect to the position of each shell are central differences of the
+ * AO integrals (with step size step), and those with respect to the last
+ * shell of a quartet and to the nuclei of the nuclear attraction follow from
+ * translational invariance. The result is the gradient of each atom in turn,
+ * in the standard orientation of the molecule, and its 2-norm (which does
+ * not depend on the orientation).
+ *
+ * Only the SCF reference is handled: correlated (CC) gradients need relaxed
+ * densities, which are not available, and still go through cfourgrad.
+ */
+class FDGradient : public task::Task
+{
+    protected:
+        double step;
+        double cutoff;
+
+        /*
+         * Derivatives of the integrals returned by ints with respect to pos,
+         * for each Cartesian direction
+         */
+        array<vector<double>,3> derivative(const vec3& pos,
+            const std::function<vector<double>(const vec3&)>& ints) const;
+
+    public:
+        FDGradient(const string& name, input::Config& config);
+
+        bool run(task::TaskDAG& dag, const Arena& arena);
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,280 @@
+#include "localize.hpp"
+
+using namespace aquarius::input;
+using namespace aquarius::integrals;
+using namespace aquarius::symmetry;
+using namespace aquarius::task;
+using namespace aquarius::tensor;
+using namespace aquarius::op;
+
+namespace aquarius
+{
+namespace scf
+{
+
+template <typename T>
+Localize<T>::Localize(const string& name, Config& config)
+: Task(name, config), convergence(config.get<double>("convergence")),
+  max_iterations(config.get<int>("max_iterations"))
+{
+    string type = config.get<string>("method");
+    if      (type == "BOYS"       ) method = BOYS;
+    else if (type == "PIPEK_MEZEY") method = PIPEK_MEZEY;
+
+    vector<Requirement> reqs;
+    reqs += Requirement("molecule", "molecule");
+    reqs += Requirement("occspace", "occ");
+    if (method == BOYS)
+    {
+        reqs += Requirement("aomultipole", "multipole");
+    }
+    else
+    {
+        reqs += Requirement("ovi", "S");
+    }
+    addProduct(Product("occspace", "occ", reqs));
+}
+
+template <typename T>
+void Localize<T>::localize(const Arena& arena, const string& spin, int nao, int n, vector<T>& C,
+                           const vector<vector<T>>& ao, const vector<int>& atom_of, int natom)
+{
+    if (n < 2) return;
+
+    /*
+     * MO matrices Q^k, each n*n
+     */
+    vector<vector<T>> Q;
+    vector<T> tmp(nao*n);
+
+    if (method == BOYS)
+    {
+        for (auto& A : ao)
+        {
+            Q.emplace_back(n*n);
+            gemm('N', 'N', nao, n, nao, 1.0, A.data(), nao,      C.data(), nao, 0.0, tmp.data(), nao);
+            gemm('T', 'N',   n, n, nao, 1.0, C.data(), nao, tmp.data(), nao, 0.0, Q.back().data(), n);
+        }
+    }
+    else
+    {
+        const vector<T>& S = ao[0];
+        gemm('N', 'N', nao, n, nao, 1.0, S.data(), nao, C.data(), nao, 0.0, tmp.data(), nao);
+
+        Q.assign(natom, vector<T>(n*n, 0.0));
+        for (int i = 0;i < n;i++)
+        {
+            for (int j = 0;j < n;j++)
+            {
+                for (int mu = 0;mu < nao;mu++)
+                {
+                    Q[atom_of[mu]][i+j*n] += 0.5*(C[mu+i*nao]*tmp[mu+j*nao]+
+                                                  C[mu+j*nao]*tmp[mu+i*nao]);
+                }
+            }
+        }
+    }
+
+    auto functional = [&]
+    {
+        T f = 0;
+        for (auto& q : Q)
+            for (int i = 0;i < n;i++) f += q[i+i*n]*q[i+i*n];
+        return f;
+    };
+
+    log(arena) << spin << " functional before localization: " << scientific << setprecision(12) << functional() << endl;
+
+    int iter;
+    for (iter = 0;iter < max_iterations;iter++)
+    {
+        T change = 0;
+
+        for (int j = 1;j < n;j++)
+        {
+            for (int i = 0;i < j;i++)
+            {
+                T A = 0, B = 0;
+                for (auto& q : Q)
+                {
+                    T qij = q[i+j*n];
+                    T dq = q[i+i*n]-q[j+j*n];
+                    A += qij*qij-0.25*dq*dq;
+                    B += qij*dq;
+                }
+
+                T AB = sqrt(A*A+B*B);
+                if (A+AB < 1e-14) continue;
+                change = max(change, A+AB);
+
+                /*
+                 * i' = c i + s j, j' = -s i + c j, with cos(4a) = -A/AB and
+                 * sin(4a) = B/AB, which raises the functional by A+AB
+                 */
+                T alpha = 0.25*atan2(B, -A);
+                T c = cos(alpha);
+                T s = sin(alpha);
+
+                for (int mu = 0;mu < nao;mu++)
+                {
+                    T ci = C[mu+i*nao];
+                    T cj = C[mu+j*nao];
+                    C[mu+i*nao] =  c*ci+s*cj;
+                    C[mu+j*nao] = -s*ci+c*cj;
+                }
+
+                for (auto& q : Q)
+                {
+                    for (int m = 0;m < n;m++)
+                    {
+                        T qi = q[m+i*n];
+                        T qj = q[m+j*n];
+                        q[m+i*n] =  c*qi+s*qj;
+                        q[m+j*n] = -s*qi+c*qj;
+                    }
+
+                    for (int m = 0;m < n;m++)
+                    {
+                        T qi = q[i+m*n];
+                        T qj = q[j+m*n];
+                        q[i+m*n] =  c*qi+s*qj;
+                        q[j+m*n] = -s*qi+c*qj;
+                    }
+                }
+            }
+        }
+
+        if (change < convergence) break;
+    }
+
+    if (iter == max_iterations)
+    {
+        warn(arena) << spin << " localization did not converge in " << max_iterations << " sweeps" << endl;
+    }
+
+    log(arena) << spin << " functional after " << iter << " sweeps: " << scientific << setprecision(12) << functional() << endl;
+}
+
+template <typename T>
+bool Localize<T>::run(TaskDAG& dag, const Arena& arena)
+{
+    const auto& molecule = get<Molecule>("molecule");
+    const PointGroup& group = molecule.getGroup();
+
+    if (group.getOrder() != 1)
+    {
+        error(arena) << "Orbital localization is only implemented without symmetry" << endl;
+        return false;
+    }
+
+    /*
+     * The product has the same name as the canonical orbitals, so get()
+     * would find it instead; take the orbitals from the requirement
+     */
+    const MOSpace<T>* occ_ = NULL;
+    for (Requirement& r : getProduct("occ").getRequirements())
+    {
+        if (r.getName() == "occ") occ_ = &r.get().get<MOSpace<T>>();
+    }
+    assert(occ_);
+    const auto& occ = *occ_;
+
+    int nao = occ.nao[0];
+    int nI = occ.nalpha[0];
+    int ni = occ.nbeta[0];
+
+    /*
+     * The atom of each AO, for the Mulliken charges
+     */
+    Context ctx(Context::ISCF);
+    vector<vector<int>> idx = Shell::setupIndices(ctx, molecule);
+    vector<int> atom_of(nao);
+    int natom = 0;
+    int a = 0;
+
+    for (auto& atom : molecule.getAtoms())
+    {
+        for (auto s = atom.getShellsBegin();s != atom.getShellsEnd();++s, ++a)
+        {
+            for (int i = 0;i < s->getNFunc();i++)
+            {
+                for (int e = 0;e < s->getNContr();e++)
+                {
+                    atom_of[s->getIndex(ctx, idx[a], i, e, 0)] = natom;
+                }
+            }
+        }
+        natom++;
+    }
+
+    vector<vector<T>> ao;
+
+    if (method == BOYS)
+    {
+        const auto& multipole = get<unique_vector<OneElectronIntegral>>("multipole");
+
+        for (int xyz = 0;xyz < 3;xyz++)
+        {
+            ao.emplace_back();
+            multipole[xyz].getAllData({0,0}, ao.back());
+        }
+    }
+    else
+    {
+        ao.emplace_back();
+        get<SymmetryBlockedTensor<T>>("S").getAllData({0,0}, ao.back());
+    }
+
+    vector<T> CI, Ci;
+    occ.Calpha.getAllData({0,0}, CI);
+    occ.Cbeta.getAllData({0,0}, Ci);
+    assert(CI.size() == nao*nI && Ci.size() == nao*ni);
+
+    /*
+     * Every process localizes the same orbitals, so there is nothing to
+     * reconcile afterwards
+     */
+    localize(arena, "Alpha", nao, nI, CI, ao, atom_of, natom);
+    localize(arena, "Beta", nao, ni, Ci, ao, atom_of, natom);
+
+    SymmetryBlockedTensor<T> LI("LI", occ.Calpha);
+    SymmetryBlockedTensor<T> Li("Li", occ.Cbeta);
+
+    if (arena.rank == 0)
+    {
+        vector<tkv_pair<T>> pairs;
+
+        for (int k = 0;k < nao*nI;k++) pairs.emplace_back(k, CI[k]);
+        LI.writeRemoteData({0,0}, pairs);
+
+        pairs.clear();
+        for (int k = 0;k < nao*ni;k++) pairs.emplace_back(k, Ci[k]);
+        Li.writeRemoteData({0,0}, pairs);
+    }
+    else
+    {
+        LI.writeRemoteData({0,0});
+        Li.writeRemoteData({0,0});
+    }
+
+    put("occ", new MOSpace<T>(move(LI), move(Li)));
+
+    return true;
+}
+
+}
+}
+
+static const char* spec = R"!(
+
+method?
+    enum { BOYS, PIPEK_MEZEY },
+convergence?
+    double 1e-12,
+max_iterations?
+    int 100
+
+)!";
+
+INSTANTIATE_SPECIALIZATIONS(aquarius::scf::Localize);
+REGISTER_TASK(aquarius::scf::Localize<double>,"localize",spec);
@@ -0,0 +1,60 @@
+#ifndef _AQUARIUS_SCF_LOCALIZE_HPP_
+#define _AQUARIUS_SCF_LOCALIZE_HPP_
+
+#include "util/global.hpp"
+
+#include "task/task.hpp"
+#include "tensor/symblocked_tensor.hpp"
+#include "input/molecule.hpp"
+#include "input/config.hpp"
+#include "integrals/1eints.hpp"
+#include "operator/space.hpp"
+
+namespace aquarius
+{
+namespace scf
+{
+
+/*
+ * Localized occupied orbitals, by Boys or Pipek-Mezey localization of the
+ * (active) occupied space of each spin
+ *
+ *  S. F. Boys, Rev. Mod. Phys. 32, 296 (1960)
+ *  J. Pipek; P. G. Mezey, J. Chem. Phys. 90, 4916 (1989)
+ *
+ * Both maximize sum_k sum_i (Q^k_ii)^2, where Q^k are the MO matrices of
+ * the components of the dipole operator (Boys) or of the Mulliken charge
+ * of each atom (Pipek-Mezey), by Jacobi sweeps over pairs of orbitals
+ *  C. Edmiston; K. Ruedenberg, Rev. Mod. Phys. 35, 457 (1963)
+ *
+ * The virtual space is not touched. Localization breaks the point group
+ * symmetry, so only C1 is supported.
+ */
+template <typename T>
+class Localize : public task::Task
+{
+    protected:
+        enum Method {BOYS, PIPEK_MEZEY};
+
+        Method method;
+        double convergence;
+        int max_iterations;
+
+        /*
+         * Rotate the n columns of C (of length nao) to maximize the
+         * functional above, given the AO matrices of the operators (Boys)
+         * or of S and the atom of each function (Pipek-Mezey)
+         */
+        void localize(const Arena& arena, const string& spin, int nao, int n, vector<T>& C,
+                      const vector<vector<T>>& ao, const vector<int>& atom_of, int natom);
+
+    public:
+        Localize(const string& name, input::Config& config);
+
+        bool run(task::TaskDAG& dag, const Arena& arena);
+};
+
+}
+}
+
+#endif
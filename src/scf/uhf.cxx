@@ -16,8 +16,26 @@ namespace scf
 template <typename T>
 UHF<T>::UHF(const string& name, Config& config)
 : Iterative<T>(name, config), frozen_core(config.get<bool>("frozen_core")),
-  diis(config.get("diis"), 2)
+  diis(config.get("diis"), 2), error(0),
+  ediis_start(config.get<double>("diis.ediis_start")),
+  ediis_end(config.get<double>("diis.ediis_end")),
+  ediis_order(config.get<int>("diis.order")),
+  level_shift(config.get<double>("level_shift.shift")),
+  level_shift_end(config.get<double>("level_shift.end")),
+  soscf_start(config.get<double>("soscf.start")),
+  soscf_max_step(config.get<double>("soscf.max_step")),
+  soscf_order(config.get<int>("soscf.order"))
 {
+    string type = config.get<string>("diis.ediis");
+    if      (type == "NONE" ) ediis_type = NONE;
+    else if (type == "EDIIS") ediis_type = EDIIS;
+    else if (type == "ADIIS") ediis_type = ADIIS;
+    else assert(0);
+
+    ediis_x.resize(ediis_order);
+    ediis_E.resize(ediis_order);
+    ediis_DF.resize(ediis_order, vector<real_type_t<T>>(ediis_order));
+
     vector<Requirement> reqs;
     reqs += Requirement("molecule", "molecule");
     reqs += Requirement("ovi", "S");
@@ -194,13 +212,24 @@ void UHF<T>::iterate(const Arena& arena)
     const Molecule& molecule = this->template get<Molecule>("molecule");
 
     const vector<int>& norb = molecule.getNumOrbitals();
-    int norbtot = sum(norb);
     int nalpha = molecule.getNumAlphaElectrons();
     int nbeta = molecule.getNumBetaElectrons();
 
     buildFock();
+    calcGradient();
+
+    if (this->iter() > 1 && error < soscf_start && secondOrderStep())
+    {
+        calcEnergy();
+        Logger::log(arena) << "Iteration " << this->iter() << " second-order step" << endl;
+        calcDensity();
+        calcConvergence();
+        return;
+    }
+
     DIISExtrap();
     calcEnergy();
+    levelShift();
     diagonalizeFock();
 
     vector<pair<real_type_t<T>,int>> E_alpha_sorted;
@@ -234,6 +263,15 @@ void UHF<T>::iterate(const Arena& arena)
     Logger::log(arena) << "Iteration " << this->iter() << " occupation = " << occ_alpha << ", " << occ_beta << endl;
 
     calcDensity();
+    calcConvergence();
+}
+
+template <typename T>
+void UHF<T>::calcConvergence()
+{
+    const Molecule& molecule = this->template get<Molecule>("molecule");
+
+    int norbtot = sum(molecule.getNumOrbitals());
 
     auto& dDa = this->template gettmp<SymmetryBlockedTensor<T>>("dDa");
     auto& dDb = this->template gettmp<SymmetryBlockedTensor<T>>("dDb");
@@ -344,7 +382,7 @@ void UHF<T>::calcDensity()
 }
 
 template <typename T>
-void UHF<T>::DIISExtrap()
+void UHF<T>::calcGradient()
 {
     auto& S      = this->template get   <SymmetryBlockedTensor<T>>("S");
     auto& Smhalf = this->template gettmp<SymmetryBlockedTensor<T>>("S^-1/2");
@@ -399,10 +437,238 @@ void UHF<T>::DIISExtrap()
           dF["ab"] +=   tmp1["ac"]*Smhalf["cb"];
     }
 
+    error = dF.norm(00);
+}
+
+template <typename T>
+void UHF<T>::DIISExtrap()
+{
+    auto& dF = this->template gettmp<SymmetryBlockedTensor<T>>("dF");
+    auto& Fa = this->template get   <SymmetryBlockedTensor<T>>("Fa");
+    auto& Fb = this->template get   <SymmetryBlockedTensor<T>>("Fb");
+
+    if (ediis_type != NONE && error > ediis_end)
+    {
+        EDIISExtrap();
+        return;
+    }
+
     diis.extrapolate(ptr_vector<SymmetryBlockedTensor<T>>{&Fa, &Fb},
                      ptr_vector<SymmetryBlockedTensor<T>>{&dF});
 }
 
+/*
+ * Minimize f(c) = a.c + (1/2) c.B.c subject to c_i >= 0 and sum_i c_i = 1.
+ * Since there are only a handful of vectors, the stationary point of f on
+ * each face of the simplex is found directly and the lowest feasible one is
+ * kept; this also handles an indefinite B.
+ */
+template <typename T>
+static vector<T> minimizeOnSimplex(const vector<T>& a, const vector<vector<T>>& B)
+{
+    int n = a.size();
+
+    vector<T> best(n, 0);
+    best[0] = 1;
+    T fbest = numeric_limits<T>::max();
+
+    for (unsigned mask = 1;mask < (1u<<n);mask++)
+    {
+        vector<int> idx;
+        for (int i = 0;i < n;i++) if (mask & (1u<<i)) idx.push_back(i);
+        int m = idx.size();
+
+        /*
+         * [ B_SS 1 ] [ c ]   [ -a_S ]
+         * [ 1^T  0 ] [ l ] = [  1   ]
+         */
+        vector<T> kkt((m+1)*(m+1), 0);
+        vector<T> c(m+1);
+        vector<integer> ipiv(m+1);
+
+        for (int i = 0;i < m;i++)
+        {
+            for (int j = 0;j < m;j++) kkt[i+j*(m+1)] = B[idx[i]][idx[j]];
+            kkt[i+m*(m+1)] = 1;
+            kkt[m+i*(m+1)] = 1;
+            c[i] = -a[idx[i]];
+        }
+        c[m] = 1;
+
+        if (hesv('U', m+1, 1, kkt.data(), m+1, ipiv.data(), c.data(), m+1) != 0) continue;
+
+        bool feasible = true;
+        for (int i = 0;i < m;i++) if (c[i] < -1e-12) feasible = false;
+        if (!feasible) continue;
+
+        vector<T> x(n, 0);
+        for (int i = 0;i < m;i++) x[idx[i]] = max(c[i], (T)0);
+
+        T f = 0;
+        for (int i = 0;i < n;i++)
+        {
+            f += a[i]*x[i];
+            for (int j = 0;j < n;j++) f += 0.5*x[i]*B[i][j]*x[j];
+        }
+
+        if (f < fbest)
+        {
+            fbest = f;
+            best = x;
+        }
+    }
+
+    return best;
+}
+
+template <typename T>
+void UHF<T>::EDIISExtrap()
+{
+    typedef real_type_t<T> R;
+
+    const Molecule& molecule = this->template get<Molecule>("molecule");
+
+    auto& H  = this->template get<SymmetryBlockedTensor<T>>("H");
+    auto& Fa = this->template get<SymmetryBlockedTensor<T>>("Fa");
+    auto& Fb = this->template get<SymmetryBlockedTensor<T>>("Fb");
+    auto& Da = this->template get<SymmetryBlockedTensor<T>>("Da");
+    auto& Db = this->template get<SymmetryBlockedTensor<T>>("Db");
+
+    /*
+     * Move things around such that in iteration n, the data from
+     * iteration n-k is in slot k (as in DIIS)
+     */
+    rotate(ediis_x.begin(), ediis_x.end()-1, ediis_x.end());
+    rotate(ediis_E.begin(), ediis_E.end()-1, ediis_E.end());
+    rotate(ediis_DF.begin(), ediis_DF.end()-1, ediis_DF.end());
+    for (auto& row : ediis_DF) rotate(row.begin(), row.end()-1, row.end());
+
+    if (ediis_x[0].empty())
+    {
+        ediis_x[0].push_back(Fa);
+        ediis_x[0].push_back(Fb);
+        ediis_x[0].push_back(Da);
+        ediis_x[0].push_back(Db);
+    }
+    else
+    {
+        ediis_x[0][0] = Fa;
+        ediis_x[0][1] = Fb;
+        ediis_x[0][2] = Da;
+        ediis_x[0][3] = Db;
+    }
+
+    ediis_E[0]  = molecule.getNuclearRepulsion();
+    ediis_E[0] += 0.5*std::real(scalar(Da["ab"]*H["ab"]) + scalar(Da["ab"]*Fa["ab"]));
+    ediis_E[0] += 0.5*std::real(scalar(Db["ab"]*H["ab"]) + scalar(Db["ab"]*Fb["ab"]));
+
+    /*
+     * DF[i][j] = Tr[Da_i Fa_j] + Tr[Db_i Fb_j]
+     */
+    int n = 0;
+    while (n < ediis_order && !ediis_x[n].empty()) n++;
+
+    for (int i = 0;i < n;i++)
+    {
+        ediis_DF[0][i] = std::real(scalar(Da["ab"]*ediis_x[i][0]["ab"]) +
+                                   scalar(Db["ab"]*ediis_x[i][1]["ab"]));
+        ediis_DF[i][0] = std::real(scalar(ediis_x[i][2]["ab"]*Fa["ab"]) +
+                                   scalar(ediis_x[i][3]["ab"]*Fb["ab"]));
+    }
+
+    /*
+     * With D = sum_i c_i D_i, sum_i c_i = 1, the energy is exactly
+     *
+     *   EDIIS: E(c) = sum_i c_i E_i - 1/4 sum_ij c_i c_j Tr[(D_i-D_j)(F_i-F_j)]
+     *
+     * and to second order about the current density
+     *
+     *   ADIIS: E(c) = E_0 + sum_i c_i Tr[(D_i-D_0)F_0]
+     *                     + 1/2 sum_ij c_i c_j Tr[(D_i-D_0)(F_j-F_0)]
+     *
+     * with the trace including both spins.
+     */
+    const auto& DF = ediis_DF;
+    vector<R> a(n);
+    vector<vector<R>> B(n, vector<R>(n));
+
+    for (int i = 0;i < n;i++)
+    {
+        for (int j = 0;j < n;j++)
+        {
+            if (ediis_type == EDIIS)
+            {
+                B[i][j] = -0.5*(DF[i][i]+DF[j][j]-DF[i][j]-DF[j][i]);
+            }
+            else
+            {
+                B[i][j] = 0.5*(DF[i][j]+DF[j][i]-DF[i][0]-DF[0][i]-DF[j][0]-DF[0][j])+DF[0][0];
+            }
+        }
+
+        a[i] = (ediis_type == EDIIS ? ediis_E[i] : DF[i][0]-DF[0][0]);
+    }
+
+    vector<R> c = minimizeOnSimplex(a, B);
+
+    /*
+     * Pure EDIIS/ADIIS above ediis_start, and a linear switch to DIIS
+     * between ediis_start and ediis_end
+     */
+    R w = (error >= ediis_start ? 1 : (error-ediis_end)/(ediis_start-ediis_end));
+
+    SymmetryBlockedTensor<T> Fa_e("Fa", Fa);
+    SymmetryBlockedTensor<T> Fb_e("Fb", Fb);
+    Fa_e = (T)0;
+    Fb_e = (T)0;
+    for (int i = 0;i < n;i++)
+    {
+        Fa_e += ediis_x[i][0]*(T)c[i];
+        Fb_e += ediis_x[i][1]*(T)c[i];
+    }
+
+    if (w < 1)
+    {
+        auto& dF = this->template gettmp<SymmetryBlockedTensor<T>>("dF");
+        diis.extrapolate(ptr_vector<SymmetryBlockedTensor<T>>{&Fa, &Fb},
+                         ptr_vector<SymmetryBlockedTensor<T>>{&dF});
+        (1-w)*Fa += w*Fa_e;
+        (1-w)*Fb += w*Fb_e;
+    }
+    else
+    {
+        Fa = Fa_e;
+        Fb = Fb_e;
+    }
+}
+
+template <typename T>
+void UHF<T>::levelShift()
+{
+    if (level_shift == 0 || error < level_shift_end) return;
+
+    auto& S  = this->template get<SymmetryBlockedTensor<T>>("S");
+    auto& Fa = this->template get<SymmetryBlockedTensor<T>>("Fa");
+    auto& Fb = this->template get<SymmetryBlockedTensor<T>>("Fb");
+    auto& Da = this->template get<SymmetryBlockedTensor<T>>("Da");
+    auto& Db = this->template get<SymmetryBlockedTensor<T>>("Db");
+
+    /*
+     * F += b(S - SDS), i.e. add b times the projector onto the current
+     * virtual space, which raises the virtual orbital energies by b and
+     * damps occupied-virtual mixing
+     */
+    SymmetryBlockedTensor<T> tmp("tmp", Fa);
+
+    tmp["ab"] = S["ac"]*Da["cb"];
+    Fa["ab"] += level_shift*S["ab"];
+    Fa["ab"] -= level_shift*tmp["ac"]*S["cb"];
+
+    tmp["ab"] = S["ac"]*Db["cb"];
+    Fb["ab"] += level_shift*S["ab"];
+    Fb["ab"] -= level_shift*tmp["ac"]*S["cb"];
+}
+
 INSTANTIATE_SPECIALIZATIONS(UHF);
 
 }
@@ -21,11 +21,39 @@ template <typename T>
 class UHF : public Iterative<T>
 {
     protected:
+        enum EDIISType {NONE, EDIIS, ADIIS};
+
         bool frozen_core;
         T damping;
         vector<int> occ_alpha, occ_beta;
         vector<vector<real_type_t<T>>> E_alpha, E_beta;
         convergence::DIIS<tensor::SymmetryBlockedTensor<T>> diis;
+        /*
+         * Largest element of the orthogonalized [F,D], for both spins
+         */
+        real_type_t<T> error;
+        /*
+         * Energy-based extrapolation (EDIIS or ADIIS), used alone while the
+         * error is above ediis_start and blended into the DIIS Fock matrix
+         * down to ediis_end
+         */
+        EDIISType ediis_type;
+        real_type_t<T> ediis_start, ediis_end;
+        int ediis_order;
+        vector<unique_vector<tensor::SymmetryBlockedTensor<T>>> ediis_x;
+        vector<real_type_t<T>> ediis_E;
+        vector<vector<real_type_t<T>>> ediis_DF;
+        /*
+         * The virtual orbitals are shifted up by level_shift until the
+         * error drops below level_shift_end
+         */
+        real_type_t<T> level_shift, level_shift_end;
+        /*
+         * Quasi-Newton orbital rotations replace diagonalization of the Fock
+         * matrix once the error drops below soscf_start
+         */
+        real_type_t<T> soscf_start, soscf_max_step;
+        int soscf_order;
 
     public:
         UHF(const string& name, input::Config& config);
@@ -47,7 +75,21 @@ class UHF : public Iterative<T>
 
         void calcDensity();
 
+        void calcConvergence();
+
+        /*
+         * Take a second-order step in place of diagonalizeFock, returning
+         * false if this is not supported
+         */
+        virtual bool secondOrderStep() { return false; }
+
+        void calcGradient();
+
         void DIISExtrap();
+
+        void EDIISExtrap();
+
+        void levelShift();
 };
 
 }
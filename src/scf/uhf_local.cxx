@@ -15,7 +15,7 @@ namespace scf
 
 template <typename T>
 LocalUHF<T>::LocalUHF(const string& name, Config& config)
-: UHF<T>(name, config) {}
+: UHF<T>(name, config), soscf_last(-1) {}
 
 template <typename T>
 void LocalUHF<T>::calcSMinusHalf()
@@ -167,6 +167,296 @@ void LocalUHF<T>::diagonalizeFock()
     }
 }
 
+template <typename T>
+bool LocalUHF<T>::secondOrderStep()
+{
+    const Molecule& molecule = this->template get<Molecule>("molecule");
+
+    const vector<int>& norb = molecule.getNumOrbitals();
+    int nirrep = molecule.getGroup().getNumIrreps();
+
+    auto& S  = this->template get   <SymmetryBlockedTensor<T>>("S");
+    auto& Fa = this->template get   <SymmetryBlockedTensor<T>>("Fa");
+    auto& Fb = this->template get   <SymmetryBlockedTensor<T>>("Fb");
+    auto& Ca = this->template gettmp<SymmetryBlockedTensor<T>>("Ca");
+    auto& Cb = this->template gettmp<SymmetryBlockedTensor<T>>("Cb");
+
+    /*
+     * Start over if the last iteration was not a second-order step or the
+     * occupation has changed, since the old steps no longer apply
+     */
+    vector<int> occ = occ_alpha;
+    occ += occ_beta;
+
+    if (this->iter() != soscf_last+1 || occ != soscf_occ)
+    {
+        soscf_g.clear();
+        soscf_step.clear();
+        soscf_s.clear();
+        soscf_y.clear();
+    }
+
+    soscf_last = this->iter();
+    soscf_occ = occ;
+
+    vector<vector<T>> C(2*nirrep), F(2*nirrep);
+
+    for (int i = 0;i < nirrep;i++)
+    {
+        if (norb[i] == 0) continue;
+
+        vector<int> irreps(2,i);
+
+        for (int spin : {0,1})
+        {
+            auto& Cs = (spin == 0 ? Ca : Cb);
+            auto& Fs = (spin == 0 ? Fa : Fb);
+
+            if (S.arena.rank == 0)
+            {
+                Cs.getAllData(irreps, C[i+spin*nirrep], 0);
+                Fs.getAllData(irreps, F[i+spin*nirrep], 0);
+            }
+            else
+            {
+                Cs.getAllData(irreps, 0);
+                Fs.getAllData(irreps, 0);
+            }
+        }
+    }
+
+    if (S.arena.rank == 0)
+    {
+        auto dot = [](const vector<T>& a, const vector<T>& b)
+        {
+            T d = 0;
+            for (int k = 0;k < a.size();k++) d += a[k]*b[k];
+            return d;
+        };
+
+        /*
+         * In the MO basis, the orbital gradient is F[ai] and the diagonal
+         * of the Hessian is approximately F[aa]-F[ii] (both up to a factor
+         * of 2, which cancels)
+         */
+        vector<T> g, h;
+
+        for (int spin : {0,1})
+        {
+            for (int i = 0;i < nirrep;i++)
+            {
+                int n = norb[i];
+                int o = (spin == 0 ? occ_alpha[i] : occ_beta[i]);
+                if (n == 0) continue;
+
+                vector<T>& c = C[i+spin*nirrep];
+                vector<T>& f = F[i+spin*nirrep];
+                vector<T> tmp(n*n);
+
+                gemm('T', 'N', n, n, n, 1.0, c.data(), n, f.data(), n, 0.0, tmp.data(), n);
+                gemm('N', 'N', n, n, n, 1.0, tmp.data(), n, c.data(), n, 0.0, f.data(), n);
+
+                for (int j = 0;j < o;j++)
+                {
+                    for (int a = o;a < n;a++)
+                    {
+                        g.push_back(f[a+j*n]);
+                        h.push_back(max(f[a+a*n]-f[j+j*n], (T)0.1));
+                    }
+                }
+            }
+        }
+
+        if (!soscf_g.empty())
+        {
+            vector<T> y(g);
+            for (int k = 0;k < y.size();k++) y[k] -= soscf_g[k];
+
+            if (dot(y, soscf_step) > 1e-12)
+            {
+                soscf_s.push_back(soscf_step);
+                soscf_y.push_back(y);
+
+                if (soscf_s.size() > this->soscf_order)
+                {
+                    soscf_s.erase(soscf_s.begin());
+                    soscf_y.erase(soscf_y.begin());
+                }
+            }
+        }
+
+        /*
+         * L-BFGS two-loop recursion for the step -H^-1 g, starting from the
+         * diagonal Hessian
+         */
+        int m = soscf_s.size();
+        vector<T> q(g), alpha(m), rho(m);
+
+        for (int k = m-1;k >= 0;k--)
+        {
+            rho[k] = 1/dot(soscf_y[k], soscf_s[k]);
+            alpha[k] = rho[k]*dot(soscf_s[k], q);
+            for (int l = 0;l < q.size();l++) q[l] -= alpha[k]*soscf_y[k][l];
+        }
+
+        for (int l = 0;l < q.size();l++) q[l] /= h[l];
+
+        for (int k = 0;k < m;k++)
+        {
+            T beta = rho[k]*dot(soscf_y[k], q);
+            for (int l = 0;l < q.size();l++) q[l] += (alpha[k]-beta)*soscf_s[k][l];
+        }
+
+        T maxstep = 0;
+        for (int l = 0;l < q.size();l++) maxstep = max(maxstep, aquarius::abs(q[l]));
+        T scale = (maxstep > this->soscf_max_step ? this->soscf_max_step/maxstep : 1);
+        for (int l = 0;l < q.size();l++) q[l] *= -scale;
+
+        soscf_g = g;
+        soscf_step = q;
+
+        int off = 0;
+        for (int spin : {0,1})
+        {
+            for (int i = 0;i < nirrep;i++)
+            {
+                int n = norb[i];
+                int o = (spin == 0 ? occ_alpha[i] : occ_beta[i]);
+                int v = n-o;
+                if (n == 0) continue;
+
+                vector<T>& c = C[i+spin*nirrep];
+                vector<T>& f = F[i+spin*nirrep];
+                auto& E = (spin == 0 ? E_alpha[i] : E_beta[i]);
+
+                int off0 = off;
+                vector<T> K(n*n, (T)0);
+                for (int j = 0;j < o;j++)
+                {
+                    for (int a = o;a < n;a++)
+                    {
+                        K[a+j*n] =  q[off];
+                        K[j+a*n] = -q[off];
+                        off++;
+                    }
+                }
+
+                /*
+                 * U = exp(K) for antisymmetric K: with K^2 = V diag(-theta^2) V^T,
+                 *
+                 *   U = V cos(theta) V^T + V [sin(theta)/theta] V^T K
+                 */
+                vector<T> V(n*n), w(n), U(n*n, (T)0), B(n*n, (T)0), tmp(n*n);
+
+                gemm('N', 'N', n, n, n, 1.0, K.data(), n, K.data(), n, 0.0, V.data(), n);
+                int info = heev('V', 'U', n, V.data(), n, w.data());
+                assert(info == 0);
+
+                for (int k = 0;k < n;k++)
+                {
+                    T theta = sqrt(max(-w[k], (T)0));
+                    T sinc = (theta > 1e-8 ? sin(theta)/theta : 1-theta*theta/6);
+                    ger(n, n, cos(theta), &V[k*n], 1, &V[k*n], 1, U.data(), n);
+                    ger(n, n,       sinc, &V[k*n], 1, &V[k*n], 1, B.data(), n);
+                }
+
+                gemm('N', 'N', n, n, n, 1.0, B.data(), n, K.data(), n, 1.0, U.data(), n);
+
+                /*
+                 * C <- C U and F <- U^T F U
+                 */
+                gemm('N', 'N', n, n, n, 1.0, c.data(), n, U.data(), n, 0.0, tmp.data(), n);
+                c.swap(tmp);
+                gemm('T', 'N', n, n, n, 1.0, U.data(), n, f.data(), n, 0.0, tmp.data(), n);
+                gemm('N', 'N', n, n, n, 1.0, tmp.data(), n, U.data(), n, 0.0, f.data(), n);
+
+                /*
+                 * Semicanonicalize the occupied and virtual orbitals, which
+                 * are then canonical at convergence
+                 */
+                vector<T> W(n*n, (T)0);
+                for (int j = 0;j < n;j++)
+                {
+                    for (int k = 0;k < n;k++)
+                    {
+                        if ((j < o) == (k < o)) W[j+k*n] = f[j+k*n];
+                    }
+                }
+
+                if (o > 0)
+                {
+                    info = heev('V', 'U', o, W.data(), n, E.data());
+                    assert(info == 0);
+                }
+
+                if (v > 0)
+                {
+                    info = heev('V', 'U', v, &W[o+o*n], n, &E[o]);
+                    assert(info == 0);
+                }
+
+                gemm('N', 'N', n, n, n, 1.0, c.data(), n, W.data(), n, 0.0, tmp.data(), n);
+                c.swap(tmp);
+
+                /*
+                 * The rotation parameters of this block transform as
+                 * kappa(ai) <- W(vv)^T kappa(ai) W(oo), so bring the stored
+                 * gradient, step, and L-BFGS pairs into the new basis too
+                 */
+                if (o > 0 && v > 0)
+                {
+                    vector<T> X(v*o);
+                    auto rotate = [&](vector<T>& x)
+                    {
+                        gemm('T', 'N', v, o, v, 1.0, &W[o+o*n], n, &x[off0], v, 0.0, X.data(), v);
+                        gemm('N', 'N', v, o, o, 1.0, X.data(), v, W.data(), n, 0.0, &x[off0], v);
+                    };
+
+                    rotate(soscf_g);
+                    rotate(soscf_step);
+                    for (auto& x : soscf_s) rotate(x);
+                    for (auto& x : soscf_y) rotate(x);
+                }
+            }
+        }
+    }
+
+    for (int i = 0;i < nirrep;i++)
+    {
+        if (norb[i] == 0) continue;
+
+        vector<int> irreps(2,i);
+
+        for (int spin : {0,1})
+        {
+            auto& Cs = (spin == 0 ? Ca : Cb);
+            auto& E = (spin == 0 ? E_alpha[i] : E_beta[i]);
+
+            S.arena.comm().Bcast(E, 0);
+
+            if (S.arena.rank == 0)
+            {
+                vector<T>& c = C[i+spin*nirrep];
+                vector<tkv_pair<T>> pairs(norb[i]*norb[i]);
+
+                for (int j = 0;j < norb[i]*norb[i];j++)
+                {
+                    pairs[j].k = j;
+                    pairs[j].d = c[j];
+                }
+
+                Cs.writeRemoteData(irreps, pairs);
+            }
+            else
+            {
+                Cs.writeRemoteData(irreps);
+            }
+        }
+    }
+
+    return true;
+}
+
 INSTANTIATE_SPECIALIZATIONS(LocalUHF);
 
 }
@@ -19,10 +19,23 @@ class LocalUHF : public UHF<T>
     protected:
         using UHF<T>::E_alpha;
         using UHF<T>::E_beta;
+        using UHF<T>::occ_alpha;
+        using UHF<T>::occ_beta;
+
+        /*
+         * L-BFGS history of the second-order steps, which is only kept on
+         * the root process
+         */
+        int soscf_last;
+        vector<int> soscf_occ;
+        vector<T> soscf_g, soscf_step;
+        vector<vector<T>> soscf_s, soscf_y;
 
         void calcSMinusHalf();
 
         void diagonalizeFock();
+
+        bool secondOrderStep();
 };
 
 }
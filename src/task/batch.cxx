@@ -0,0 +1,183 @@
+#include "batch.hpp"
+
+using namespace aquarius::time;
+using namespace aquarius::input;
+
+namespace aquarius
+{
+namespace task
+{
+
+BatchDAG::Job::Job(const string& name, Config& common, Config& section)
+: name(name)
+{
+    parseTasks("", common);
+    parseTasks(name+".", section);
+
+    /*
+     * Keep a handle on every scalar product, since the tasks themselves are
+     * destroyed as they finish
+     */
+    for (Task& t : tasks)
+    {
+        for (Product& p : t.getProducts())
+        {
+            if (p.getType() == "double")
+                results.emplace_back(t.getName() + ":" + p.getName(), p);
+        }
+    }
+}
+
+BatchDAG::BatchDAG(const string& file, int group_size)
+: group_size(max(group_size, 1))
+{
+    ifstream ifs(file);
+    Config input(ifs);
+
+    Config common = input.clone();
+    while (common.exists("section")) common.remove("section");
+
+    /*
+     * Every job is set up on every process up front, so that errors in the
+     * input are caught collectively before the world is split
+     */
+    for (auto& i : input.find<string>("section"))
+    {
+        Config section = input.get("section." + i.second).clone();
+        Config context = common.clone();
+        jobs.emplace_back(new Job(i.second, context, section));
+    }
+
+    if (jobs.empty())
+        Logger::error(world()) << "No sections found in " << file << endl;
+}
+
+void BatchDAG::execute(const Arena& world)
+{
+    int ngroup = max(1, world.size/group_size);
+    int color = min(world.rank/group_size, ngroup-1);
+
+    Intracomm comm = world.comm().duplicate();
+    Arena arena(comm.split(color, world.rank));
+    arena.setBackend(world.backend());
+
+    Logger::log(world) << "Running " << jobs.size() << " job" << (jobs.size() > 1 ? "s" : "") <<
+                          " on " << ngroup << " group" << (ngroup > 1 ? "s" : "") << endl;
+
+    vector<int64_t> offsets(jobs.size()+1, 0);
+    for (int j = 0;j < jobs.size();j++)
+        offsets[j+1] = offsets[j] + jobs[j]->results.size();
+
+    vector<double> times(jobs.size(), 0.0);
+    vector<int> groups(jobs.size(), 0);
+    vector<double> values(offsets.back(), 0.0);
+    vector<int> produced(offsets.back(), 0);
+
+    {
+        /*
+         * The queue is a single counter on the first process, which the
+         * leader of each group atomically increments to claim its next job
+         */
+        #if MPIWRAP_HAVE_MPI_WIN
+        long next = 0;
+        Window counter = comm.window(&next, comm.rank == 0 ? sizeof(next) : 0);
+        #endif
+
+        long j = color-ngroup;
+        while (true)
+        {
+            #if MPIWRAP_HAVE_MPI_WIN
+            if (arena.rank == 0)
+            {
+                counter.lock(MPI_LOCK_SHARED, 0);
+                j = counter.Fetch_and_op(1l, 0, 0, MPI_SUM);
+                counter.unlock(0);
+            }
+            arena.comm().Bcast(&j, 1, 0);
+            #else
+            j += ngroup;
+            #endif
+
+            if (j >= (long)jobs.size()) break;
+
+            Job& job = *jobs[j];
+
+            Logger::log(arena) << "Starting job: " << job.name << " (group " << color << ")" << endl;
+
+            Timer timer;
+            timer.start();
+            job.execute(arena);
+            timer.stop();
+            double dt = timer.seconds(arena);
+
+            Logger::log(arena) << "Finished job: " << job.name <<
+                                  " in " << fixed << setprecision(3) << dt << " s" << endl;
+
+            if (arena.rank == 0)
+            {
+                times[j] = dt;
+                groups[j] = color;
+
+                for (int k = 0;k < job.results.size();k++)
+                {
+                    Product& p = job.results[k].second;
+                    if (!p.exists()) continue;
+                    values[offsets[j]+k] = p.get<double>();
+                    produced[offsets[j]+k] = 1;
+                }
+            }
+        }
+    }
+
+    /*
+     * Only the leader of the group which ran a job has filled in its entries
+     */
+    comm.Allreduce(times, MPI_SUM);
+    comm.Allreduce(groups, MPI_SUM);
+    if (!values.empty())
+    {
+        comm.Allreduce(values, MPI_SUM);
+        comm.Allreduce(produced, MPI_SUM);
+    }
+
+    printResults(world, times, groups, values, produced);
+}
+
+void BatchDAG::printResults(const Arena& world, const vector<double>& times,
+                            const vector<int>& groups, const vector<double>& values,
+                            const vector<int>& produced) const
+{
+    int width = 0;
+    for (auto& job : jobs)
+    {
+        for (auto& r : job->results)
+            width = max(width, (int)r.first.size());
+    }
+
+    Logger::log(world) << "Batch results:" << endl;
+
+    int64_t k = 0;
+    for (int j = 0;j < jobs.size();j++)
+    {
+        Logger::log(world) << jobs[j]->name << " (group " << groups[j] << ", " <<
+                              fixed << setprecision(3) << times[j] << " s)" << endl;
+
+        for (auto& r : jobs[j]->results)
+        {
+            if (produced[k])
+            {
+                Logger::log(world) << "    " << std::left << setw(width) << r.first << std::right << " " <<
+                                      fixed << setprecision(12) << setw(20) << values[k] << endl;
+            }
+            else
+            {
+                Logger::log(world) << "    " << std::left << setw(width) << r.first << std::right << " " <<
+                                      setw(20) << "-" << endl;
+            }
+            k++;
+        }
+    }
+}
+
+}
+}
@@ -0,0 +1,53 @@
+#ifndef _AQUARIUS_TASK_BATCH_HPP_
+#define _AQUARIUS_TASK_BATCH_HPP_
+
+#include "util/global.hpp"
+
+#include "task/task.hpp"
+
+namespace aquarius
+{
+namespace task
+{
+
+/*
+ * Runs each top-level section of an input file as an independent job, so
+ * that many small calculations (a set of conformers, a scan, ...) can share
+ * one launch.
+ *
+ * The world is split into groups of group_size processes (the remainder
+ * joining the last group), and each group takes the next job from a shared
+ * counter as soon as it finishes the previous one. Tasks outside of any
+ * section are common to all jobs and are run as part of each one. Every
+ * scalar product of every job is collected into a single table, which is
+ * printed at the end.
+ */
+class BatchDAG
+{
+    protected:
+        class Job : public TaskDAG
+        {
+            public:
+                string name;
+                vector<pair<string,Product>> results;
+
+                Job(const string& name, input::Config& common, input::Config& section);
+        };
+
+        int group_size;
+        vector<unique_ptr<Job>> jobs;
+
+        void printResults(const Arena& world, const vector<double>& times,
+                          const vector<int>& groups, const vector<double>& values,
+                          const vector<int>& produced) const;
+
+    public:
+        BatchDAG(const string& file, int group_size);
+
+        void execute(const Arena& world);
+};
+
+}
+}
+
+#endif
@@ -116,13 +116,14 @@ ostream& Logger::error(const Arena& arena)
     }
 }
 
-Requirement::Requirement(const string& type, const string& name)
-: type(type), name(name) {}
+Requirement::Requirement(const string& type, const string& name, int usage)
+: type(type), name(name), usage(usage) {}
 
 void Requirement::fulfil(const Product& product)
 {
     this->product.set(new Product(product));
     *this->product->used = true;
+    *this->product->usage |= usage;
 }
 
 bool Requirement::exists() const
@@ -138,10 +139,12 @@ Product& Requirement::get()
 }
 
 Product::Product(const string& type, const string& name)
-: type(type), name(name), requirements(new vector<Requirement>()), used(new bool(false)) {}
+: type(type), name(name), requirements(new vector<Requirement>()), used(new bool(false)),
+  usage(new int(0)), keep_requirements(new bool(false)) {}
 
 Product::Product(const string& type, const string& name, const vector<Requirement>& reqs)
-: type(type), name(name), requirements(new vector<Requirement>(reqs)), used(new bool(false)) {}
+: type(type), name(name), requirements(new vector<Requirement>(reqs)), used(new bool(false)),
+  usage(new int(0)), keep_requirements(new bool(false)) {}
 
 void Product::addRequirement(Requirement&& req)
 {
@@ -225,12 +228,22 @@ unique_ptr<Task> Task::createTask(const string& type, const string& name, input:
     return t;
 }
 
-void TaskDAG::parseTasks(const string& context, Config& input)
+void TaskDAG::parseTasks(const string& context, Config& input, const string& backend_)
 {
+    string backend = backend_;
+    if (input.exists("backend"))
+    {
+        backend = input.get<string>("backend");
+        input.remove("backend");
+
+        if (backend != "distributed" && backend != "local" && backend != "local_checked")
+            Logger::error(world()) << "Unknown backend " << backend << endl;
+    }
+
     for (auto& i : input.find<string>("section"))
     {
         Config section = input.get("section." + i.second);
-        parseTasks(context+i.second+".", section);
+        parseTasks(context+i.second+".", section, backend);
         input.remove("section");
     }
 
@@ -238,7 +251,11 @@ void TaskDAG::parseTasks(const string& context, Config& input)
     {
         string type = i.first;
         Config config = i.second.clone();
-        addTask(world(), type, context, config);
+        Task& t = addTask(world(), type, context, config);
+
+        if (backend == "distributed") backends[t.getName()] = Arena::DISTRIBUTED;
+        else if (backend == "local") backends[t.getName()] = Arena::LOCAL;
+        else if (backend == "local_checked") backends[t.getName()] = Arena::LOCAL_CHECKED;
     }
 }
 
@@ -533,6 +550,10 @@ void TaskDAG::execute(const Arena& world)
                 bool done = false;
                 string error;
 
+                Arena::Backend backend = world.backend();
+                auto b = backends.find(t.getName());
+                if (b != backends.end()) world.setBackend(b->second);
+
                 timer.start();
                 //try
                 //{
@@ -545,6 +566,8 @@ void TaskDAG::execute(const Arena& world)
                 //}
                 timer.stop();
 
+                world.setBackend(backend);
+
                 double dt = timer.seconds(world);
                 double gflops = timer.gflops(world);
                 Logger::log(world) << "Finished task: " << t.getName() <<
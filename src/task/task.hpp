@@ -130,15 +130,22 @@ class Requirement
     protected:
         string type;
         string name;
+        int usage;
         global_ptr<Product> product;
 
     public:
-        Requirement(const string& type, const string& name);
+        /*
+         * usage is a set of product-specific flags telling the producer which
+         * parts of the product will actually be accessed (by default, all)
+         */
+        Requirement(const string& type, const string& name, int usage = ~0);
 
         const string& getName() const { return name; }
 
         const string getType() const { return type; }
 
+        int getUsage() const { return usage; }
+
         bool exists() const;
 
         void fulfil(const Product& product);
@@ -161,6 +168,8 @@ class Product
         global_ptr<Destructible> data;
         shared_ptr<vector<Requirement>> requirements;
         shared_ptr<bool> used;
+        shared_ptr<int> usage;
+        shared_ptr<bool> keep_requirements;
 
     public:
         Product(const string& type, const string& name);
@@ -173,6 +182,18 @@ class Product
 
         bool isUsed() const { return *used; }
 
+        /*
+         * Union of the usage flags of all requirements fulfilled by this product
+         */
+        int getUsage() const { return *usage; }
+
+        /*
+         * Keep the products fulfilling this product's requirements alive for
+         * as long as this product is, instead of releasing them along with
+         * the task, for a product which refers to parts of them
+         */
+        void keepRequirements() { *keep_requirements = true; }
+
         template <typename T> T& put(T* resource)
         {
             data.set(new Resource<T>(resource));
@@ -273,7 +294,7 @@ class Task
         {
             for (Product& p : products)
             {
-                p.requirements->clear();
+                if (!*p.keep_requirements) p.requirements->clear();
             }
         }
 
@@ -355,8 +376,14 @@ class TaskDAG
     protected:
         unique_list<Task> tasks;
         vector<tuple<string,string,input::Config>> usings;
-
-        void parseTasks(const string& context, input::Config& config);
+        map<string,Arena::Backend> backends;
+
+        /*
+         * A section may set the backend (distributed, local, or
+         * local_checked, see Arena) used to run its tasks and those of its
+         * subsections, in place of the one given on the command line
+         */
+        void parseTasks(const string& context, input::Config& config, const string& backend = "");
 
         void satisfyExplicitRequirements(const Arena& world);
 
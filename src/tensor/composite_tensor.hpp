@@ -182,6 +182,20 @@ class CompositeTensor : public Tensor<Derived,T>
             return *tensors[idx].tensor;
         }
 
+        /*
+         * See CTFTensor::keepLayouts
+         */
+        void keepLayouts(int max_copies) const
+        {
+            for (int i = 0;i < tensors.size();i++)
+            {
+                if (tensors[i] != NULL && tensors[i].ref == -1)
+                {
+                    tensors[i].tensor->keepLayouts(max_copies);
+                }
+            }
+        }
+
         /**********************************************************************
          *
          * Implementation of Tensor stubs
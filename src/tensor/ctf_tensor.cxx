@@ -13,7 +13,7 @@ map<const tCTF_World<T>*,pair<int,CTFTensor<T>*>> CTFTensor<T>::scalars;
  */
 template <typename T>
 CTFTensor<T>::CTFTensor(const string& name, const Arena& arena, T scalar)
-: IndexableTensor< CTFTensor<T>,T >(name), Distributed(arena), len(0), sym(0)
+: IndexableTensor< CTFTensor<T>,T >(name), Distributed(arena), len(0), sym(0), view(false), local(new LocalCopy()), layouts(new LayoutCache())
 {
     allocate();
     *dt = scalar;
@@ -26,7 +26,7 @@ CTFTensor<T>::CTFTensor(const string& name, const Arena& arena, T scalar)
 template <typename T>
 CTFTensor<T>::CTFTensor(const string& name, const CTFTensor<T>& A, T scalar)
 : IndexableTensor< CTFTensor<T>,T >(name), Distributed(A.arena),
-  len(0), sym(0)
+  len(0), sym(0), view(false), local(new LocalCopy()), layouts(new LayoutCache())
 {
     allocate();
     *dt = scalar;
@@ -39,7 +39,7 @@ CTFTensor<T>::CTFTensor(const string& name, const CTFTensor<T>& A, T scalar)
 template <typename T>
 CTFTensor<T>::CTFTensor(const CTFTensor<T>& A, bool copy, bool zero)
 : IndexableTensor< CTFTensor<T>,T >(A.name, A.ndim), Distributed(A.arena),
-  len(A.len), sym(A.sym)
+  len(A.len), sym(A.sym), view(false), local(new LocalCopy()), layouts(new LayoutCache())
 {
     allocate();
 
@@ -61,7 +61,7 @@ CTFTensor<T>::CTFTensor(const CTFTensor<T>& A, bool copy, bool zero)
 template <typename T>
 CTFTensor<T>::CTFTensor(const string& name, const CTFTensor<T>& A, bool copy, bool zero)
 : IndexableTensor< CTFTensor<T>,T >(name, A.ndim), Distributed(A.arena),
-  len(A.len), sym(A.sym)
+  len(A.len), sym(A.sym), view(false), local(new LocalCopy()), layouts(new LayoutCache())
 {
     allocate();
 
@@ -80,7 +80,7 @@ CTFTensor<T>::CTFTensor(const string& name, const CTFTensor<T>& A, bool copy, bo
 template <typename T>
 CTFTensor<T>::CTFTensor(const string& name, CTFTensor<T>* A)
 : IndexableTensor< CTFTensor<T>,T >(name, A->ndim), Distributed(A->arena),
-  len(A->len), sym(A->sym)
+  len(A->len), sym(A->sym), view(A->view), local(A->local), layouts(A->layouts)
 {
     dt = A->dt;
     delete A;
@@ -88,12 +88,28 @@ CTFTensor<T>::CTFTensor(const string& name, CTFTensor<T>* A)
 }
 
 template <typename T>
-CTFTensor<T>::CTFTensor(const string& name, const CTFTensor<T>& A, const vector<int>& start_A, const vector<int>& len_A)
+CTFTensor<T>::CTFTensor(const string& name, const CTFTensor<T>& A, const vector<int>& start_A, const vector<int>& len_A,
+                        bool view)
 : IndexableTensor< CTFTensor<T>,T >(name, A.ndim), Distributed(A.arena),
-  len(len_A), sym(A.sym)
+  len(len_A), sym(A.sym), view(view), local(new LocalCopy()), layouts(new LayoutCache())
 {
-    allocate();
-    slice((T)1, false, A, start_A, (T)0);
+    for (int i = 0;i < A.ndim;i++)
+    {
+        if (start_A[i] != 0 || len_A[i] != A.len[i]) this->view = false;
+    }
+
+    if (this->view)
+    {
+        dt = A.dt;
+        local = A.local;
+        layouts = A.layouts;
+    }
+    else
+    {
+        allocate();
+        slice((T)1, false, A, start_A, (T)0);
+    }
+
     register_scalar();
 }
 
@@ -104,7 +120,7 @@ template <typename T>
 CTFTensor<T>::CTFTensor(const string& name, const Arena& arena, int ndim, const vector<int>& len, const vector<int>& sym,
                           bool zero)
 : IndexableTensor< CTFTensor<T>,T >(name, ndim), Distributed(arena),
-  len(len), sym(sym)
+  len(len), sym(sym), view(false), local(new LocalCopy()), layouts(new LayoutCache())
 {
     assert(len.size() == ndim);
     assert(sym.size() == ndim);
@@ -127,15 +143,20 @@ CTFTensor<T>::~CTFTensor()
 }
 
 template <typename T>
-void CTFTensor<T>::allocate()
+void CTFTensor<T>::allocate() const
 {
-    dt = new tCTF_Tensor<T>(ndim, len.data(), sym.data(), arena.ctf<T>(), this->name.c_str(), 1);
+    dt.set(new tCTF_Tensor<T>(ndim, len.data(), sym.data(), const_cast<tCTF_World<T>&>(arena.ctf<T>()),
+                              this->name.c_str(), 1));
 }
 
 template <typename T>
 void CTFTensor<T>::free()
 {
-    delete dt;
+    /*
+     * The data is deleted along with the last tensor (or view) using it
+     */
+    if (dt.unique()) dt.set();
+    dt = global_ptr<tCTF_Tensor<T>>();
 }
 
 template <typename T>
@@ -196,13 +217,66 @@ void CTFTensor<T>::resize(int ndim, const vector<int>& len, const vector<int>& s
     this->sym = sym;
 
     free();
+    view = false;
+    local.reset(new LocalCopy());
+    layouts.reset(new LayoutCache());
     allocate();
     if (zero) *dt = (T)0;
 }
 
+template <typename T>
+int64_t CTFTensor<T>::getNumPacked() const
+{
+    int64_t npair = 1;
+
+    for (int i = 0;i < ndim;)
+    {
+        int j;
+        for (j = i;j < ndim-1 && sym[j] != NS;j++);
+
+        int k = j-i+1;
+        if (sym[i] == SY)
+        {
+            npair *= binom<int64_t>(len[i]+k-1, k);
+        }
+        else
+        {
+            npair *= binom<int64_t>(len[i], k);
+        }
+
+        i = j+1;
+    }
+
+    return npair;
+}
+
+template <typename T>
+void CTFTensor<T>::getAllDataAsync(vector<T>& vals, DataFuture<T>& future) const
+{
+    assert(!future.started);
+
+    int64_t npair = getNumPacked();
+
+    if (arena.rank == 0)
+    {
+        vector<T> tmp;
+        getAllData(tmp, 0);
+        assert(tmp.size() == npair);
+        future.buffer.insert(future.buffer.end(), tmp.begin(), tmp.end());
+    }
+    else
+    {
+        getAllData(0);
+        future.buffer.resize(future.buffer.size()+npair);
+    }
+
+    future.dests.emplace_back(&vals, npair);
+}
+
 template <typename T>
 T* CTFTensor<T>::getRawData(int64_t& size)
 {
+    dropLocal();
     return const_cast<T*>(const_cast<const CTFTensor<T>&>(*this).getRawData(size));
 }
 
@@ -210,6 +284,7 @@ template <typename T>
 const T* CTFTensor<T>::getRawData(int64_t& size) const
 {
     long_int size_;
+    syncLocal();
     T* data = dt->get_raw_data(&size_);
     size = size_;
     return data;
@@ -252,6 +327,8 @@ void CTFTensor<T>::slice(T alpha, bool conja, const CTFTensor<T>& A, const vecto
         assert(end_B[i] <= this->len[i]);
     }
 
+    A.syncLocal();
+    dropLocal();
     dt->slice(start_B.data(), end_B.data(), beta, *A.dt, start_A.data(), end_A.data(), alpha);
 }
 
@@ -272,8 +349,19 @@ template <typename T>
 void CTFTensor<T>::div(T alpha, bool conja, const CTFTensor<T>& A,
                                  bool conjb, const CTFTensor<T>& B, T beta)
 {
-    const_cast<tCTF_Tensor<T>*>(A.dt)->align(*dt);
-    const_cast<tCTF_Tensor<T>*>(B.dt)->align(*dt);
+    if (isLocal() && A.isLocal() && B.isLocal())
+    {
+        const LocalTensor<T>& LA = A.localCopy(true);
+        const LocalTensor<T>& LB = B.localCopy(true);
+        localCopy(true).div(alpha, conja, LA, conjb, LB, beta);
+        return;
+    }
+
+    A.syncLocal();
+    B.syncLocal();
+    dropLocal();
+    A.dt->align(*dt);
+    B.dt->align(*dt);
 
 /*    int i;
     tCTF_fctr<T> fctr;
@@ -360,6 +448,15 @@ void CTFTensor<T>::div(T alpha, bool conja, const CTFTensor<T>& A,
 template <typename T>
 void CTFTensor<T>::invert(T alpha, bool conja, const CTFTensor<T>& A, T beta)
 {
+    if (isLocal() && A.isLocal())
+    {
+        const LocalTensor<T>& LA = A.localCopy(true);
+        localCopy(true).invert(alpha, conja, LA, beta);
+        return;
+    }
+
+    A.syncLocal();
+    dropLocal();
     dt->align(*A.dt);
     int64_t size, size_A;
     T* raw_data = getRawData(size);
@@ -390,18 +487,23 @@ void CTFTensor<T>::invert(T alpha, bool conja, const CTFTensor<T>& A, T beta)
 template <typename T>
 void CTFTensor<T>::print(FILE* fp, double cutoff) const
 {
+    syncLocal();
     dt->print(fp, cutoff);
 }
 
 template <typename T>
 void CTFTensor<T>::compare(FILE* fp, const CTFTensor<T>& other, double cutoff) const
 {
+    syncLocal();
+    other.syncLocal();
     dt->compare(*other.dt, fp, cutoff);
 }
 
 template <typename T>
 real_type_t<T> CTFTensor<T>::norm(int p) const
 {
+    syncLocal();
+
     T ans = (T)0;
     if (p == 00)
     {
@@ -430,12 +532,225 @@ real_type_t<T> CTFTensor<T>::norm(int p) const
     return aquarius::abs(ans);
 }
 
+/*
+ * Shapes, symmetries, and indices (relabeled in order of first appearance)
+ * of the operands of a contraction or sum
+ */
+template <typename T>
+static string layout_signature(const vector<pair<const CTFTensor<T>*,const string*>>& ops)
+{
+    map<char,int> relabel;
+    ostringstream os;
+
+    for (auto& op : ops)
+    {
+        const vector<int>& len = op.first->getLengths();
+        const vector<int>& sym = op.first->getSymmetry();
+        const string& idx = *op.second;
+
+        for (int i = 0;i < idx.size();i++)
+        {
+            if (!relabel.count(idx[i]))
+            {
+                int n = relabel.size();
+                relabel[idx[i]] = n;
+            }
+            os << relabel[idx[i]] << ':' << len[i] << ':' << sym[i] << ',';
+        }
+        os << ';';
+    }
+
+    return os.str();
+}
+
+template <typename T>
+void CTFTensor<T>::keepLayouts(int max_copies) const
+{
+    dropLayouts();
+    layouts->max_copies = max_copies;
+}
+
+template <typename T>
+tCTF_Tensor<T>& CTFTensor<T>::layoutFor(const string& signature) const
+{
+    LayoutCache& cache = *layouts;
+
+    if (cache.max_copies <= 0) return *dt;
+
+    if (cache.first.empty()) cache.first = signature;
+    if (cache.first == signature) return *dt;
+
+    auto i = cache.copies.find(signature);
+    if (i != cache.copies.end()) return *i->second;
+
+    if (cache.copies.size() >= cache.max_copies) return *dt;
+
+    tCTF_Tensor<T>* copy = new tCTF_Tensor<T>(*dt);
+    cache.copies[signature].reset(copy);
+    return *copy;
+}
+
+template <typename T>
+void CTFTensor<T>::dropLayouts() const
+{
+    layouts->first.clear();
+    layouts->copies.clear();
+}
+
+template <typename T>
+bool CTFTensor<T>::isLocal() const
+{
+    if (!arena.isLocal()) return false;
+
+    for (int i = 0;i < this->ndim;i++)
+    {
+        if (sym[i] != NS) return false;
+    }
+
+    return true;
+}
+
+template <typename T>
+LocalTensor<T>& CTFTensor<T>::localCopy(bool copy) const
+{
+    if (!local->tensor)
+    {
+        local->tensor.reset(new LocalTensor<T>(this->name, this->ndim, len));
+
+        if (copy)
+        {
+            int64_t npair;
+            tkv_pair<T> *pairs;
+            dt->read_local(&npair, &pairs);
+
+            T* data = local->tensor->getData();
+            for (int64_t i = 0;i < npair;i++) data[pairs[i].k] = pairs[i].d;
+            if (npair > 0) ::free(pairs);
+        }
+
+        dt.set();
+        dropLayouts();
+    }
+
+    return *local->tensor;
+}
+
+template <typename T>
+void CTFTensor<T>::syncLocal() const
+{
+    if (!local->tensor) return;
+
+    const T* data = local->tensor->getData();
+
+    vector<tkv_pair<T>> pairs(local->tensor->getSize());
+    for (int64_t k = 0;k < pairs.size();k++) pairs[k] = tkv_pair<T>(k, data[k]);
+
+    allocate();
+    dt->write(pairs.size(), pairs.data());
+    local->tensor.reset();
+}
+
+template <typename T>
+void CTFTensor<T>::dropLocal() const
+{
+    syncLocal();
+    dropLayouts();
+}
+
+/*
+ * Whether every element of a tensor indexed by idx is addressed, i.e. idx
+ * has no repeated index (which addresses only the diagonal)
+ */
+static bool covers_all(const string& idx)
+{
+    for (int i = 0;i < idx.size();i++)
+    {
+        if (idx.find(idx[i], i+1) != string::npos) return false;
+    }
+    return true;
+}
+
+template <typename T>
+typename CTFTensor<T>::LocalCheck& CTFTensor<T>::localCheck()
+{
+    static LocalCheck check;
+    return check;
+}
+
 template <typename T>
 void CTFTensor<T>::mult(T alpha, bool conja, const CTFTensor<T>& A, const string& idx_A,
                                   bool conjb, const CTFTensor<T>& B, const string& idx_B,
                          T  beta,                                     const string& idx_C)
 {
-    (*this->dt)[idx_C.c_str()]*beta += alpha*(*A.dt)[idx_A.c_str()]*(*B.dt)[idx_B.c_str()];
+    if (isLocal() && A.isLocal() && B.isLocal())
+    {
+        LocalCheck& check = localCheck();
+        unique_ptr<tCTF_Tensor<T>> ref;
+
+        bool checked = arena.isLocalChecked();
+
+        if (checked)
+        {
+            A.syncLocal();
+            B.syncLocal();
+            syncLocal();
+            ref.reset(new tCTF_Tensor<T>(*dt));
+
+            time::tic();
+            (*ref)[idx_C.c_str()]*beta += alpha*(*A.dt)[idx_A.c_str()]*(*B.dt)[idx_B.c_str()];
+            check.ctf_time += time::toc().seconds();
+
+            time::tic();
+        }
+
+        /*
+         * C only has to be read if not all of it is overwritten
+         */
+        const LocalTensor<T>& LA = A.localCopy(true);
+        const LocalTensor<T>& LB = B.localCopy(true);
+        LocalTensor<T>& LC = localCopy(beta != (T)0 || !covers_all(idx_C));
+        LC.mult(alpha, conja, LA, idx_A,
+                       conjb, LB, idx_B,
+                 beta,            idx_C);
+
+        if (checked)
+        {
+            check.local_time += time::toc().seconds();
+            check.nop++;
+
+            int64_t npair;
+            tkv_pair<T> *pairs;
+            ref->read_local(&npair, &pairs);
+
+            const T* data = LC.getData();
+            for (int64_t i = 0;i < npair;i++)
+            {
+                check.maxdiff = max(check.maxdiff, (double)aquarius::abs(data[pairs[i].k]-pairs[i].d));
+            }
+            if (npair > 0) ::free(pairs);
+        }
+
+        return;
+    }
+
+    A.syncLocal();
+    B.syncLocal();
+    dropLocal();
+
+    /*
+     * Operands which keep copies in several layouts (see keepLayouts) use
+     * the one for this operation
+     */
+    tCTF_Tensor<T>* dt_A = A.dt.get();
+    tCTF_Tensor<T>* dt_B = B.dt.get();
+    if (&A != this && &B != this && (A.keepsLayouts() || B.keepsLayouts()))
+    {
+        string signature = layout_signature<T>({{&A, &idx_A}, {&B, &idx_B}, {this, &idx_C}});
+        dt_A = &A.layoutFor(signature+'A');
+        dt_B = &B.layoutFor(signature+'B');
+    }
+
+    (*this->dt)[idx_C.c_str()]*beta += alpha*(*dt_A)[idx_A.c_str()]*(*dt_B)[idx_B.c_str()];
 /*    dt->contract(alpha, *A.dt, idx_A.c_str(),
                         *B.dt, idx_B.c_str(),
                   beta,        idx_C.c_str());*/
@@ -454,12 +769,36 @@ template <typename T>
 void CTFTensor<T>::sum(T alpha, bool conja, const CTFTensor<T>& A, const string& idx_A,
                         T  beta,                                     const string& idx_B)
 {
-    (*this->dt)[idx_B.c_str()]*beta += alpha*(*A.dt)[idx_A.c_str()];
+    if (isLocal() && A.isLocal())
+    {
+        const LocalTensor<T>& LA = A.localCopy(true);
+        localCopy(beta != (T)0 || !covers_all(idx_B)).sum(alpha, conja, LA, idx_A, beta, idx_B);
+        return;
+    }
+
+    A.syncLocal();
+    dropLocal();
+
+    tCTF_Tensor<T>* dt_A = A.dt.get();
+    if (&A != this && A.keepsLayouts())
+    {
+        string signature = layout_signature<T>({{&A, &idx_A}, {this, &idx_B}});
+        dt_A = &A.layoutFor(signature+'A');
+    }
+
+    (*this->dt)[idx_B.c_str()]*beta += alpha*(*dt_A)[idx_A.c_str()];
 }
 
 template <typename T>
 void CTFTensor<T>::scale(T alpha, const string& idx_A)
 {
+    if (isLocal())
+    {
+        localCopy(true).scale(alpha, idx_A);
+        return;
+    }
+
+    dropLocal();
     (*this->dt)[idx_A.c_str()] = alpha*(*this->dt)[idx_A.c_str()];
 }
 
@@ -485,6 +824,36 @@ void CTFTensor<T>::weight(const vector<const vector<T>*>& d, double shift)
     assert(d.size() == this->ndim);
     for (int i = 0;i < d.size();i++) assert(d[i]->size() == len[i]);
 
+    if (isLocal())
+    {
+        LocalTensor<T>& L = localCopy(true);
+        T* data = L.getData();
+
+        for (int64_t i = 0;i < L.getSize();i++)
+        {
+            int64_t k = i;
+
+            T den = 0;
+            for (int j = 0;j < this->ndim;j++)
+            {
+                int o = k%len[j];
+                k = k/len[j];
+                den += (*d[j])[o];
+            }
+
+            if (aquarius::abs(den+shift) < 1e-4)
+            {
+                data[i] = 0;
+            }
+            else
+            {
+                data[i] /= (den+shift);
+            }
+        }
+
+        return;
+    }
+
     vector<tkv_pair<T>> pairs;
     getLocalData(pairs);
 
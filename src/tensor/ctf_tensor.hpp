@@ -6,24 +6,144 @@
 #include "task/task.hpp"
 
 #include "indexable_tensor.hpp"
+#include "local_tensor.hpp"
 
 namespace aquarius
 {
 namespace tensor
 {
 
+template <typename T> class CTFTensor;
+
+/*
+ * Handle to a non-blocking broadcast of full tensor data from rank 0 to
+ * every rank in an arena. Any number of (sub-)tensors may be queued onto a
+ * single handle before start() so that they share one collective; the
+ * destination vectors must not be touched until wait() (or a successful
+ * test()) has unpacked the data into them.
+ */
+template <typename T>
+class DataFuture
+{
+    template <typename T_> friend class CTFTensor;
+
+    protected:
+        Arena arena;
+        vector<T> buffer;
+        vector<pair<vector<T>*,int64_t>> dests;
+        unique_ptr<Request> req;
+        bool started;
+        bool done;
+
+        void unpack()
+        {
+            int64_t off = 0;
+            for (auto& dest : dests)
+            {
+                dest.first->assign(buffer.begin()+off, buffer.begin()+off+dest.second);
+                off += dest.second;
+            }
+            assert(off == buffer.size());
+
+            vector<T>().swap(buffer);
+            done = true;
+        }
+
+    public:
+        DataFuture(const Arena& arena) : arena(arena), started(false), done(false) {}
+
+        DataFuture(DataFuture<T>&& other)
+        : arena(other.arena), buffer(move(other.buffer)), dests(move(other.dests)),
+          req(move(other.req)), started(other.started), done(other.done)
+        {
+            other.done = true;
+        }
+
+        ~DataFuture()
+        {
+            if (started && !done) wait();
+        }
+
+        void start()
+        {
+            assert(!started);
+            started = true;
+#if MPIWRAP_HAVE_MPI_ICOLLECTIVES
+            req.reset(new Request(arena.comm().Ibcast(buffer.data(), buffer.size(), 0)));
+#else
+            arena.comm().Bcast(buffer.data(), buffer.size(), 0);
+#endif
+        }
+
+        bool test()
+        {
+            assert(started);
+            if (done) return true;
+            if (req && !req->test()) return false;
+            unpack();
+            return true;
+        }
+
+        void wait()
+        {
+            assert(started);
+            if (done) return;
+            if (req) req->wait();
+            unpack();
+        }
+};
+
 template <typename T>
 class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
 {
     INHERIT_FROM_INDEXABLE_TENSOR(CTFTensor<T>,T)
 
     protected:
-        tCTF_Tensor<T>* dt;
+        /*
+         * Shared with views, so that the CTF data may be freed and allocated
+         * again (see LocalCopy) under all of them at once
+         */
+        mutable global_ptr<tCTF_Tensor<T>> dt;
         vector<int> len;
         vector<int> sym;
+        bool view;
+
+        /*
+         * On an arena using the LOCAL backend, the node-local copy of a
+         * nonsymmetric tensor, which stays resident between contractions and
+         * is shared with views. Only one of the node-local copy and the CTF
+         * data exists at a time: the CTF data is freed when the copy is
+         * made, and allocated again (and the copy freed) when an operation
+         * through CTF needs it.
+         */
+        struct LocalCopy
+        {
+            unique_ptr<LocalTensor<T>> tensor;
+        };
+        mutable shared_ptr<LocalCopy> local;
+
+        /*
+         * Copies of a tensor which is only read, one for each signature of
+         * operation (the shapes, symmetries, and canonically relabeled
+         * indices of all operands) it has taken part in after the first,
+         * which uses the tensor itself. CTF leaves an operand in the mapping
+         * it chose for the last operation, so each copy stays mapped for its
+         * own operation instead of the tensor being redistributed whenever
+         * the signature changes. Shared with views, and dropped whenever the
+         * data changes.
+         */
+        struct LayoutCache
+        {
+            int max_copies;
+            string first;
+            map<string,unique_ptr<tCTF_Tensor<T>>> copies;
+
+            LayoutCache() : max_copies(0) {}
+        };
+        mutable shared_ptr<LayoutCache> layouts;
         static map<const tCTF_World<T>*,pair<int,CTFTensor<T>*>> scalars;
 
-        void allocate();
+        void allocate() const;
 
         void free();
 
@@ -33,6 +153,40 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
 
         CTFTensor<T>& scalar() const;
 
+        /*
+         * On an arena using the LOCAL backend, contractions, sums, and scaling
+         * of nonsymmetric tensors are done on the node-local copies instead
+         * of by CTF
+         */
+        bool isLocal() const;
+
+        /*
+         * The node-local copy, created if necessary, in which case the CTF
+         * data is read into it only if copy is true (otherwise the caller
+         * must overwrite all of it) and then freed
+         */
+        LocalTensor<T>& localCopy(bool copy) const;
+
+        /*
+         * Move the node-local copy, if any, back to CTF, before CTF reads the
+         * data
+         */
+        void syncLocal() const;
+
+        /*
+         * As syncLocal(), before CTF changes the data
+         */
+        void dropLocal() const;
+
+        bool keepsLayouts() const { return layouts->max_copies > 0; }
+
+        /*
+         * The data to read as an operand of an operation with signature
+         */
+        tCTF_Tensor<T>& layoutFor(const string& signature) const;
+
+        void dropLayouts() const;
+
         static void first_packed_indices(int ndim, const int* len, const int* sym, int* idx)
         {
             int i;
@@ -108,6 +262,33 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
             return (ndim > 0 ? true : false);
         }
 
+    public:
+        /*
+         * Keep up to max_copies extra copies of this tensor, each laid out
+         * for a different operation, while it is not written to (0 drops
+         * them). This trades memory for redistribution when a tensor such
+         * as the integrals is read in many different contractions.
+         */
+        void keepLayouts(int max_copies) const;
+
+        /*
+         * On an arena using the LOCAL_CHECKED backend, every contraction done
+         * on node-local copies is repeated by CTF, and the largest absolute
+         * difference in the result and the time taken by each path are
+         * accumulated here
+         */
+        struct LocalCheck
+        {
+            int64_t nop;
+            double maxdiff;
+            double local_time;
+            double ctf_time;
+
+            LocalCheck() : nop(0), maxdiff(0), local_time(0), ctf_time(0) {}
+        };
+
+        static LocalCheck& localCheck();
+
     public:
         CTFTensor(const string& name, const Arena& arena, T scalar = (T)0);
 
@@ -119,7 +300,15 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
 
         CTFTensor(const string& name, CTFTensor<T>* A);
 
-        CTFTensor(const string& name, const CTFTensor<T>& A, const vector<int>& start_A, const vector<int>& len_A);
+        /*
+         * Create a tensor holding the range [start_A,start_A+len_A) of A. If
+         * view is true and the range is all of A, the data of A is referenced
+         * instead of copied; the view must then not outlive A, and writing to
+         * it writes to A. Otherwise (including any proper sub-range, which
+         * CTF cannot address in place) the data is copied.
+         */
+        CTFTensor(const string& name, const CTFTensor<T>& A, const vector<int>& start_A, const vector<int>& len_A,
+                  bool view=false);
 
         CTFTensor(const string& name, const Arena& arena, int ndim, const vector<int>& len, const vector<int>& sym,
                    bool zero=true);
@@ -132,6 +321,10 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
 
         const vector<int>& getSymmetry() const { return sym; }
 
+        bool isView() const { return view; }
+
+        int64_t getNumPacked() const;
+
         T* getRawData(int64_t& size);
 
         const T* getRawData(int64_t& size) const;
@@ -141,6 +334,7 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
         {
             int64_t npair;
             tkv_pair<T> *data;
+            syncLocal();
             dt->read_local(&npair, &data);
             pairs.assign(data, data+npair);
             if (npair > 0) ::free(data);
@@ -149,33 +343,39 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
         template <typename Container>
         void getRemoteData(Container& pairs) const
         {
+            syncLocal();
             dt->read(pairs.size(), pairs.data());
         }
 
         void getRemoteData() const
         {
+            syncLocal();
             dt->read(0, NULL);
         }
 
         template <typename Container>
         void writeRemoteData(const Container& pairs)
         {
+            dropLocal();
             dt->write(pairs.size(), pairs.data());
         }
 
         void writeRemoteData()
         {
+            dropLocal();
             dt->write(0, NULL);
         }
 
         template <typename Container>
         void writeRemoteData(double alpha, double beta, const Container& pairs)
         {
+            dropLocal();
             dt->write(pairs.size(), alpha, beta, pairs.data());
         }
 
         void writeRemoteData(double alpha, double beta)
         {
+            dropLocal();
             dt->write(0, alpha, beta, NULL);
         }
 
@@ -228,6 +428,7 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
             }
             while (next_packed_indices(ndim, len.data(), sym.data(), idx.data()));
 
+            syncLocal();
             dt->read(pairs.size(), pairs.data());
 
             sort(pairs.begin(), pairs.end());
@@ -243,9 +444,84 @@ class CTFTensor : public IndexableTensor< CTFTensor<T>,T >, public Distributed
         void getAllData(int rank) const
         {
             assert(this->arena.rank != rank);
+            syncLocal();
             dt->read(0, NULL);
         }
 
+        /*
+         * Inverse of getAllData(vals, rank): overwrite the tensor with the
+         * packed data in vals, which need only be present on rank
+         */
+        template <typename Container>
+        void setAllData(const Container& vals, int rank)
+        {
+            assert(this->arena.rank == rank);
+
+            dropLocal();
+
+            for (int i = 0;i < ndim;i++)
+            {
+                if (len[i] == 0)
+                {
+                    assert(vals.empty());
+                    dt->write(0, NULL);
+                    return;
+                }
+            }
+
+            vector<tkv_pair<T>> pairs;
+            vector<int> idx(ndim, 0);
+
+            first_packed_indices(ndim, len.data(), sym.data(), idx.data());
+
+            do
+            {
+                int64_t key = 0, stride = 1;
+                for (int i = 0;i < ndim;i++)
+                {
+                    key += idx[i]*stride;
+                    stride *= len[i];
+                }
+                pairs.push_back(tkv_pair<T>(key, (T)0));
+            }
+            while (next_packed_indices(ndim, len.data(), sym.data(), idx.data()));
+
+            sort(pairs.begin(), pairs.end());
+            assert(pairs.size() == vals.size());
+
+            for (size_t i = 0;i < pairs.size();i++)
+            {
+                pairs[i].d = vals[i];
+            }
+
+            dt->write(pairs.size(), pairs.data());
+        }
+
+        void setAllData(int rank)
+        {
+            assert(this->arena.rank != rank);
+            dropLocal();
+            dt->write(0, NULL);
+        }
+
+        /*
+         * Non-blocking version of getAllData(vals): the data is read to rank
+         * 0 immediately but the broadcast to the other ranks is only
+         * completed by DataFuture::wait().
+         */
+        DataFuture<T> getAllDataAsync(vector<T>& vals) const
+        {
+            DataFuture<T> future(this->arena);
+            getAllDataAsync(vals, future);
+            future.start();
+            return future;
+        }
+
+        /*
+         * Queue this tensor onto an existing (not yet started) future.
+         */
+        void getAllDataAsync(vector<T>& vals, DataFuture<T>& future) const;
+
         void slice(T alpha, bool conja, const CTFTensor<T>& A,
                    const vector<int>& start_A, T beta);
 
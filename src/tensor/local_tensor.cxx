@@ -0,0 +1,367 @@
+#include "local_tensor.hpp"
+
+namespace aquarius
+{
+namespace tensor
+{
+
+/*
+ * The distinct indices of idx, in order of first appearance
+ */
+static string distinct(const string& idx)
+{
+    string inds;
+    for (char c : idx)
+    {
+        if (inds.find(c) == string::npos) inds += c;
+    }
+    return inds;
+}
+
+static bool contains(const string& idx, char c)
+{
+    return idx.find(c) != string::npos;
+}
+
+/*
+ * Stride (first index fastest) of index c in a tensor of lengths len indexed
+ * by idx; a repeated index addresses the diagonal, so its stride is the sum
+ * of those of its occurrences
+ */
+static int64_t index_stride(char c, const string& idx, const vector<int>& len)
+{
+    int64_t s = 0, stride = 1;
+    for (int i = 0;i < idx.size();i++)
+    {
+        if (idx[i] == c) s += stride;
+        stride *= len[i];
+    }
+    return s;
+}
+
+/*
+ * Call f(off) for every point of the index space of lengths len (first index
+ * fastest), where off[t] is the offset of the point in tensor t given the
+ * strides stride[t]. If parallel, the points are split evenly between the
+ * threads, so f must not write to the same element for two points.
+ */
+template <typename Func>
+static void loop(const vector<int>& len, const vector<vector<int64_t>>& stride,
+                 bool parallel, Func f)
+{
+    int ndim = len.size();
+    int ntensor = stride.size();
+
+    int64_t total = 1;
+    for (int l : len) total *= l;
+    if (total == 0) return;
+
+    #pragma omp parallel if(parallel && total > 1024)
+    {
+        int nthread = omp_get_num_threads();
+        int thread = omp_get_thread_num();
+        int64_t begin = total*thread/nthread;
+        int64_t end = total*(thread+1)/nthread;
+
+        vector<int> pos(ndim);
+        vector<int64_t> off(ntensor, 0);
+
+        int64_t rem = begin;
+        for (int i = 0;i < ndim;i++)
+        {
+            pos[i] = rem%len[i];
+            rem /= len[i];
+            for (int t = 0;t < ntensor;t++) off[t] += pos[i]*stride[t][i];
+        }
+
+        for (int64_t p = begin;p < end;p++)
+        {
+            f(off.data());
+
+            for (int i = 0;i < ndim;i++)
+            {
+                for (int t = 0;t < ntensor;t++) off[t] += stride[t][i];
+                if (++pos[i] < len[i]) break;
+                for (int t = 0;t < ntensor;t++) off[t] -= stride[t][i]*len[i];
+                pos[i] = 0;
+            }
+        }
+    }
+}
+
+/*
+ * Pack A into the dense buffer buf over the indices keep (in that order,
+ * first fastest), summing over the indices summed
+ */
+template <typename T>
+static void pack(const LocalTensor<T>& A, const string& idx_A, bool conja,
+                 const string& keep, const string& summed, vector<T>& buf)
+{
+    const vector<int>& len_A = A.getLengths();
+    const T* data = A.getData();
+
+    auto length = [&](char c)
+    {
+        for (int i = 0;i < idx_A.size();i++) if (idx_A[i] == c) return len_A[i];
+        assert(0);
+        return 0;
+    };
+
+    vector<int> len_keep, len_sum;
+    vector<vector<int64_t>> stride_keep(2), stride_sum(1);
+
+    int64_t size = 1;
+    for (char c : keep)
+    {
+        len_keep.push_back(length(c));
+        stride_keep[0].push_back(index_stride(c, idx_A, len_A));
+        stride_keep[1].push_back(size);
+        size *= len_keep.back();
+    }
+
+    for (char c : summed)
+    {
+        len_sum.push_back(length(c));
+        stride_sum[0].push_back(index_stride(c, idx_A, len_A));
+    }
+
+    buf.resize(size);
+    T* out = buf.data();
+
+    loop(len_keep, stride_keep, true,
+    [&](const int64_t* off)
+    {
+        T s = (T)0;
+        if (summed.empty())
+        {
+            s = data[off[0]];
+        }
+        else
+        {
+            loop(len_sum, stride_sum, false,
+            [&](const int64_t* off_sum)
+            {
+                s += data[off[0]+off_sum[0]];
+            });
+        }
+        out[off[1]] = (conja ? conj(s) : s);
+    });
+}
+
+template <typename T>
+LocalTensor<T>::LocalTensor(const string& name, int ndim, const vector<int>& len, bool zero)
+: IndexableTensor< LocalTensor<T>,T >(name, ndim), len(len)
+{
+    assert(len.size() == ndim);
+
+    int64_t size = 1;
+    for (int l : len) size *= l;
+    data.resize(size);
+
+    if (zero) fill(data.begin(), data.end(), (T)0);
+}
+
+template <typename T>
+LocalTensor<T>::LocalTensor(const string& name, const LocalTensor<T>& A, T scalar)
+: IndexableTensor< LocalTensor<T>,T >(name, 0), data(1, scalar) {}
+
+template <typename T>
+LocalTensor<T>::LocalTensor(const LocalTensor<T>& A)
+: IndexableTensor< LocalTensor<T>,T >(A.name, A.ndim), len(A.len), data(A.data) {}
+
+template <typename T>
+void LocalTensor<T>::div(T alpha, bool conja, const LocalTensor<T>& A,
+                                  bool conjb, const LocalTensor<T>& B, T beta)
+{
+    assert(data.size() == A.data.size() && data.size() == B.data.size());
+
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0;i < data.size();i++)
+    {
+        T a = (conja ? conj(A.data[i]) : A.data[i]);
+        T b = (conjb ? conj(B.data[i]) : B.data[i]);
+        if (aquarius::abs(b) > numeric_limits<double>::min())
+        {
+            data[i] = beta*data[i] + alpha*a/b;
+        }
+    }
+}
+
+template <typename T>
+void LocalTensor<T>::invert(T alpha, bool conja, const LocalTensor<T>& A, T beta)
+{
+    assert(data.size() == A.data.size());
+
+    #pragma omp parallel for schedule(static)
+    for (int64_t i = 0;i < data.size();i++)
+    {
+        T a = (conja ? conj(A.data[i]) : A.data[i]);
+        if (aquarius::abs(a) > numeric_limits<double>::min())
+        {
+            data[i] = beta*data[i] + alpha/a;
+        }
+    }
+}
+
+template <typename T>
+void LocalTensor<T>::mult(T alpha, bool conja, const LocalTensor<T>& A, const string& idx_A,
+                                   bool conjb, const LocalTensor<T>& B, const string& idx_B,
+                          T  beta,                                      const string& idx_C)
+{
+    assert(idx_A.size() == A.ndim && idx_B.size() == B.ndim && idx_C.size() == ndim);
+
+    map<char,int> length;
+    for (int i = 0;i < A.ndim;i++) length[idx_A[i]] = A.len[i];
+    for (int i = 0;i < B.ndim;i++) length[idx_B[i]] = B.len[i];
+    for (int i = 0;i <   ndim;i++) length[idx_C[i]] =   len[i];
+
+    /*
+     * H: batch indices (in A, B, and C), K: contracted, M and N: free indices
+     * of A and B, and indices which appear in only one tensor
+     */
+    string idx_H, idx_K, idx_M, idx_N, only_A, only_B, only_C;
+    for (char c : distinct(idx_A+idx_B+idx_C))
+    {
+        bool in_A = contains(idx_A, c);
+        bool in_B = contains(idx_B, c);
+        bool in_C = contains(idx_C, c);
+
+        if      (in_A && in_B && in_C) idx_H += c;
+        else if (in_A && in_B        ) idx_K += c;
+        else if (in_A &&         in_C) idx_M += c;
+        else if (        in_B && in_C) idx_N += c;
+        else if (in_A                ) only_A += c;
+        else if (        in_B        ) only_B += c;
+        else                           only_C += c;
+    }
+
+    auto size = [&](const string& inds)
+    {
+        int64_t s = 1;
+        for (char c : inds) s *= length[c];
+        return s;
+    };
+
+    int64_t m = size(idx_M);
+    int64_t n = size(idx_N);
+    int64_t k = size(idx_K);
+    int64_t h = size(idx_H);
+
+    vector<T> Ap, Bp;
+    pack(A, idx_A, conja, idx_M+idx_K+idx_H, only_A, Ap);
+    pack(B, idx_B, conjb, idx_K+idx_N+idx_H, only_B, Bp);
+
+    vector<T> Cp(m*n*h, (T)0);
+    if (m > 0 && n > 0 && k > 0)
+    {
+        for (int64_t i = 0;i < h;i++)
+        {
+            gemm('N', 'N', m, n, k, alpha, Ap.data()+i*m*k, m,
+                                           Bp.data()+i*k*n, k,
+                                     (T)0, Cp.data()+i*m*n, m);
+        }
+    }
+
+    /*
+     * Indices only in C get the same value for each of their values
+     */
+    vector<int> len_C;
+    vector<vector<int64_t>> stride_C(2);
+    int64_t stride = 1;
+    for (char c : idx_M+idx_N+idx_H+only_C)
+    {
+        len_C.push_back(length[c]);
+        stride_C[0].push_back(index_stride(c, idx_C, len));
+        stride_C[1].push_back(contains(only_C, c) ? 0 : stride);
+        if (!contains(only_C, c)) stride *= length[c];
+    }
+
+    T* c = data.data();
+    const T* cp = Cp.data();
+
+    loop(len_C, stride_C, true,
+    [&](const int64_t* off)
+    {
+        c[off[0]] = (beta == (T)0 ? (T)0 : beta*c[off[0]]) + cp[off[1]];
+    });
+}
+
+template <typename T>
+void LocalTensor<T>::sum(T alpha, bool conja, const LocalTensor<T>& A, const string& idx_A,
+                         T  beta,                                      const string& idx_B)
+{
+    assert(idx_A.size() == A.ndim && idx_B.size() == ndim);
+
+    string inds_B = distinct(idx_B);
+    string common, only_A;
+
+    for (char c : inds_B)
+    {
+        if (contains(idx_A, c)) common += c;
+    }
+
+    for (char c : distinct(idx_A))
+    {
+        if (!contains(idx_B, c)) only_A += c;
+    }
+
+    vector<T> Ap;
+    pack(A, idx_A, conja, common, only_A, Ap);
+
+    vector<int> len_B;
+    vector<vector<int64_t>> stride_B(2);
+    int64_t stride = 1;
+    for (char c : inds_B)
+    {
+        int i = idx_B.find(c);
+        len_B.push_back(len[i]);
+        stride_B[0].push_back(index_stride(c, idx_B, len));
+        stride_B[1].push_back(contains(common, c) ? stride : 0);
+        if (contains(common, c)) stride *= len[i];
+    }
+
+    T* b = data.data();
+    const T* ap = Ap.data();
+
+    loop(len_B, stride_B, true,
+    [&](const int64_t* off)
+    {
+        b[off[0]] = (beta == (T)0 ? (T)0 : beta*b[off[0]]) + alpha*ap[off[1]];
+    });
+}
+
+template <typename T>
+void LocalTensor<T>::scale(T alpha, const string& idx_A)
+{
+    assert(idx_A.size() == ndim);
+
+    vector<int> len_A;
+    vector<vector<int64_t>> stride_A(1);
+    for (char c : distinct(idx_A))
+    {
+        len_A.push_back(len[idx_A.find(c)]);
+        stride_A[0].push_back(index_stride(c, idx_A, len));
+    }
+
+    T* a = data.data();
+
+    loop(len_A, stride_A, true,
+    [&](const int64_t* off)
+    {
+        a[off[0]] *= alpha;
+    });
+}
+
+template <typename T>
+T LocalTensor<T>::dot(bool conja, const LocalTensor<T>& A, const string& idx_A,
+                      bool conjb,                          const string& idx_B) const
+{
+    LocalTensor<T> s("dot", 0, {});
+    s.mult((T)1, conja, A, idx_A, conjb, *this, idx_B, (T)0, "");
+    return s.data[0];
+}
+
+INSTANTIATE_SPECIALIZATIONS(LocalTensor);
+
+}
+}
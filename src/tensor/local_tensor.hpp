@@ -0,0 +1,70 @@
+#ifndef _AQUARIUS_TENSOR_LOCAL_TENSOR_HPP_
+#define _AQUARIUS_TENSOR_LOCAL_TENSOR_HPP_
+
+#include "util/global.hpp"
+
+#include "indexable_tensor.hpp"
+
+namespace aquarius
+{
+namespace tensor
+{
+
+/*
+ * A dense, nonsymmetric tensor held entirely in the memory of one process
+ * (first index fastest).
+ *
+ * Contractions are done by transpose-transpose-GEMM: the operands are packed
+ * into matrices (summing out any index which appears in only one of them) by
+ * OpenMP-threaded loops, multiplied by (threaded) BLAS, one GEMM per value of
+ * the indices common to A, B, and C, and unpacked into C.
+ */
+template <typename T>
+class LocalTensor : public IndexableTensor< LocalTensor<T>,T >
+{
+    INHERIT_FROM_INDEXABLE_TENSOR(LocalTensor<T>,T)
+
+    protected:
+        vector<int> len;
+        vector<T> data;
+
+    public:
+        LocalTensor(const string& name, int ndim, const vector<int>& len, bool zero=true);
+
+        /*
+         * Create a scalar (0-dimensional tensor)
+         */
+        LocalTensor(const string& name, const LocalTensor<T>& A, T scalar);
+
+        LocalTensor(const LocalTensor<T>& A);
+
+        const vector<int>& getLengths() const { return len; }
+
+        int64_t getSize() const { return data.size(); }
+
+        T* getData() { return data.data(); }
+
+        const T* getData() const { return data.data(); }
+
+        void div(T alpha, bool conja, const LocalTensor<T>& A,
+                          bool conjb, const LocalTensor<T>& B, T beta);
+
+        void invert(T alpha, bool conja, const LocalTensor<T>& A, T beta);
+
+        void mult(T alpha, bool conja, const LocalTensor<T>& A, const string& idx_A,
+                           bool conjb, const LocalTensor<T>& B, const string& idx_B,
+                  T  beta,                                      const string& idx_C);
+
+        void sum(T alpha, bool conja, const LocalTensor<T>& A, const string& idx_A,
+                 T  beta,                                      const string& idx_B);
+
+        void scale(T alpha, const string& idx_A);
+
+        T dot(bool conja, const LocalTensor<T>& A, const string& idx_A,
+              bool conjb,                          const string& idx_B) const;
+};
+
+}
+}
+
+#endif
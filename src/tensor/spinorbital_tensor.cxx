@@ -377,6 +377,44 @@ SpinorbitalTensor<T>::SpinorbitalTensor(const string& name, const Arena& arena,
     register_scalar();
 }
 
+template<class T>
+SpinorbitalTensor<T>::SpinorbitalTensor(const string& name, const SpinorbitalTensor<T>& other,
+                                        const vector<Space>& spaces, bool view)
+: IndexableCompositeTensor<SpinorbitalTensor<T>,SymmetryBlockedTensor<T>,T>(name, other.ndim, 0),
+  Distributed(other.arena), group(other.group), spaces(spaces),
+  nout(other.nout+vector<int>(spaces.size()-other.spaces.size(), 0)),
+  nin (other.nin +vector<int>(spaces.size()-other.spaces.size(), 0)), spin(other.spin)
+{
+    int nspaces = other.spaces.size();
+    int n = group.getNumIrreps();
+
+    assert(spaces.size() >= nspaces);
+    for (int s = 0;s < nspaces;s++) assert(spaces[s] == other.spaces[s]);
+
+    /*
+     * The additional spaces carry no indices, so each spin case has exactly
+     * the shape of the corresponding spin case of other
+     */
+    for (typename vector<SpinCase>::const_iterator sc = other.cases.begin();sc != other.cases.end();++sc)
+    {
+        cases.push_back(SpinCase());
+        cases.back().alpha_out = sc->alpha_out+vector<int>(spaces.size()-nspaces, 0);
+        cases.back().alpha_in  = sc->alpha_in +vector<int>(spaces.size()-nspaces, 0);
+        if (view)
+        {
+            cases.back().tensor = new SymmetryBlockedTensor<T>(name, *sc->tensor,
+                vector<vector<int>>(this->ndim, vector<int>(n, 0)), sc->tensor->getLengths(), true);
+        }
+        else
+        {
+            cases.back().tensor = new SymmetryBlockedTensor<T>(name, *sc->tensor);
+        }
+        addTensor(cases.back().tensor);
+    }
+
+    register_scalar();
+}
+
 template<class T>
 SpinorbitalTensor<T>::~SpinorbitalTensor()
 {
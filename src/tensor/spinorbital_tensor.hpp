@@ -41,6 +41,16 @@ class SpinorbitalTensor : public IndexableCompositeTensor<SpinorbitalTensor<T>,S
                           const vector<int>& nout,
                           const vector<int>& nin, int spin=0);
 
+        /*
+         * Copy of other with additional (trailing) spaces on which the new
+         * tensor has no indices; this allows other to be contracted with
+         * tensors which carry indices in the additional spaces. If view is
+         * true the data of other is referenced rather than copied, and the
+         * new tensor must not outlive other.
+         */
+        SpinorbitalTensor(const string& name, const SpinorbitalTensor<T>& other,
+                          const vector<op::Space>& spaces, bool view=false);
+
         ~SpinorbitalTensor();
 
         const vector<int>& getNumOut() const { return nout; }
@@ -504,12 +504,27 @@ SymmetryBlockedTensor<T>::SymmetryBlockedTensor(const string& name, const Symmet
 template <class T>
 SymmetryBlockedTensor<T>::SymmetryBlockedTensor(const string& name, const SymmetryBlockedTensor<T>& A,
                                                 const vector<vector<int>>& start_A,
-                                                const vector<vector<int>>& len_A)
+                                                const vector<vector<int>>& len_A, bool view)
 : IndexableCompositeTensor<SymmetryBlockedTensor<T>,CTFTensor<T>,T>(name, A.ndim, 0), Distributed(A.arena),
   group(A.group), rep(A.rep), len(len_A), sym(A.sym)
 {
-    allocate(false);
-    slice((T)1, false, A, start_A, (T)0);
+    if (view)
+    {
+        /*
+         * Symmetric or antisymmetric indices may only be viewed in full
+         */
+        for (int i = 0;i < ndim;i++)
+        {
+            if (sym[i] != NS || (i > 0 && sym[i-1] != NS))
+                assert(start_A[i] == vector<int>(start_A[i].size(), 0) && len_A[i] == A.len[i]);
+        }
+        allocate(false, &A, start_A);
+    }
+    else
+    {
+        allocate(false);
+        slice((T)1, false, A, start_A, (T)0);
+    }
     register_scalar();
 }
 
@@ -548,7 +563,8 @@ SymmetryBlockedTensor<T>::~SymmetryBlockedTensor()
 }
 
 template <class T>
-void SymmetryBlockedTensor<T>::allocate(bool zero)
+void SymmetryBlockedTensor<T>::allocate(bool zero, const SymmetryBlockedTensor<T>* view,
+                                        const vector<vector<int>>& start)
 {
     int n = group.getNumIrreps();
     vector<Representation> irreps;
@@ -593,7 +609,17 @@ void SymmetryBlockedTensor<T>::allocate(bool zero)
             assert(t < ntensors);
             if (ok)
             {
-                tensors[t].tensor = new CTFTensor<T>(this->name, this->arena, ndim, sublen, subsym, zero);
+                if (view)
+                {
+                    vector<int> substart(ndim);
+                    for (int i = 0;i < ndim;i++) substart[i] = start[i][idx[i]];
+                    tensors[t].tensor = new CTFTensor<T>(this->name, *view->tensors[t].tensor,
+                                                         substart, sublen, true);
+                }
+                else
+                {
+                    tensors[t].tensor = new CTFTensor<T>(this->name, this->arena, ndim, sublen, subsym, zero);
+                }
                 tensors[t].isAlloced = true;
             }
         }
@@ -1394,6 +1420,108 @@ real_type_t<T> SymmetryBlockedTensor<T>::norm(int p) const
     return nrm;
 }
 
+template <class T>
+void SymmetryBlockedTensor<T>::write(ostream& os) const
+{
+    int n = group.getNumIrreps();
+
+    if (arena.rank == 0)
+    {
+        os.write((char*)&ndim, sizeof(int));
+        os.write((char*)&n, sizeof(int));
+        os.write((char*)sym.data(), sizeof(int)*ndim);
+        for (int i = 0;i < ndim;i++)
+            os.write((char*)len[i].data(), sizeof(int)*n);
+    }
+
+    for (int off = 0;off < tensors.size();off++)
+    {
+        if (tensors[off] == NULL || !tensors[off].isAlloced) continue;
+
+        if (arena.rank == 0)
+        {
+            vector<T> vals;
+            tensors[off].tensor->getAllData(vals, 0);
+            int64_t nval = vals.size();
+            os.write((char*)&nval, sizeof(int64_t));
+            os.write((char*)vals.data(), sizeof(T)*nval);
+        }
+        else
+        {
+            tensors[off].tensor->getAllData(0);
+        }
+    }
+}
+
+template <class T>
+bool SymmetryBlockedTensor<T>::readBlocks(istream& is, vector<vector<T>>& vals) const
+{
+    vals.clear();
+    if (arena.rank != 0) return true;
+
+    int n = group.getNumIrreps();
+
+    int ndim_, n_;
+    is.read((char*)&ndim_, sizeof(int));
+    is.read((char*)&n_, sizeof(int));
+    if (!is || ndim_ != ndim || n_ != n) return false;
+
+    vector<int> sym_(ndim);
+    vector<vector<int>> len_(ndim, vector<int>(n));
+    is.read((char*)sym_.data(), sizeof(int)*ndim);
+    for (int i = 0;i < ndim;i++)
+        is.read((char*)len_[i].data(), sizeof(int)*n);
+    if (!is || sym_ != sym || len_ != len) return false;
+
+    for (int off = 0;off < tensors.size();off++)
+    {
+        if (tensors[off] == NULL || !tensors[off].isAlloced) continue;
+
+        int64_t nval;
+        is.read((char*)&nval, sizeof(int64_t));
+        if (!is || nval != tensors[off].tensor->getNumPacked()) return false;
+
+        vals.emplace_back(nval);
+        is.read((char*)vals.back().data(), sizeof(T)*nval);
+        if (!is) return false;
+    }
+
+    return true;
+}
+
+template <class T>
+void SymmetryBlockedTensor<T>::setBlocks(const vector<vector<T>>& vals)
+{
+    int block = 0;
+    for (int off = 0;off < tensors.size();off++)
+    {
+        if (tensors[off] == NULL || !tensors[off].isAlloced) continue;
+
+        if (arena.rank == 0)
+        {
+            tensors[off].tensor->setAllData(vals[block++], 0);
+        }
+        else
+        {
+            tensors[off].tensor->setAllData(0);
+        }
+    }
+}
+
+template <class T>
+bool SymmetryBlockedTensor<T>::read(istream& is)
+{
+    vector<vector<T>> vals;
+    int ok = readBlocks(is, vals);
+
+    arena.comm().Bcast(&ok, 1, 0);
+    if (!ok) return false;
+
+    setBlocks(vals);
+
+    return true;
+}
+
 template<class T>
 map<const tCTF_World<T>*,map<const PointGroup*,pair<int,SymmetryBlockedTensor<T>*>>> SymmetryBlockedTensor<T>::scalars;
 
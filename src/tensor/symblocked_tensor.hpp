@@ -32,7 +32,12 @@ class SymmetryBlockedTensor : public IndexableCompositeTensor<SymmetryBlockedTen
         static vector<int> getStrides(const string& indices, int ndim,
                                       int len, const string& idx_A);
 
-        void allocate(bool zero);
+        /*
+         * If view is given, each block references (or, if that is not
+         * possible, copies) the block of view starting at start
+         */
+        void allocate(bool zero, const SymmetryBlockedTensor<T>* view = NULL,
+                      const vector<vector<int>>& start = {});
 
         void register_scalar();
 
@@ -55,9 +60,16 @@ class SymmetryBlockedTensor : public IndexableCompositeTensor<SymmetryBlockedTen
 
         SymmetryBlockedTensor(const string& name, const SymmetryBlockedTensor<T>& other, T scalar);
 
+        /*
+         * Create a tensor holding the range [start_A,start_A+len_A) of A (by
+         * irrep). If view is true then each symmetry block which spans all of
+         * the corresponding block of A references that data instead of
+         * copying it (see CTFTensor); only the remaining blocks are copied.
+         * Such a tensor must not outlive A.
+         */
         SymmetryBlockedTensor(const string& name, const SymmetryBlockedTensor<T>& A,
                               const vector<vector<int>>& start_A,
-                              const vector<vector<int>>& len_A);
+                              const vector<vector<int>>& len_A, bool view=false);
 
         SymmetryBlockedTensor(const string& name, const Arena& arena, const symmetry::PointGroup& group,
                               int ndim, const vector<vector<int>>& len,
@@ -71,6 +83,8 @@ class SymmetryBlockedTensor : public IndexableCompositeTensor<SymmetryBlockedTen
 
         const symmetry::PointGroup& getGroup() const { return group; }
 
+        const symmetry::Representation& getRepresentation() const { return rep; }
+
         const vector<vector<int>>& getLengths() const { return len; }
 
         const vector<int>& getSymmetry() const { return sym; }
@@ -143,6 +157,59 @@ class SymmetryBlockedTensor : public IndexableCompositeTensor<SymmetryBlockedTen
             (*this)(irreps).getAllData(rank);
         }
 
+        DataFuture<T> getAllDataAsync(const vector<int>& irreps, vector<T>& vals) const
+        {
+            return (*this)(irreps).getAllDataAsync(vals);
+        }
+
+        /*
+         * Gather several symmetry blocks with a single non-blocking
+         * broadcast; vals[i] receives the block irreps[i].
+         */
+        DataFuture<T> getAllDataAsync(const vector<vector<int>>& irreps, vector<vector<T>>& vals) const
+        {
+            DataFuture<T> future(this->arena);
+            getAllDataAsync(irreps, vals, future);
+            future.start();
+            return future;
+        }
+
+        void getAllDataAsync(const vector<vector<int>>& irreps, vector<vector<T>>& vals,
+                             DataFuture<T>& future) const
+        {
+            vals.resize(irreps.size());
+            for (int i = 0;i < irreps.size();i++)
+            {
+                (*this)(irreps[i]).getAllDataAsync(vals[i], future);
+            }
+        }
+
+        /*
+         * Write all symmetry blocks to os, which is only accessed on rank 0
+         */
+        void write(ostream& os) const;
+
+        /*
+         * Read the blocks written by write() from is into vals without
+         * touching the tensor (rank 0 only; other ranks return true). False
+         * is returned if the stored lengths, symmetry, or block sizes do not
+         * match or the stream fails.
+         */
+        bool readBlocks(istream& is, vector<vector<T>>& vals) const;
+
+        /*
+         * Set all symmetry blocks from vals as read by readBlocks(), which
+         * is only accessed on rank 0
+         */
+        void setBlocks(const vector<vector<T>>& vals);
+
+        /*
+         * Read the tensor back from is (only accessed on rank 0); if the
+         * file does not match or is truncated, false is returned on all
+         * ranks and the tensor is left untouched
+         */
+        bool read(istream& is);
+
         void slice(T alpha, bool conja, const SymmetryBlockedTensor<T>& A,
                    const vector<vector<int>>& start_A, T beta);
 
@@ -0,0 +1,251 @@
+#include "tiled_tensor.hpp"
+
+namespace aquarius
+{
+namespace tensor
+{
+
+template <typename T>
+vector<int> TiledTensor<T>::partition(int len, int tile_size)
+{
+    if (tile_size <= 0 || tile_size >= len) return {len};
+
+    vector<int> tiles(len/tile_size, tile_size);
+    if (len%tile_size != 0) tiles.push_back(len%tile_size);
+    return tiles;
+}
+
+template <typename T>
+TiledTensor<T>::TiledTensor(const string& name, const Arena& arena, const vector<vector<int>>& tiles)
+: Distributed(arena), name(name), ndim(tiles.size()), tiles(tiles)
+{
+    int64_t ntile = 1;
+    for (int i = 0;i < ndim;i++) ntile *= tiles[i].size();
+
+    data.resize(ntile);
+    norms.assign(ntile, -1);
+}
+
+template <typename T>
+int64_t TiledTensor<T>::offset(const vector<int>& tile) const
+{
+    assert(tile.size() == ndim);
+
+    int64_t off = 0, stride = 1;
+    for (int i = 0;i < ndim;i++)
+    {
+        assert(tile[i] >= 0 && tile[i] < tiles[i].size());
+        off += tile[i]*stride;
+        stride *= tiles[i].size();
+    }
+
+    return off;
+}
+
+template <typename T>
+vector<int> TiledTensor<T>::start(const vector<int>& tile) const
+{
+    vector<int> start(ndim, 0);
+    for (int i = 0;i < ndim;i++)
+    {
+        for (int j = 0;j < tile[i];j++) start[i] += tiles[i][j];
+    }
+    return start;
+}
+
+template <typename T>
+vector<int> TiledTensor<T>::length(const vector<int>& tile) const
+{
+    vector<int> len(ndim);
+    for (int i = 0;i < ndim;i++) len[i] = tiles[i][tile[i]];
+    return len;
+}
+
+template <typename T>
+CTFTensor<T>& TiledTensor<T>::allocate(const vector<int>& tile)
+{
+    int64_t off = offset(tile);
+
+    if (!data[off])
+    {
+        data[off].reset(new CTFTensor<T>(name, arena, ndim, length(tile), vector<int>(ndim, NS), true));
+    }
+
+    norms[off] = -1;
+    return *data[off];
+}
+
+template <typename T>
+int64_t TiledTensor<T>::getNumAllocated() const
+{
+    int64_t n = 0;
+    for (auto& tile : data) if (tile) n++;
+    return n;
+}
+
+template <typename T>
+bool TiledTensor<T>::exists(const vector<int>& tile) const
+{
+    return bool(data[offset(tile)]);
+}
+
+template <typename T>
+const CTFTensor<T>& TiledTensor<T>::operator()(const vector<int>& tile) const
+{
+    int64_t off = offset(tile);
+    assert(data[off]);
+    return *data[off];
+}
+
+template <typename T>
+real_type_t<T> TiledTensor<T>::norm(const vector<int>& tile) const
+{
+    int64_t off = offset(tile);
+
+    if (!data[off]) return 0;
+    if (norms[off] < 0) norms[off] = data[off]->norm(2);
+    return norms[off];
+}
+
+template <typename T>
+void TiledTensor<T>::clear()
+{
+    for (auto& tile : data) tile.reset();
+    norms.assign(data.size(), -1);
+}
+
+template <typename T>
+void TiledTensor<T>::set(const CTFTensor<T>& A, double tol)
+{
+    assert(A.getDimension() == ndim);
+
+    clear();
+
+    vector<int> tile(ndim, 0);
+    for (int64_t off = 0;off < data.size();off++)
+    {
+        data[off].reset(new CTFTensor<T>(name, A, start(tile), length(tile)));
+
+        if (norm(tile) <= tol)
+        {
+            data[off].reset();
+            norms[off] = -1;
+        }
+
+        for (int i = 0;i < ndim;i++)
+        {
+            if (++tile[i] < tiles[i].size()) break;
+            tile[i] = 0;
+        }
+    }
+}
+
+template <typename T>
+void TiledTensor<T>::get(T alpha, CTFTensor<T>& B, T beta) const
+{
+    assert(B.getDimension() == ndim);
+
+    string idx;
+    for (int i = 0;i < ndim;i++) idx.push_back('a'+i);
+    if (beta != (T)1) B.scale(beta, idx);
+
+    vector<int> tile(ndim, 0);
+    for (int64_t off = 0;off < data.size();off++)
+    {
+        if (data[off])
+        {
+            B.slice(alpha, false, *data[off], vector<int>(ndim, 0), (T)1, start(tile), length(tile));
+        }
+
+        for (int i = 0;i < ndim;i++)
+        {
+            if (++tile[i] < tiles[i].size()) break;
+            tile[i] = 0;
+        }
+    }
+}
+
+template <typename T>
+void TiledTensor<T>::mult(T alpha, const TiledTensor<T>& A, const string& idx_A,
+                                   const TiledTensor<T>& B, const string& idx_B,
+                          T  beta,                          const string& idx_C, double tol)
+{
+    assert(&A != this && &B != this);
+    assert(idx_A.size() == A.ndim && idx_B.size() == B.ndim && idx_C.size() == ndim);
+
+    /*
+     * The distinct indices and their tiles
+     */
+    string inds;
+    vector<const vector<int>*> inds_tiles;
+    auto add = [&](const string& idx, const TiledTensor<T>& X)
+    {
+        for (int i = 0;i < X.ndim;i++)
+        {
+            size_t pos = inds.find(idx[i]);
+            if (pos == string::npos)
+            {
+                inds.push_back(idx[i]);
+                inds_tiles.push_back(&X.tiles[i]);
+            }
+            else
+            {
+                assert(*inds_tiles[pos] == X.tiles[i]);
+            }
+        }
+    };
+    add(idx_A, A);
+    add(idx_B, B);
+    add(idx_C, *this);
+
+    vector<int> pos_A(A.ndim), pos_B(B.ndim), pos_C(ndim);
+    for (int i = 0;i < A.ndim;i++) pos_A[i] = inds.find(idx_A[i]);
+    for (int i = 0;i < B.ndim;i++) pos_B[i] = inds.find(idx_B[i]);
+    for (int i = 0;i <   ndim;i++) pos_C[i] = inds.find(idx_C[i]);
+
+    if (beta == (T)0)
+    {
+        clear();
+    }
+    else if (beta != (T)1)
+    {
+        for (int64_t off = 0;off < data.size();off++)
+        {
+            if (data[off]) data[off]->scale(beta, idx_C);
+            norms[off] = -1;
+        }
+    }
+
+    vector<int> tile(inds.size(), 0);
+    vector<int> tile_A(A.ndim), tile_B(B.ndim), tile_C(ndim);
+    for (bool done = false;!done;)
+    {
+        for (int i = 0;i < A.ndim;i++) tile_A[i] = tile[pos_A[i]];
+        for (int i = 0;i < B.ndim;i++) tile_B[i] = tile[pos_B[i]];
+        for (int i = 0;i <   ndim;i++) tile_C[i] = tile[pos_C[i]];
+
+        if (A.exists(tile_A) && B.exists(tile_B) &&
+            aquarius::abs(alpha)*A.norm(tile_A)*B.norm(tile_B) >= tol)
+        {
+            allocate(tile_C).mult(alpha, false, A(tile_A), idx_A,
+                                         false, B(tile_B), idx_B,
+                                  (T)1,                    idx_C);
+        }
+
+        done = true;
+        for (int i = 0;i < inds.size();i++)
+        {
+            if (++tile[i] < inds_tiles[i]->size())
+            {
+                done = false;
+                break;
+            }
+            tile[i] = 0;
+        }
+    }
+}
+
+INSTANTIATE_SPECIALIZATIONS(TiledTensor);
+
+}
+}
@@ -0,0 +1,105 @@
+#ifndef _AQUARIUS_TENSOR_TILED_TENSOR_HPP_
+#define _AQUARIUS_TENSOR_TILED_TENSOR_HPP_
+
+#include "util/global.hpp"
+
+#include "task/task.hpp"
+
+#include "ctf_tensor.hpp"
+
+namespace aquarius
+{
+namespace tensor
+{
+
+/*
+ * A nonsymmetric tensor split along each dimension into tiles (ranges of
+ * occupied or virtual orbitals, say), each of which is a separate CTFTensor.
+ * Tiles which are zero are not allocated, and contractions skip them, so
+ * that the work and storage follow the sparsity of the data (e.g. for local
+ * orbitals) even when there is no point group symmetry.
+ *
+ * The 2-norm of each tile is computed when first needed and kept until the
+ * tile is changed.
+ */
+template <typename T>
+class TiledTensor : public Distributed
+{
+    protected:
+        string name;
+        int ndim;
+        vector<vector<int>> tiles;
+        vector<unique_ptr<CTFTensor<T>>> data;
+        mutable vector<real_type_t<T>> norms;
+
+        int64_t offset(const vector<int>& tile) const;
+
+        vector<int> start(const vector<int>& tile) const;
+
+        vector<int> length(const vector<int>& tile) const;
+
+        /*
+         * The tile, which is allocated (as zero) if necessary
+         */
+        CTFTensor<T>& allocate(const vector<int>& tile);
+
+    public:
+        /*
+         * Split a range of length len into tiles of at most tile_size
+         * (all of it, if tile_size is not positive)
+         */
+        static vector<int> partition(int len, int tile_size);
+
+        /*
+         * Create a zero tensor (no tiles allocated), where tiles[i] lists the
+         * lengths of the tiles along dimension i
+         */
+        TiledTensor(const string& name, const Arena& arena, const vector<vector<int>>& tiles);
+
+        int getDimension() const { return ndim; }
+
+        const vector<vector<int>>& getTiles() const { return tiles; }
+
+        int64_t getNumTiles() const { return data.size(); }
+
+        int64_t getNumAllocated() const;
+
+        bool exists(const vector<int>& tile) const;
+
+        const CTFTensor<T>& operator()(const vector<int>& tile) const;
+
+        real_type_t<T> norm(const vector<int>& tile) const;
+
+        /*
+         * Deallocate all tiles
+         */
+        void clear();
+
+        /*
+         * Copy A, which must be nonsymmetric and as large as all tiles
+         * together, into this tensor, leaving unallocated each tile whose
+         * norm is not larger than tol
+         */
+        void set(const CTFTensor<T>& A, double tol = 0);
+
+        /*
+         * B = alpha*this + beta*B
+         */
+        void get(T alpha, CTFTensor<T>& B, T beta) const;
+
+        /*
+         * this[idx_C] = alpha*A[idx_A]*B[idx_B] + beta*this[idx_C], tile by
+         * tile. A pair of tiles of A and B is skipped if either is unallocated
+         * or if |alpha|*||A_tile||*||B_tile|| < tol, and a tile of this tensor
+         * is only allocated once something is added to it. Each index must be
+         * tiled the same way in every tensor in which it appears.
+         */
+        void mult(T alpha, const TiledTensor<T>& A, const string& idx_A,
+                           const TiledTensor<T>& B, const string& idx_B,
+                  T  beta,                          const string& idx_C, double tol = 0);
+};
+
+}
+}
+
+#endif
@@ -27,19 +27,31 @@ template <typename T> class SpinorbitalTensor;
 
 class Arena
 {
+    public:
+        /*
+         * With DISTRIBUTED, every tensor is distributed cyclically over the
+         * processes of the arena by CTF. LOCAL instead contracts nonsymmetric
+         * tensors in the memory of the process (see tensor::LocalTensor),
+         * which only applies to arenas of a single process. LOCAL_CHECKED is
+         * LOCAL, but also repeats each node-local contraction with CTF (see
+         * tensor::CTFTensor::localCheck).
+         */
+        enum Backend {DISTRIBUTED, LOCAL, LOCAL_CHECKED};
+
     protected:
         //global_ptr<tCTF_World<float>> ctfs;
         global_ptr<tCTF_World<double>> ctfd;
         //global_ptr<tCTF_World<complex<float>>> ctfc;
         //global_ptr<tCTF_World<complex<double>>> ctfz;
         shared_ptr<Intracomm> comm_;
+        shared_ptr<Backend> backend_;
 
     public:
         const int rank;
         const int size;
 
         Arena(Intracomm&& comm)
-        : comm_(new Intracomm(move(comm))), rank(comm.rank), size(comm.size) {}
+        : comm_(new Intracomm(move(comm))), backend_(new Backend(DISTRIBUTED)), rank(comm.rank), size(comm.size) {}
 
         Arena() : Arena(Intracomm::world()) {}
 
@@ -47,6 +59,17 @@ class Arena
 
         const Intracomm& comm() const { return *comm_; }
 
+        Backend backend() const { return *backend_; }
+
+        /*
+         * The backend is shared by all copies of the arena
+         */
+        void setBackend(Backend backend) const { *backend_ = backend; }
+
+        bool isLocal() const { return size == 1 && *backend_ != DISTRIBUTED; }
+
+        bool isLocalChecked() const { return size == 1 && *backend_ == LOCAL_CHECKED; }
+
         template <typename T>
         tCTF_World<T>& ctf();
 